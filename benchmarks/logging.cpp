@@ -0,0 +1,295 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// bench-ext-logging - cost of the logging hot paths
+//
+// Output never reaches a disk: it goes to a `null_sink`, to a stream without
+// buffer or to `/dev/null` through an `fd_sink`. Results of two commits can be
+// compared with the `compare.py` script shipped with google benchmark:
+//  bench-ext-logging --benchmark_out=before.json --benchmark_out_format=json
+//  compare.py benchmarks before.json after.json
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL info
+#include <ext/logging.hpp>
+
+namespace el = ext::logging;
+
+namespace {
+enum output : int { null_sink = 0, null_stream = 1, dev_null = 2 };
+
+// an ostream without streambuf discards everything
+std::ostream discard(nullptr);
+
+el::sink* target(output out) {
+    static el::null_sink nothing;
+#ifndef _WIN32
+    static el::fd_sink dev_null_sink("/dev/null");
+    if (out == dev_null) {
+        return &dev_null_sink;
+    }
+#endif // _WIN32
+    return out == null_sink ? &nothing : nullptr;
+}
+
+void setup(benchmark::State const& state) {
+    using namespace ext::logging;
+    configuration::stream = &discard;
+    configuration::sink = target(static_cast<output>(state.range(0)));
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+    configuration::gdb = false;
+    configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+    configuration::prefix_newline = false;
+    configuration::append_newline = true;
+    configuration::filename = true;
+    configuration::function = true;
+    set_level_all(level::info);
+}
+
+void teardown(benchmark::State const&) {
+    el::configuration::sink = nullptr;
+    el::configuration::stream = &std::cout;
+}
+
+// the recorder is shared by all threads of a run
+void setup_recorder(benchmark::State const& state) {
+    setup(state);
+    el::recorder::start({el::level::trace, 64 * 1024});
+}
+
+void teardown_recorder(benchmark::State const& state) {
+    el::recorder::stop();
+    teardown(state);
+}
+
+void set_label(benchmark::State& state) {
+    static char const* const names[] = {"null_sink", "null_stream", "dev_null"};
+    state.SetLabel(names[state.range(0)]);
+}
+
+std::string const long_text(400, 'x');
+} // namespace
+
+// disabled statements
+static void disabled_variable(benchmark::State& state) {
+    for (auto _ : state) {
+        EXT_LOG("b001", network, trace) << "not logged " << 42;
+    }
+}
+BENCHMARK(disabled_variable)->Arg(null_sink)->Setup(setup)->Teardown(teardown);
+
+static void disabled_const(benchmark::State& state) {
+    for (auto _ : state) {
+        EXT_LOG_CONST("b002", network, trace) << "not logged " << 42;
+    }
+}
+BENCHMARK(disabled_const)->Arg(null_sink)->Setup(setup)->Teardown(teardown);
+
+// throughput of enabled statements
+static void short_message(benchmark::State& state) {
+    set_label(state);
+    int i = 0;
+    for (auto _ : state) {
+        EXT_LOG("b003", network, info) << "short message " << ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(short_message)
+    ->Arg(null_sink)
+    ->Arg(null_stream)
+    ->Arg(dev_null)
+    ->Setup(setup)
+    ->Teardown(teardown)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+static void long_message(benchmark::State& state) {
+    set_label(state);
+    int i = 0;
+    for (auto _ : state) {
+        EXT_LOG("b004", network, info) << "long message " << ++i << " " << long_text << " " << 3.14159;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(long_text.size()));
+}
+BENCHMARK(long_message)
+    ->Arg(null_sink)
+    ->Arg(null_stream)
+    ->Arg(dev_null)
+    ->Setup(setup)
+    ->Teardown(teardown)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+// per message latency - reported as counters in nanoseconds
+static void latency(benchmark::State& state) {
+    set_label(state);
+    std::vector<double> samples;
+    samples.reserve(1 << 20);
+    int i = 0;
+    for (auto _ : state) {
+        auto const start = std::chrono::steady_clock::now();
+        EXT_LOG("b005", network, info) << "latency " << ++i;
+        auto const end = std::chrono::steady_clock::now();
+        if (samples.size() < samples.capacity()) {
+            samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        }
+    }
+
+    if (samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        return samples[std::min(samples.size() - 1, static_cast<std::size_t>(p * static_cast<double>(samples.size())))];
+    };
+    state.counters["p50"] = benchmark::Counter(percentile(0.50), benchmark::Counter::kAvgThreads);
+    state.counters["p99"] = benchmark::Counter(percentile(0.99), benchmark::Counter::kAvgThreads);
+    state.counters["p999"] = benchmark::Counter(percentile(0.999), benchmark::Counter::kAvgThreads);
+}
+BENCHMARK(latency)->Arg(null_sink)->Arg(dev_null)->Setup(setup)->Teardown(teardown)->ThreadRange(1, 8)->UseRealTime();
+
+// timestamps - the cached formatter against a put_time per message
+static void timestamp_format(benchmark::State& state) {
+    el::configuration::timestamp = static_cast<el::timestamp_precision>(state.range(0));
+    el::configuration::coarse_clock = state.range(1) != 0;
+    state.SetLabel(state.range(1) ? "coarse" : "realtime");
+    char out[el::_detail::timestamp_max_size];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(el::_detail::format_timestamp(out));
+    }
+    el::configuration::timestamp = el::timestamp_precision::none;
+    el::configuration::coarse_clock = false;
+}
+BENCHMARK(timestamp_format)->ArgsProduct({{1, 2, 3}, {0, 1}});
+
+static void timestamp_put_time(benchmark::State& state) {
+    std::ostringstream out;
+    for (auto _ : state) {
+        out.str("");
+        auto const now = std::chrono::system_clock::now();
+        auto const seconds = std::chrono::system_clock::to_time_t(now);
+        out << std::put_time(std::gmtime(&seconds), "%Y-%m-%d %H:%M:%S") << "." << std::setw(6) << std::setfill('0')
+            << std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count() % 1000000;
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(timestamp_put_time);
+
+static void short_message_timestamp(benchmark::State& state) {
+    set_label(state);
+    el::configuration::timestamp = el::timestamp_precision::microseconds;
+    int i = 0;
+    for (auto _ : state) {
+        EXT_LOG("b006", network, info) << "short message " << ++i;
+    }
+    el::configuration::timestamp = el::timestamp_precision::none;
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(short_message_timestamp)->Arg(null_sink)->Setup(setup)->Teardown(teardown);
+
+// structured fields - the encoders against the same fields streamed into the
+// text message and against a json line built with a std::ostringstream
+static void fields_encoder(benchmark::State& state) {
+    auto const format = static_cast<el::output_format>(state.range(1));
+    static char const* const names[] = {"text", "json", "logfmt"};
+    state.SetLabel(names[state.range(1)]);
+    el::configuration::format = format;
+    int i = 0;
+    for (auto _ : state) {
+        ++i;
+        EXT_LOG("b007", network, info).kv("user", i).kv("latency_us", i * 0.25).kv("path", "/index.html")
+            << "request done";
+    }
+    el::configuration::format = el::output_format::text;
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(fields_encoder)->ArgsProduct({{null_sink}, {0, 1, 2}})->Setup(setup)->Teardown(teardown);
+
+static void fields_streamed(benchmark::State& state) {
+    int i = 0;
+    for (auto _ : state) {
+        ++i;
+        EXT_LOG("b008", network, info) << "request done user=" << i << " latency_us=" << i * 0.25
+                                       << " path=/index.html";
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(fields_streamed)->Arg(null_sink)->Setup(setup)->Teardown(teardown);
+
+static void fields_ostringstream_json(benchmark::State& state) {
+    auto escaped = [](std::string_view text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        return out;
+    };
+    int i = 0;
+    for (auto _ : state) {
+        ++i;
+        std::ostringstream out;
+        out << "{\"id\":\"b009\",\"level\":\"info\",\"topic\":\"network\",\"file\":\"" << escaped("logging.cpp")
+            << "\",\"line\":" << __LINE__ << ",\"function\":\"" << escaped(__func__) << "\",\"msg\":\""
+            << escaped("request done") << "\",\"user\":" << i << ",\"latency_us\":" << i * 0.25 << ",\"path\":\""
+            << escaped("/index.html") << "\"}\n";
+        auto const line = out.str();
+        el::null_sink{}.write(el::record{el::level::info, line});
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(fields_ostringstream_json);
+
+// numbers - a format string against the `operator<<` chain
+static void numbers_stream(benchmark::State& state) {
+    int i = 0;
+    for (auto _ : state) {
+        ++i;
+        EXT_LOG("b010", network, info) << "x=" << i << " y=" << std::fixed << std::setprecision(3) << i * 0.001
+                                       << " z=" << std::hex << i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(numbers_stream)->Arg(null_sink)->Setup(setup)->Teardown(teardown);
+
+static void numbers_format(benchmark::State& state) {
+    int i = 0;
+    for (auto _ : state) {
+        ++i;
+        EXT_LOGF("b011", network, info, "x={} y={:.3f} z={:x}", i, i * 0.001, i);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(numbers_format)->Arg(null_sink)->Setup(setup)->Teardown(teardown);
+
+// flight recorder - trace messages kept in the ring buffer of the thread
+static void recorded_message(benchmark::State& state) {
+    int i = 0;
+    for (auto _ : state) {
+        EXT_LOG("b012", network, trace) << "recorded message " << ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(recorded_message)
+    ->Arg(null_sink)
+    ->Setup(setup_recorder)
+    ->Teardown(teardown_recorder)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
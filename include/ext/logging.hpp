@@ -12,7 +12,10 @@
 // activation level. If the `topic::activation_level` is greater or equal than
 // the `macro_level_`, then a log message is emitted.
 //
-// Logtopics, a mutex and a topic_map are automatically created using compiler
+// A topic may also have a compile-time ceiling (`EXT_LOGGING_TOPIC_CEILING`).
+// `EXT_LOG_CONST` statements above the ceiling compile to nothing.
+//
+// Logtopics, a mutex and the topic table are automatically created using compiler
 // specific functionality in order to avoid the static initialisation fiasco.
 //
 //
@@ -20,10 +23,25 @@
 //  EXT_LOG("cafe", info) << "hi there";
 //  EXT_LOG("babe", network, error) << "your network is broken";
 //  EXT_LOG("2bad", fatal) << "your app will terminate";
+//  EXT_LOG_EVERY_N(100, "beef", network, warn) << "every 100th retry";
+//  EXT_LOG_RATE(10, std::chrono::seconds(1), "f00d", warn) << "at most 10 per second";
+//  EXT_LOGF("d00d", network, info, "sent {} bytes in {:.3f} ms", bytes, ms);
+//  EXT_LOG_TOPIC("feed", ext::logging::register_topic("database"), info) << "connected";
+//  EXT_LOG_SIGNAL("dead", error) << "caught signal " << signal_number; // in a signal handler
 
 #ifndef EXT_LOGGING_HEADER
 #define EXT_LOGGING_HEADER
+#include <ext/logging/async.hpp>
+#include <ext/logging/context.hpp>
+#include <ext/logging/emergency.hpp>
+#include <ext/logging/format.hpp>
 #include <ext/logging/functionality.hpp>
+#include <ext/logging/ids.hpp>
+#include <ext/logging/limiters.hpp>
+#include <ext/logging/recorder.hpp>
+#include <ext/logging/sinks.hpp>
+#include <ext/logging/topics.hpp>
+#include <ext/logging/watcher.hpp>
 #include <ext/macros/compiler.hpp>
 #include <iostream>
 #include <type_traits>
@@ -35,10 +53,19 @@
 // https://stackoverflow.com/questions/5134523/msvc-doesnt-expand-va-args-correctly
 #define eXT_LOG_EXPAND(x) x
 
+// every expansion owns a constant initialized `call_site`
+#define eXT_LOG_SITE(id_, topic_, macro_level_)              \
+    static ext::logging::_detail::call_site eXT_LOG_CALL_SITE { \
+        id_, &(topic_), (macro_level_), __FILE__, __LINE__, __FUNCTION__ \
+    }
+
 // variable logging - if() ...
-#define eXT_LOG_INTERNAL(id_, topic_, macro_level_, cond_)                                 \
-    if (ext::logging::_detail::variable_level_is_active((macro_level_), (topic_)) && cond_) \
-    ext::logging::_detail::logger(id_, (topic_), (macro_level_), __FILE__, __LINE__, __FUNCTION__)
+#define eXT_LOG_INTERNAL(id_, topic_, macro_level_, cond_)                                                \
+    if (eXT_LOG_SITE(id_, topic_, macro_level_);                                                          \
+        EXT_LOGGING_UNLIKELY(ext::logging::topic_ceiling<topic_> >= (macro_level_) &&                     \
+                             ext::logging::_detail::variable_level_is_active((macro_level_), (topic_)) && \
+                             cond_ && eXT_LOG_CALL_SITE.enabled()))                                       \
+    ext::logging::_detail::logger(eXT_LOG_CALL_SITE)
 
 #define eXT_LOG_INTERNAL_ADD_PREFIX(id_, topic_, macro_level_, cond_) \
     eXT_LOG_INTERNAL(id_, (ext::logging::topic::topic_), (ext::logging::level::macro_level_), cond_)
@@ -66,11 +93,21 @@
 #define EXT_DEV_IF(cond_) eXT_LOG_INTERNAL_ADD_PREFIX("$$$$", dev, EXT_LOGGING_DEFAULT_LEVEL, cond_)
 #define EXT_LOG EXT_LOGVARIABLE
 
+// logging to a topic reference, e.g. one registered at runtime (see topics.hpp)
+// - there is no compile-time ceiling and the topic is bound on first use
+#define EXT_LOG_TOPIC(id_, topic_, macro_level_)                                                   \
+    if (eXT_LOG_SITE(id_, topic_, (ext::logging::level::macro_level_));                            \
+        EXT_LOGGING_UNLIKELY(ext::logging::_detail::variable_level_is_active(                      \
+                                 (ext::logging::level::macro_level_), *eXT_LOG_CALL_SITE.topic) && \
+                             eXT_LOG_CALL_SITE.enabled()))                                         \
+    ext::logging::_detail::logger(eXT_LOG_CALL_SITE)
+
 
 // variable logging - if constexpr() ...
-#define eXT_LOG_INTERNAL_CONST(id_, topic_, macro_level_, cond_)                          \
-    if constexpr (ext::logging::_detail::constexpr_level_is_active(macro_level_) && cond_) \
-    ext::logging::_detail::logger(id_, (topic_), (macro_level_), __FILE__, __LINE__, __FUNCTION__)
+#define eXT_LOG_INTERNAL_CONST(id_, topic_, macro_level_, cond_)                                    \
+    if constexpr (ext::logging::_detail::constexpr_level_is_active<topic_>(macro_level_) && cond_)  \
+    if (eXT_LOG_SITE(id_, topic_, macro_level_); EXT_LOGGING_UNLIKELY(eXT_LOG_CALL_SITE.enabled())) \
+    ext::logging::_detail::logger(eXT_LOG_CALL_SITE)
 
 #define eXT_LOG_INTERNAL_ADD_PREFIX_CONST(id_, topic_, macro_level_, cond_) \
     eXT_LOG_INTERNAL_CONST(id_, (ext::logging::topic::topic_), (ext::logging::level::macro_level_), cond_)
@@ -95,5 +132,86 @@
 #define EXT_DEV_IF_CONST(cond_) eXT_LOG_INTERNAL_ADD_PREFIX_CONST("@@@@", dev, EXT_LOGGING_DEFAULT_LEVEL, cond_)
 #define EXT_LOG_CONST EXT_LOGCONST
 
+// limited logging - if() ... if (limiter) ...
+// `limiter_` is a type in limiters.hpp and `args_` the parenthesized arguments of its `allow`
+#define eXT_LOG_INTERNAL_LIMITED(limiter_, args_, id_, topic_, macro_level_, cond_)                       \
+    if (eXT_LOG_SITE(id_, topic_, macro_level_);                                                          \
+        EXT_LOGGING_UNLIKELY(ext::logging::topic_ceiling<topic_> >= (macro_level_) &&                     \
+                             ext::logging::_detail::variable_level_is_active((macro_level_), (topic_)) && \
+                             cond_ && eXT_LOG_CALL_SITE.enabled()))                                       \
+    if (static ext::logging::_detail::limiter_ eXT_LOG_LIMITER;                                           \
+        eXT_LOG_LIMITER.allow args_ || ext::logging::_detail::limited((topic_), (macro_level_)))          \
+    ext::logging::_detail::logger(eXT_LOG_CALL_SITE).suppressed(eXT_LOG_LIMITER.take())
+
+#define eXT_LOG_LIMITED4(limiter_, args_, id, topic_, macro_level_, cond_) \
+    eXT_LOG_INTERNAL_LIMITED(                                               \
+        limiter_, args_, id, (ext::logging::topic::topic_), (ext::logging::level::macro_level_), cond_)
+#define eXT_LOG_LIMITED3(limiter_, args_, id, topic_, macro_level_) \
+    eXT_LOG_LIMITED4(limiter_, args_, id, topic_, macro_level_, true)
+#define eXT_LOG_LIMITED2(limiter_, args_, id, macro_level_) eXT_LOG_LIMITED4(limiter_, args_, id, no_topic, macro_level_, true)
+#define eXT_LOG_LIMITED1(limiter_, args_, id) \
+    eXT_LOG_LIMITED4(limiter_, args_, id, no_topic, EXT_LOGGING_DEFAULT_LEVEL, true)
+
+#ifdef EXT_COMPILER_VC
+    #define eXT_LOG_LIMITED(limiter_, args_, ...)                                                                   \
+        eXT_LOG_SELECT5TH_PARAMETER(                                                                               \
+            eXT_LOG_EXPAND(__VA_ARGS__), eXT_LOG_LIMITED4, eXT_LOG_LIMITED3, eXT_LOG_LIMITED2, eXT_LOG_LIMITED1, ) \
+        (limiter_, args_, eXT_LOG_EXPAND(__VA_ARGS__))
+#else
+    #define eXT_LOG_LIMITED(limiter_, args_, ...)                                                                   \
+        eXT_LOG_SELECT5TH_PARAMETER(                                                                               \
+            __VA_ARGS__, eXT_LOG_LIMITED4, eXT_LOG_LIMITED3, eXT_LOG_LIMITED2, eXT_LOG_LIMITED1, )                 \
+        (limiter_, args_, __VA_ARGS__)
+#endif // EXT_COMPILER_VC
+
+// the remaining arguments are the same as for `EXT_LOG`
+#define EXT_LOG_EVERY_N(n_, ...) eXT_LOG_LIMITED(every_n_limiter, (n_), __VA_ARGS__)
+#define EXT_LOG_FIRST_N(n_, ...) eXT_LOG_LIMITED(first_n_limiter, (n_), __VA_ARGS__)
+#define EXT_LOG_RATE(k_, window_, ...) eXT_LOG_LIMITED(rate_limiter, (k_, window_), __VA_ARGS__)
+#define EXT_LOG_SAMPLE(ratio_, ...) eXT_LOG_LIMITED(sample_limiter, (ratio_), __VA_ARGS__)
+
+// emergency logging - if() ... (see emergency.hpp)
+// no call site, no recorder and no metrics - the statement may run in a signal handler
+#ifndef _WIN32
+    #define eXT_LOG_SIGNAL_INTERNAL(id_, topic_, macro_level_, cond_)                                         \
+        if (EXT_LOGGING_UNLIKELY(ext::logging::topic_ceiling<topic_> >= (macro_level_) &&                     \
+                                 ext::logging::_detail::level_is_emitted((macro_level_), (topic_)) &&         \
+                                 cond_))                                                                      \
+        ext::logging::emergency::line(id_, (topic_), (macro_level_), __FILE__, __LINE__, __FUNCTION__)
+
+    #define eXT_LOG_SIGNAL_ADD_PREFIX(id_, topic_, macro_level_, cond_) \
+        eXT_LOG_SIGNAL_INTERNAL(id_, (ext::logging::topic::topic_), (ext::logging::level::macro_level_), cond_)
+
+    #define EXT_LOGSIGNAL4(id, topic_, macro_level_, cond_) eXT_LOG_SIGNAL_ADD_PREFIX(id, topic_, macro_level_, cond_)
+    #define EXT_LOGSIGNAL3(id, topic_, macro_level_) eXT_LOG_SIGNAL_ADD_PREFIX(id, topic_, macro_level_, true)
+    #define EXT_LOGSIGNAL2(id, macro_level_) eXT_LOG_SIGNAL_ADD_PREFIX(id, no_topic, macro_level_, true)
+    #define EXT_LOGSIGNAL1(id) eXT_LOG_SIGNAL_ADD_PREFIX(id, no_topic, EXT_LOGGING_DEFAULT_LEVEL, true)
+
+    #define EXT_LOG_SIGNAL(...)                                                                                    \
+        eXT_LOG_SELECT5TH_PARAMETER(__VA_ARGS__, EXT_LOGSIGNAL4, EXT_LOGSIGNAL3, EXT_LOGSIGNAL2, EXT_LOGSIGNAL1, ) \
+        (__VA_ARGS__)
+#endif // _WIN32
+
+// format string logging - if() ... if constexpr (format is valid) ...
+// the format string is the first of the variadic arguments (see format.hpp)
+#define eXT_LOGF_FIRST_(first_, ...) first_
+#define eXT_LOGF_FIRST(...) eXT_LOG_EXPAND(eXT_LOGF_FIRST_(__VA_ARGS__, unused))
+
+#define eXT_LOGF_INTERNAL(id_, topic_, macro_level_, ...)                                                 \
+    if (eXT_LOG_SITE(id_, topic_, macro_level_);                                                          \
+        EXT_LOGGING_UNLIKELY(ext::logging::topic_ceiling<topic_> >= (macro_level_) &&                     \
+                             ext::logging::_detail::variable_level_is_active((macro_level_), (topic_)) && \
+                             eXT_LOG_CALL_SITE.enabled()))                                                \
+    if constexpr (ext::logging::_detail::check_format(                                                    \
+                      decltype(ext::logging::_detail::format_types(__VA_ARGS__)){},                       \
+                      eXT_LOGF_FIRST(__VA_ARGS__)))                                                       \
+    ext::logging::_detail::logger(eXT_LOG_CALL_SITE).format(__VA_ARGS__)
+
+// EXT_LOGF(id, topic, level, "format", args...) - all parts are required
+#define EXT_LOGF(id_, topic_, macro_level_, ...)                                           \
+    eXT_LOGF_INTERNAL(id_,                                                                  \
+                      (ext::logging::topic::topic_),                                        \
+                      (ext::logging::level::macro_level_),                                  \
+                      __VA_ARGS__)
 
 #endif // EXT_LOGGING_HEADER
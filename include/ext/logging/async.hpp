@@ -0,0 +1,68 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Asynchronous logging:
+//
+// After `async::start()` finished messages are no longer written on the
+// calling thread. The logger copies the message into a slot of a bounded
+// lock-free queue and a background thread drains the queue in batches into
+// `configuration::stream`. Messages of level `fatal` drain the queue and are
+// written synchronously before the application terminates.
+//
+// Usage
+//  ext::logging::async::start({ 4096, 128, ext::logging::async::full_policy::drop });
+//  EXT_LOG("cafe", info) << "hi there";
+//  ext::logging::async::flush(); // wait until everything is written
+//  ext::logging::async::stop();  // drain and join the writer
+
+#ifndef EXT_LOGGING_ASYNC_HEADER
+#define EXT_LOGGING_ASYNC_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <ext/logging/definitions.hpp>
+#include <ext/macros/compiler.hpp>
+#include <string_view>
+
+namespace ext { namespace logging { namespace async {
+
+// what a producer does when the queue is full
+enum class full_policy {
+    block,      // wait until the writer made room
+    drop,       // discard the new message
+    drop_oldest // discard the oldest queued message
+};
+
+struct options {
+    std::size_t queue_size = 8192; // number of slots - rounded up to a power of 2
+    std::size_t batch_size = 256;  // maximum number of messages written per batch
+    full_policy policy = full_policy::block;
+};
+
+struct statistics {
+    std::uint64_t enqueued;       // messages accepted by the queue
+    std::uint64_t written;        // messages written by the background thread
+    std::uint64_t blocked;        // messages that had to wait for a free slot
+    std::uint64_t dropped;        // new messages discarded because the queue was full
+    std::uint64_t dropped_oldest; // queued messages discarded to make room
+};
+
+// starts the writer thread - a running writer is stopped first
+EXT_EXPORT_VC void start(options const& opts = options{});
+// stops accepting messages, drains the queue and joins the writer
+EXT_EXPORT_VC void stop();
+// blocks until all messages enqueued before the call have been written
+EXT_EXPORT_VC void flush();
+EXT_EXPORT_VC bool active() noexcept;
+EXT_EXPORT_VC statistics stats() noexcept;
+
+}}} // namespace ext::logging::async
+
+namespace ext { namespace logging {
+struct record;
+namespace _detail {
+// returns false if asynchronous logging is not active - the caller
+// must then write the message itself
+EXT_EXPORT_VC bool async_enqueue(record const& rec, int topic_id);
+}}}    // namespace ext::logging::_detail
+#endif // EXT_LOGGING_ASYNC_HEADER
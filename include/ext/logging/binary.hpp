@@ -0,0 +1,151 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Binary logging:
+//
+// `EXT_LOG_BINARY` does not format anything at runtime. Every macro expansion
+// owns a static `site` (id, topic, level, file, line and function) that is
+// written to the binary sink once. A message only consists of the site index,
+// a timestamp and the raw bytes of its arguments. `ext-logging-decode` (or
+// `binary::decode`) turns the stream back into the usual text format.
+//
+// Every thread encodes its messages into a batch of its own without a lock
+// that other threads take. The batch is handed to the sink as one record when
+// it holds `batch_size` bytes, when a message of `error` or `fatal` is added,
+// when the thread exits and on `binary::flush`. Messages of one thread keep
+// their order, the batches of different threads are interleaved.
+//
+// When no binary sink is set the message is formatted and logged as text. Ids
+// switched off with `set_enabled` are not logged.
+//
+// Usage
+//  ext::logging::file_sink out("/var/log/app.bin");
+//  ext::logging::binary::set_sink(&out);
+//  EXT_LOG_BINARY("cafe", network, info, "connected to ", host, ":", port);
+//  ext::logging::binary::set_sink(nullptr); // flushes the batches
+//
+// Stream format (native byte order)
+//  header  - "EXTLOGB1" - may be repeated, the sites that follow replace the known ones
+//  site    - u8 1, u32 index, u8 level, u32 line, str id, str topic, str file, str function
+//  message - u8 2, u32 index, u64 nanoseconds since epoch, u32 payload size, payload
+//  payload - per argument: u8 type followed by the value (str: u32 size and bytes)
+
+#ifndef EXT_LOGGING_BINARY_HEADER
+#define EXT_LOGGING_BINARY_HEADER
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ext/logging/functionality.hpp>
+#include <ext/logging/sinks.hpp>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ext { namespace logging { namespace binary {
+
+constexpr char magic[] = "EXTLOGB1";
+
+enum class entry : std::uint8_t { site = 1, message = 2 };
+enum class type : std::uint8_t { i64 = 1, u64 = 2, f64 = 3, boolean = 4, character = 5, string = 6 };
+
+// static data of one `EXT_LOG_BINARY` expansion
+struct site {
+    ext::logging::_detail::call_site call; // id, topic, level and location
+    std::atomic<std::uint32_t> index{0};   // 0 - not registered yet
+};
+
+constexpr std::size_t default_batch_size = 4096;
+
+// pending batches go to the previous sink, the header and all sites are
+// written to a new sink before anything else - setting the current sink again
+// only changes the batch size
+EXT_EXPORT_VC void set_sink(sink* target, std::size_t batch_size = default_batch_size);
+EXT_EXPORT_VC sink* get_sink() noexcept;
+// hands the batches of all threads to the sink and flushes it
+EXT_EXPORT_VC void flush();
+
+struct decode_options {
+    bool filename = true;
+    bool function = true;
+    bool timestamp = false;
+};
+
+// decodes a binary stream to text - returns false if the stream is corrupt
+EXT_EXPORT_VC bool decode(std::istream& in, std::ostream& out, decode_options const& opts = decode_options{});
+
+namespace _detail {
+EXT_EXPORT_VC ext::logging::_detail::message_buffer& acquire_buffer();
+EXT_EXPORT_VC void write(site& site_, ext::logging::_detail::message_buffer& buffer);
+
+template<typename T>
+inline void append_raw(ext::logging::_detail::message_buffer& buffer, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    buffer.append(std::string_view(bytes, sizeof(T)));
+}
+
+inline void encode(ext::logging::_detail::message_buffer& buffer, std::string_view str) {
+    buffer.append(static_cast<char>(type::string));
+    append_raw(buffer, static_cast<std::uint32_t>(str.size()));
+    buffer.append(str);
+}
+
+template<typename T>
+inline void encode(ext::logging::_detail::message_buffer& buffer, T const& value) {
+    using value_type = std::decay_t<T>;
+    if constexpr (std::is_same_v<value_type, bool>) {
+        buffer.append(static_cast<char>(type::boolean));
+        buffer.append(static_cast<char>(value));
+    } else if constexpr (std::is_same_v<value_type, char>) {
+        buffer.append(static_cast<char>(type::character));
+        buffer.append(value);
+    } else if constexpr (std::is_integral_v<value_type> && std::is_signed_v<value_type>) {
+        buffer.append(static_cast<char>(type::i64));
+        append_raw(buffer, static_cast<std::int64_t>(value));
+    } else if constexpr (std::is_integral_v<value_type>) {
+        buffer.append(static_cast<char>(type::u64));
+        append_raw(buffer, static_cast<std::uint64_t>(value));
+    } else if constexpr (std::is_enum_v<value_type>) {
+        encode(buffer, static_cast<std::underlying_type_t<value_type>>(value));
+    } else if constexpr (std::is_floating_point_v<value_type>) {
+        buffer.append(static_cast<char>(type::f64));
+        append_raw(buffer, static_cast<double>(value));
+    } else if constexpr (std::is_convertible_v<T const&, std::string_view>) {
+        encode(buffer, std::string_view(value));
+    } else {
+        static_assert(!sizeof(T), "EXT_LOG_BINARY supports arithmetic types, enums and strings");
+    }
+}
+
+template<typename... Args>
+void log(site& site_, Args const&... args) {
+    // no binary output or a level only kept by the flight recorder - the
+    // text logger writes or records the message
+    if (get_sink() == nullptr || !ext::logging::_detail::level_is_emitted(site_.call.level_, *site_.call.topic)) {
+        ext::logging::_detail::logger out(site_.call);
+        (out << ... << args);
+        return;
+    }
+
+    auto& buffer = acquire_buffer();
+    (encode(buffer, args), ...);
+    write(site_, buffer);
+}
+} // namespace _detail
+}}} // namespace ext::logging::binary
+
+#define EXT_LOG_BINARY(id_, topic_, macro_level_, ...)                                                                 \
+    do {                                                                                                               \
+        static ext::logging::binary::site eXT_LOG_BINARY_SITE{                                                         \
+            {id_, &ext::logging::topic::topic_, ext::logging::level::macro_level_, __FILE__, __LINE__, __FUNCTION__}}; \
+        if (ext::logging::topic_ceiling<ext::logging::topic::topic_> >= ext::logging::level::macro_level_ &&           \
+            ext::logging::_detail::variable_level_is_active(ext::logging::level::macro_level_,                         \
+                                                            ext::logging::topic::topic_) &&                            \
+            eXT_LOG_BINARY_SITE.call.enabled()) {                                                                      \
+            ext::logging::binary::_detail::log(eXT_LOG_BINARY_SITE, __VA_ARGS__);                                      \
+        }                                                                                                              \
+    } while (false)
+
+#endif // EXT_LOGGING_BINARY_HEADER
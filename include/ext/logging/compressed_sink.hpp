@@ -0,0 +1,150 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Compressed file sink:
+//
+// Records are collected into blocks of about `block_size` bytes. A full block
+// is handed to a background thread that compresses it and appends it to the
+// file, so the logging thread only copies the text. When more than
+// `max_pending_blocks` blocks wait for compression the logging thread waits
+// as well. Blocks start and end at record boundaries and every block is
+// compressed on its own, so it can be decoded without the blocks before it.
+//
+// Every block header carries the time range in which its records were
+// written. When the sink is destroyed an index of all blocks is appended to
+// the file. Files without index (the process died) are read by walking the
+// block headers. `ext-logging-cat` (or `compressed::decode`) turns the file
+// back into text - optionally only the blocks of a time range.
+//
+// The codec is zlib if it was found at configure time (`EXTLOG_ZLIB`) and a
+// built-in LZ77 codec otherwise. Blocks that do not get smaller are stored.
+//
+// Usage
+//  ext::logging::compressed_file_sink out({"/var/log/app.logz"});
+//  ext::logging::configuration::sink = &out;
+//
+// File format (native byte order)
+//  header - "EXTLOGZ1"
+//  block  - u8 codec, u8[3] 0, u32 raw size, u32 stored size, u32 records,
+//           u64 first and u64 last nanoseconds since epoch, stored bytes
+//  index  - per block: u64 offset, u64 first, u64 last, u32 raw size,
+//           u32 stored size, u32 records, u8 codec, u8[3] 0 - then u64 block
+//           count and "EXTLOGZX"
+
+#ifndef EXT_LOGGING_COMPRESSED_SINK_HEADER
+#define EXT_LOGGING_COMPRESSED_SINK_HEADER
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <ext/logging/sinks.hpp>
+#include <iosfwd>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ext { namespace logging {
+namespace compressed {
+
+constexpr char magic[] = "EXTLOGZ1";
+constexpr char index_magic[] = "EXTLOGZX";
+constexpr std::size_t block_header_size = 32;
+constexpr std::size_t index_entry_size = 40;
+
+enum class codec : std::uint8_t { stored = 0, lz = 1, zlib = 2 };
+
+// true if blocks of this codec can be written and read
+EXT_EXPORT_VC bool available(codec method) noexcept;
+// zlib if available - lz otherwise
+EXT_EXPORT_VC codec default_codec() noexcept;
+
+struct block_info {
+    std::uint64_t offset; // of the block header
+    std::uint64_t first;  // nanoseconds since epoch
+    std::uint64_t last;
+    std::uint32_t raw_size;
+    std::uint32_t stored_size;
+    std::uint32_t records;
+    codec method;
+};
+
+// reads the index or walks the block headers - returns false if the file is corrupt
+EXT_EXPORT_VC bool read_index(std::istream& in, std::vector<block_info>& blocks);
+// appends the text of a block to `out`
+EXT_EXPORT_VC bool read_block(std::istream& in, block_info const& block, std::string& out);
+
+struct decode_options {
+    std::uint64_t from = 0; // only blocks whose time range overlaps [from, to]
+    std::uint64_t to = std::numeric_limits<std::uint64_t>::max();
+};
+
+// writes the text of all selected blocks - returns false if the file is corrupt
+EXT_EXPORT_VC bool decode(std::istream& in, std::ostream& out, decode_options const& opts = decode_options{});
+
+namespace _detail {
+EXT_EXPORT_VC void lz_compress(char const* data, std::size_t size, std::string& out);
+// `out` must hold `raw_size` bytes - returns false if the input is corrupt
+EXT_EXPORT_VC bool lz_decompress(char const* data, std::size_t size, char* out, std::size_t raw_size) noexcept;
+} // namespace _detail
+} // namespace compressed
+
+class EXT_EXPORT_VC compressed_file_sink : public sink {
+public:
+    struct options {
+        std::string path;
+        std::size_t block_size = 1024 * 1024;
+        std::size_t max_pending_blocks = 8;
+        compressed::codec method = compressed::default_codec();
+    };
+
+    explicit compressed_file_sink(options opts);
+    ~compressed_file_sink();
+    compressed_file_sink(compressed_file_sink const&) = delete;
+    compressed_file_sink& operator=(compressed_file_sink const&) = delete;
+
+    void write(record const& rec) override;
+    void write(record const* records, std::size_t count) override;
+    // ends the current block and waits until all blocks are written
+    void flush() override;
+
+private:
+    struct block {
+        std::string text;
+        std::uint32_t records = 0;
+        std::uint64_t first = 0;
+        std::uint64_t last = 0;
+    };
+
+    void hand_over();
+    // returns 0 or the error
+    int write_block(block const& raw);
+    void write_index();
+    void background();
+
+    options _opts;
+    std::FILE* _file;
+    block _current;
+
+    // shared with the background thread
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    std::deque<block> _pending;
+    std::vector<block> _free; // keeps the capacity of written blocks
+    bool _busy;
+    bool _stop;
+    int _error; // of the last failed write - reported by `flush`
+
+    // background thread only
+    std::string _stored;
+    std::uint64_t _offset;
+    std::vector<compressed::block_info> _index;
+
+    std::thread _thread;
+};
+
+}}     // namespace ext::logging
+#endif // EXT_LOGGING_COMPRESSED_SINK_HEADER
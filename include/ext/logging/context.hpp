@@ -0,0 +1,89 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Thread identity and context:
+//
+// With `configuration::threads` every line starts with `{<tid> <name>}`. The
+// id is read once per thread, the name can be set with `set_thread_name`.
+//
+// A `context` guard adds a key/value pair to every line the thread logs while
+// the guard is alive (` key=value` behind the message). Context lives in a
+// fixed size per thread buffer - pushing and logging never allocate. Pairs
+// that do not fit are left out. A thread without context pays one check.
+//
+// Usage
+//  ext::logging::set_thread_name("worker-1");
+//  ext::logging::context request("request", request_id);
+//  EXT_LOG("cafe", info) << "handled"; // ... 'handled' request=42
+
+#ifndef EXT_LOGGING_CONTEXT_HEADER
+#define EXT_LOGGING_CONTEXT_HEADER
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <ext/macros/compiler.hpp>
+#include <string_view>
+#include <type_traits>
+
+namespace ext { namespace logging {
+
+// at most 15 characters are kept
+EXT_EXPORT_VC void set_thread_name(std::string_view name) noexcept;
+EXT_EXPORT_VC std::string_view thread_name() noexcept;
+EXT_EXPORT_VC std::uint64_t thread_id() noexcept;
+
+class EXT_EXPORT_VC context {
+public:
+    static constexpr std::size_t max_entries = 8;
+    static constexpr std::size_t capacity = 256; // bytes of all pairs of a thread
+
+    context(std::string_view key, std::string_view value) noexcept;
+    context(std::string_view key, char const* value) noexcept : context(key, std::string_view(value)) {}
+
+    template<typename T,
+             std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>, int> = 0>
+    context(std::string_view key, T value) noexcept : context(key, format(value).view(), true) {}
+
+    ~context();
+    context(context const&) = delete;
+    context& operator=(context const&) = delete;
+
+private:
+    context(std::string_view key, std::string_view value, bool is_number) noexcept;
+
+    struct number {
+        char text[24];
+        std::size_t size;
+        std::string_view view() const noexcept {
+            return {text, size};
+        }
+    };
+
+    template<typename T>
+    static number format(T value) noexcept {
+        number result;
+        auto end = std::to_chars(result.text, result.text + sizeof(result.text), value).ptr;
+        result.size = static_cast<std::size_t>(end - result.text);
+        return result;
+    }
+
+    bool _pushed;
+};
+
+namespace _detail {
+// `{<tid> <name>} ` of the calling thread
+EXT_EXPORT_VC std::string_view thread_field() noexcept;
+// ` key=value ...` of the calling thread - empty without context
+EXT_EXPORT_VC std::string_view context_field() noexcept;
+
+// the unformatted pairs for the structured formats
+struct context_pair {
+    std::string_view key;
+    std::string_view value;
+    bool number;
+};
+EXT_EXPORT_VC std::size_t context_pairs(context_pair (&out)[context::max_entries]) noexcept;
+} // namespace _detail
+}}     // namespace ext::logging
+#endif // EXT_LOGGING_CONTEXT_HEADER
@@ -7,75 +7,174 @@
     #define EXT_LOGGING_DEFAULT_LEVEL info
 #endif // EXT_LOGGING_DEFAULT_LEVEL
 
+// The body of an active log statement is kept out of the hot code: the
+// condition is marked as unlikely and the logger functions it calls are cold
+// and not inlined, so the compiler moves them to `.text.unlikely`.
+// With `EXT_LOGGING_NO_COLD` the whole statement is expanded at the call site.
+#if defined(EXT_LOGGING_NO_COLD) || !(defined(__GNUC__) || defined(__clang__))
+    #define EXT_LOGGING_COLD
+    #define EXT_LOGGING_UNLIKELY(cond_) (cond_)
+#else
+    #define EXT_LOGGING_COLD __attribute__((cold, noinline))
+    #define EXT_LOGGING_UNLIKELY(cond_) __builtin_expect(static_cast<bool>(cond_), 0)
+#endif // EXT_LOGGING_NO_COLD
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
 #include <ext/macros/compiler.hpp>
-#include <map>
 #include <mutex>
 #include <string>
+#include <string_view>
 
 namespace ext { namespace logging {
+class sink;
+
 namespace _detail {
 struct logtopic;
+struct call_site;
 EXT_EXPORT_VC extern std::mutex logmutex;
-EXT_EXPORT_VC extern std::map<int, logtopic*> topics_map;
+// topics indexed by their id (see topics.hpp) - constant initialized, written
+// under `logmutex`
+constexpr std::size_t max_topics = 1024;
+EXT_EXPORT_VC extern logtopic* topics[max_topics];
+EXT_EXPORT_VC extern std::size_t topics_end; // one past the highest id in use
+EXT_EXPORT_VC void add_topic(logtopic& topic) noexcept;
+// most verbose level kept by the flight recorder, -1 when it is off (see recorder.hpp)
+EXT_EXPORT_VC extern std::atomic<int> record_level;
+// odd while `apply_configuration` changes the output flags (see watcher.hpp)
+EXT_EXPORT_VC extern std::atomic<unsigned> configuration_sequence;
 } // namespace _detail
 
 enum class level : int { fatal = 0, error = 20, warn = 40, info = 60, debug = 80, trace = 100 };
 
+// 64 bit FNV-1a of a log id - computed at compile time for the call sites of
+// the log macros (see ids.hpp), never 0
+constexpr std::uint64_t id_hash(std::string_view id) noexcept {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char c : id) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash ? hash : 1;
+}
+
+// the same for null terminated ids - `std::string_view(char const*)` calls
+// `strlen` unless it is evaluated as constant, so the sites would be
+// initialized on first use instead of being constant initialized
+constexpr std::uint64_t id_hash(char const* id) noexcept {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (; *id; ++id) {
+        hash ^= static_cast<unsigned char>(*id);
+        hash *= 1099511628211ull;
+    }
+    return hash ? hash : 1;
+}
+
 namespace _detail {
-inline std::string const level_to_str(level level_) {
-    using namespace std::literals::string_literals;
+inline constexpr std::string_view level_to_str(level level_) noexcept {
+    using namespace std::literals::string_view_literals;
     switch (level_) {
         case level::fatal:
-            return "fatal"s;
+            return "fatal"sv;
         case level::error:
-            return "error"s;
+            return "error"sv;
         case level::warn:
-            return "warning"s;
+            return "warning"sv;
         case level::info:
-            return "info"s;
+            return "info"sv;
         case level::debug:
-            return "debug"s;
+            return "debug"sv;
         case level::trace:
-            return "trace"s;
+            return "trace"sv;
         default:
-            return "unknown"s;
+            return "unknown"sv;
     }
 }
 
+// the more verbose of the level of a topic and the level kept by the flight recorder
+inline level checked_level_of(level activation_level) noexcept {
+    auto const recorded = record_level.load();
+    return static_cast<int>(activation_level) >= recorded ? activation_level : static_cast<level>(recorded);
+}
+
 struct logtopic {
+    // registers the topic - ids outside of [0, max_topics) are not registered
     logtopic(int id_, std::string&& name_, level activation_level_)
-        : id(id_), activation_level(activation_level_), name(std::move(name_)) {
-        topics_map[id] = this;
+        : id(id_)
+        , activation_level(activation_level_)
+        , checked_level(checked_level_of(activation_level_))
+        , name(std::move(name_)) {
+        add_topic(*this);
     }
 
-    logtopic(logtopic&& other) = default;
-    logtopic(logtopic const& other) = default;
+    logtopic(logtopic&& other) noexcept
+        : id(other.id)
+        , activation_level(other.activation_level.load())
+        , checked_level(other.checked_level.load())
+        , name(std::move(other.name)) {}
+    logtopic(logtopic const& other)
+        : id(other.id)
+        , activation_level(other.activation_level.load())
+        , checked_level(other.checked_level.load())
+        , name(other.name) {}
 
     int id;
     static const level default_level = level::EXT_LOGGING_DEFAULT_LEVEL;
-    // using info is the default
-    level activation_level;
+    // using info is the default - may be changed from any thread at any time
+    std::atomic<level> activation_level;
+    // compared by the log macros - `checked_level_of(activation_level)`, so a
+    // disabled statement is one load even while the recorder runs
+    std::atomic<level> checked_level;
     std::string name;
 };
 
+// the level of the topic or of the recorder may change meanwhile - stores
+// until the stored level is current
+inline void update_checked_level(logtopic& topic) noexcept {
+    for (;;) {
+        auto const wanted = checked_level_of(topic.activation_level.load());
+        topic.checked_level.store(wanted);
+        if (checked_level_of(topic.activation_level.load()) == wanted) {
+            return;
+        }
+    }
+}
+
 } // namespace _detail
 
+// precision of the timestamp in front of every message
+enum class timestamp_precision : std::uint8_t { none, milliseconds, microseconds, nanoseconds };
+
+// layout of a line
+//  text   - [id] level (topic) file:line in function(): 'message' key=value
+//  json   - {"id":"id","level":"level",...,"msg":"message","key":value}
+//  logfmt - id=id level=level ... msg=message key=value
+enum class output_format : std::uint8_t { text, json, logfmt };
+
 namespace configuration {
-EXT_EXPORT_VC extern std::map<int, _detail::logtopic*> topics;
 // logging is configured globally via these variables
 // configure logging before you start logging!!!
-EXT_EXPORT_VC extern bool prefix_newline;
-EXT_EXPORT_VC extern bool append_newline;
-EXT_EXPORT_VC extern bool prefix_newline;
-EXT_EXPORT_VC extern bool append_newline;
-EXT_EXPORT_VC extern bool threads;
-EXT_EXPORT_VC extern bool filename;
-EXT_EXPORT_VC extern bool function;
+// the flags may be changed while logging (see watcher.hpp)
+EXT_EXPORT_VC extern std::atomic<bool> prefix_newline;
+EXT_EXPORT_VC extern std::atomic<bool> append_newline;
+EXT_EXPORT_VC extern std::atomic<bool> threads; // `{<tid> <name>}` in front of every line (see context.hpp)
+EXT_EXPORT_VC extern std::atomic<bool> filename;
+EXT_EXPORT_VC extern std::atomic<bool> function;
 #ifdef EXT_LOGGING_ENABLE_VIM_GDB
 EXT_EXPORT_VC extern bool vim;
 EXT_EXPORT_VC extern bool gdb;
 #endif
+EXT_EXPORT_VC extern timestamp_precision timestamp; // none by default
+EXT_EXPORT_VC extern std::atomic<bool> utc;         // local time otherwise
+// reads CLOCK_REALTIME_COARSE (linux) - cheaper but only as exact as the
+// kernel tick (1-10 ms)
+EXT_EXPORT_VC extern bool coarse_clock;
+// text by default - `prefix_newline`, `vim` and `gdb` only apply to text
+EXT_EXPORT_VC extern output_format format;
 EXT_EXPORT_VC extern std::ostream* stream;
+// when set records are passed to the sink instead of `stream`
+EXT_EXPORT_VC extern ext::logging::sink* sink;
 } // namespace configuration
 
 namespace topic {
@@ -85,5 +184,31 @@ EXT_EXPORT_VC extern _detail::logtopic dev;
 EXT_EXPORT_VC extern _detail::logtopic network;
 EXT_EXPORT_VC extern _detail::logtopic engine;
 } // namespace topic
+
+// Compile-time maximum level of a topic. `EXT_LOG_CONST` statements above the
+// ceiling are discarded, `EXT_LOG` statements above it are never active. The
+// ceiling must be the same in every translation unit, so set it in a header
+// included before the first log statement or with the compile definitions
+// below (e.g. -DEXT_LOGGING_CEILING_NETWORK=warn). `EXT_LOGGING_TOPIC_CEILING`
+// must be used at global namespace scope.
+template<_detail::logtopic const& topic_>
+inline constexpr level topic_ceiling = level::trace;
+
+#define EXT_LOGGING_TOPIC_CEILING(topic_, level_) \
+    template<>                                   \
+    inline constexpr ext::logging::level ext::logging::topic_ceiling<ext::logging::topic::topic_> = ext::logging::level::level_
+
+#ifdef EXT_LOGGING_CEILING_NO_TOPIC
+EXT_LOGGING_TOPIC_CEILING(no_topic, EXT_LOGGING_CEILING_NO_TOPIC);
+#endif // EXT_LOGGING_CEILING_NO_TOPIC
+#ifdef EXT_LOGGING_CEILING_DEV
+EXT_LOGGING_TOPIC_CEILING(dev, EXT_LOGGING_CEILING_DEV);
+#endif // EXT_LOGGING_CEILING_DEV
+#ifdef EXT_LOGGING_CEILING_NETWORK
+EXT_LOGGING_TOPIC_CEILING(network, EXT_LOGGING_CEILING_NETWORK);
+#endif // EXT_LOGGING_CEILING_NETWORK
+#ifdef EXT_LOGGING_CEILING_ENGINE
+EXT_LOGGING_TOPIC_CEILING(engine, EXT_LOGGING_CEILING_ENGINE);
+#endif // EXT_LOGGING_CEILING_ENGINE
 }}     // namespace ext::logging
 #endif // EXT_LOGGING_DEFINITIONS_HEADER
@@ -0,0 +1,118 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Emergency logging:
+//
+// `EXT_LOG_SIGNAL` may be used in signal handlers and in the child of a
+// `fork()` before `exec`. The message is formatted into a buffer on the stack
+// (`line::capacity` bytes, longer messages are cut) and written with a single
+// `write(2)` to `emergency::fd()` - no allocation, no lock, no stream and no
+// sink. Only the level of the topic is checked - ids switched off with
+// `set_enabled` are written anyway and `fatal` does not terminate. Strings,
+// characters, integers, floating point numbers and pointers can be written.
+//
+// Fork handlers are installed with the library: `fork()` waits until no
+// thread holds `logmutex`, the configured sink is flushed before, so its
+// buffer is not written by both processes. The child does not inherit a
+// locked mutex and continues without the async writer - messages queued but
+// not written stay with the parent. It reads its thread id again and starts
+// with empty flight recorder rings. The child also drops `configuration::sink`
+// and the binary sink and writes to `configuration::stream` until it sets
+// sinks of its own: their threads (`rotating_file_sink`,
+// `compressed_file_sink`, `coalescing_sink`) do not exist in the child and a
+// `rotating_file_sink` shares its mapped segment with the parent, so both
+// processes would write over each other's records.
+//
+// Usage
+//  ext::logging::emergency::set_fd(crash_log_fd);
+//  EXT_LOG_SIGNAL("dead", error) << "caught signal " << signal_number;
+
+#ifndef EXT_LOGGING_EMERGENCY_HEADER
+#define EXT_LOGGING_EMERGENCY_HEADER
+#ifndef _WIN32
+
+#include <cstddef>
+#include <ext/logging/definitions.hpp>
+#include <ext/macros/compiler.hpp>
+#include <string_view>
+#include <type_traits>
+
+namespace ext { namespace logging { namespace emergency {
+
+// file descriptor of emergency messages - `STDERR_FILENO` by default
+EXT_EXPORT_VC void set_fd(int fd) noexcept;
+EXT_EXPORT_VC int fd() noexcept;
+
+// one message - written when it is destroyed
+class EXT_EXPORT_VC line {
+public:
+    // at most PIPE_BUF, so a line written to a pipe is never interleaved
+    static constexpr std::size_t capacity = 1024;
+
+    line(char const* id,
+         _detail::logtopic const& topic,
+         level level_,
+         char const* file_name,
+         int line_no,
+         char const* function) noexcept;
+    ~line();
+    line(line const&) = delete;
+    line& operator=(line const&) = delete;
+
+    line& operator<<(std::string_view value) noexcept {
+        append(value.data(), value.size());
+        return *this;
+    }
+    line& operator<<(char const* value) noexcept {
+        return *this << (value ? std::string_view(value) : std::string_view("(null)"));
+    }
+    line& operator<<(char value) noexcept {
+        append(&value, 1);
+        return *this;
+    }
+    line& operator<<(bool value) noexcept {
+        return *this << (value ? std::string_view("true") : std::string_view("false"));
+    }
+    template<typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+    line& operator<<(T value) noexcept {
+        if constexpr (std::is_signed_v<T>) {
+            put(static_cast<long long>(value));
+        } else {
+            put(static_cast<unsigned long long>(value));
+        }
+        return *this;
+    }
+    line& operator<<(double value) noexcept;
+    line& operator<<(void const* value) noexcept;
+
+private:
+    void append(char const* data, std::size_t size) noexcept;
+    void put(long long value) noexcept;
+    void put(unsigned long long value) noexcept;
+
+    std::size_t _size = 0;
+    bool _cut = false; // the message did not fit
+    char _buffer[capacity];
+};
+
+}}} // namespace ext::logging::emergency
+
+namespace ext { namespace logging { namespace _detail {
+// registers the fork handlers - called once by logging.cpp
+EXT_EXPORT_VC bool install_fork_handlers() noexcept;
+// taken before `fork()` after `logmutex` and released in both processes (logging.cpp)
+EXT_EXPORT_VC void lock_sites() noexcept;
+EXT_EXPORT_VC void unlock_sites() noexcept;
+// the writer thread does not exist in the child of a fork (async.cpp)
+EXT_EXPORT_VC void async_forget_writer() noexcept;
+// taken before `fork()` after the sites - the child empties the rings (recorder.cpp)
+EXT_EXPORT_VC void lock_recorder() noexcept;
+EXT_EXPORT_VC void unlock_recorder() noexcept;
+EXT_EXPORT_VC void recorder_forget_threads() noexcept;
+// the child reads its thread id again (context.cpp)
+EXT_EXPORT_VC void forget_thread_identity() noexcept;
+// the child does not write to the binary sink of the parent (binary.cpp)
+EXT_EXPORT_VC void binary_forget_sink() noexcept;
+}}}    // namespace ext::logging::_detail
+#endif // _WIN32
+#endif // EXT_LOGGING_EMERGENCY_HEADER
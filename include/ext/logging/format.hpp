@@ -0,0 +1,372 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Format strings:
+//
+// `EXT_LOGF` (see logging.hpp) takes a format string with `{}` placeholders
+// instead of an `operator<<` chain. The format string must be a literal. It is
+// checked against the arguments at compile time: the number of placeholders,
+// the braces and whether a spec fits the type of its argument. Numbers are
+// formatted with `std::to_chars` straight into the message buffer.
+//
+// A placeholder is `{}` or `{:spec}`, `{{` and `}}` are literal braces:
+//  spec = [[fill]align][sign][#][0][width][.precision][type]
+//  align: < left, > right, ^ center    sign: + - space
+//  integers: d x X b B o c    floats: f F e E g G a A    strings: s
+//  bools: s or an integer type    chars: c or an integer type    pointers: p
+// Floats without type and precision use the shortest representation that
+// reads back to the same value. Width and precision count bytes.
+//
+// Other types need a `formatter` specialization (see below) or an
+// `operator<<`, which is used as fallback and only accepts fill, align and
+// width.
+//
+// Usage
+//  EXT_LOGF("cafe", network, info, "x={} y={:.3f} mask={:#010x}", x, y, mask);
+//
+//  template<>
+//  struct ext::logging::formatter<point> {
+//      static void format(format_output& out, point const& p, format_spec const&) {
+//          out.append('(');
+//          out.write(p.x);
+//          out.append(", ");
+//          out.write(p.y);
+//          out.append(')');
+//      }
+//  };
+
+#ifndef EXT_LOGGING_FORMAT_HEADER
+#define EXT_LOGGING_FORMAT_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <ext/logging/functionality.hpp>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace ext { namespace logging {
+
+struct format_spec {
+    enum align_type : char { none = 0, left = '<', right = '>', center = '^' };
+
+    char fill = ' ';
+    align_type align = none;
+    char sign = '-'; // '-', '+' or ' '
+    bool alternate = false;
+    bool zero = false;
+    int width = 0;
+    int precision = -1; // not set
+    char type = 0;      // not set
+};
+
+// target of a `formatter` - appends to the message that is built
+class format_output {
+public:
+    format_output(_detail::message_buffer& buffer, std::ostream& stream) noexcept : _buffer(buffer), _stream(stream) {}
+
+    void append(std::string_view text) {
+        _buffer.append(text);
+    }
+
+    void append(char c) {
+        _buffer.append(c);
+    }
+
+    // formats a value as a placeholder with `spec` would
+    template<typename T>
+    void write(T const& value, format_spec const& spec = {});
+
+    _detail::message_buffer& buffer() noexcept {
+        return _buffer;
+    }
+
+    std::ostream& stream() noexcept {
+        return _stream;
+    }
+
+private:
+    _detail::message_buffer& _buffer;
+    std::ostream& _stream;
+};
+
+// Customization point: a specialization provides
+//  static void format(format_output& out, T const& value, format_spec const& spec);
+// Fill, align and width are applied to the output afterwards.
+template<typename T, typename Enable = void>
+struct formatter {};
+
+namespace _detail {
+// formatting of the built-in types - defined in format.cpp
+EXT_EXPORT_VC void format_value(format_output& out, long long value, format_spec const& spec);
+EXT_EXPORT_VC void format_value(format_output& out, unsigned long long value, format_spec const& spec);
+EXT_EXPORT_VC void format_value(format_output& out, float value, format_spec const& spec);
+EXT_EXPORT_VC void format_value(format_output& out, double value, format_spec const& spec);
+EXT_EXPORT_VC void format_value(format_output& out, bool value, format_spec const& spec);
+EXT_EXPORT_VC void format_value(format_output& out, char value, format_spec const& spec);
+EXT_EXPORT_VC void format_value(format_output& out, std::string_view value, format_spec const& spec);
+EXT_EXPORT_VC void format_value(format_output& out, void const* value, format_spec const& spec);
+
+template<typename T, typename = void>
+struct has_formatter : std::false_type {};
+template<typename T>
+struct has_formatter<T,
+                     std::void_t<decltype(formatter<T>::format(std::declval<format_output&>(),
+                                                               std::declval<T const&>(),
+                                                               std::declval<format_spec const&>()))>>
+    : std::true_type {};
+
+template<typename T, typename = void>
+struct is_streamable : std::false_type {};
+template<typename T>
+struct is_streamable<T, std::void_t<decltype(std::declval<std::ostream&>() << std::declval<T const&>())>>
+    : std::true_type {};
+
+enum class arg_kind : std::uint8_t { integer, floating, boolean, character, string, pointer, custom, stream, invalid };
+
+template<typename T>
+constexpr arg_kind kind_of() noexcept {
+    if constexpr (has_formatter<T>::value) {
+        return arg_kind::custom;
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return arg_kind::boolean;
+    } else if constexpr (std::is_same_v<T, char>) {
+        return arg_kind::character;
+    } else if constexpr (std::is_integral_v<T>) {
+        return arg_kind::integer;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return arg_kind::floating;
+    } else if constexpr (std::is_convertible_v<T const&, std::string_view>) {
+        return arg_kind::string;
+    } else if constexpr (std::is_pointer_v<T> || std::is_same_v<T, std::nullptr_t>) {
+        return arg_kind::pointer;
+    } else if constexpr (is_streamable<T>::value) {
+        return arg_kind::stream;
+    } else {
+        return arg_kind::invalid;
+    }
+}
+
+constexpr bool is_digit(char c) noexcept {
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool is_align(char c) noexcept {
+    return c == '<' || c == '>' || c == '^';
+}
+
+// parses the part behind `:` - false if it is not a valid spec
+constexpr bool parse_spec(std::string_view text, format_spec& spec) noexcept {
+    std::size_t i = 0;
+    auto const size = text.size();
+    auto parse_number = [&text, &i, size](int& number) {
+        number = 0;
+        while (i < size && is_digit(text[i])) {
+            if (number > 100000) {
+                return false;
+            }
+            number = number * 10 + (text[i++] - '0');
+        }
+        return true;
+    };
+
+    if (size >= 2 && is_align(text[1]) && text[0] != '{' && text[0] != '}') {
+        spec.fill = text[0];
+        spec.align = static_cast<format_spec::align_type>(text[1]);
+        i = 2;
+    } else if (size >= 1 && is_align(text[0])) {
+        spec.align = static_cast<format_spec::align_type>(text[0]);
+        i = 1;
+    }
+    if (i < size && (text[i] == '+' || text[i] == '-' || text[i] == ' ')) {
+        spec.sign = text[i++];
+    }
+    if (i < size && text[i] == '#') {
+        spec.alternate = true;
+        ++i;
+    }
+    if (i < size && text[i] == '0') {
+        spec.zero = true;
+        ++i;
+    }
+    if (!parse_number(spec.width)) {
+        return false;
+    }
+    if (i < size && text[i] == '.') {
+        ++i;
+        if (i == size || !is_digit(text[i]) || !parse_number(spec.precision)) {
+            return false;
+        }
+    }
+    if (i < size) {
+        spec.type = text[i++];
+        if (std::string_view("dxXbBocfFeEgGaAsp").find(spec.type) == std::string_view::npos) {
+            return false;
+        }
+    }
+    return i == size;
+}
+
+// whether `spec` may be used with an argument of `kind`
+constexpr bool spec_fits(format_spec const& spec, arg_kind kind) noexcept {
+    std::string_view const integer_types("dxXbBo");
+    bool const plain = spec.sign == '-' && !spec.alternate && !spec.zero;
+    bool const integer_type = spec.type && integer_types.find(spec.type) != std::string_view::npos;
+    switch (kind) {
+        case arg_kind::integer:
+            return spec.precision < 0 && (!spec.type || integer_type || spec.type == 'c');
+        case arg_kind::character:
+            return spec.precision < 0 && (!spec.type || spec.type == 'c' ? plain : integer_type);
+        case arg_kind::boolean:
+            return spec.precision < 0 && (!spec.type || spec.type == 's' ? plain : integer_type);
+        case arg_kind::floating:
+            return !spec.type || std::string_view("fFeEgGaA").find(spec.type) != std::string_view::npos;
+        case arg_kind::string:
+            return plain && (!spec.type || spec.type == 's');
+        case arg_kind::pointer:
+            return spec.precision < 0 && spec.sign == '-' && !spec.alternate && (!spec.type || spec.type == 'p');
+        case arg_kind::custom:
+            return true;
+        case arg_kind::stream:
+            return plain && spec.precision < 0 && !spec.type;
+        default:
+            return false;
+    }
+}
+
+// Not constexpr - a failing check calls one of these during constant
+// evaluation, so the compiler error names the problem.
+inline void format_error_unmatched_brace() {}
+inline void format_error_positional_arguments_are_not_supported() {}
+inline void format_error_invalid_spec() {}
+inline void format_error_more_placeholders_than_arguments() {}
+inline void format_error_more_arguments_than_placeholders() {}
+inline void format_error_spec_does_not_fit_argument_type() {}
+inline void format_error_argument_can_not_be_formatted() {}
+
+// the types of the format string and the arguments - only used in decltype
+template<typename... Ts>
+struct type_list {};
+template<typename... Ts>
+type_list<std::decay_t<Ts>...> format_types(Ts const&...);
+
+// checks `fmt` against the arguments - only used in constant expressions
+template<typename Format, typename... Args>
+constexpr bool check_format(type_list<Format, Args...>, std::string_view fmt) {
+    constexpr arg_kind kinds[] = {kind_of<Args>()..., arg_kind::invalid};
+    for (std::size_t i = 0; i < sizeof...(Args); ++i) {
+        if (kinds[i] == arg_kind::invalid) {
+            format_error_argument_can_not_be_formatted();
+        }
+    }
+
+    std::size_t arg = 0;
+    for (std::size_t i = 0; i < fmt.size(); ++i) {
+        if (fmt[i] == '}') {
+            if (i + 1 == fmt.size() || fmt[i + 1] != '}') {
+                format_error_unmatched_brace();
+            }
+            ++i;
+            continue;
+        }
+        if (fmt[i] != '{') {
+            continue;
+        }
+        if (i + 1 < fmt.size() && fmt[i + 1] == '{') {
+            ++i;
+            continue;
+        }
+
+        auto const close = fmt.find('}', i);
+        if (close == std::string_view::npos) {
+            format_error_unmatched_brace();
+        }
+        auto const field = fmt.substr(i + 1, close - i - 1);
+        format_spec spec;
+        if (!field.empty() && field[0] != ':') {
+            format_error_positional_arguments_are_not_supported();
+        }
+        if (!field.empty() && !parse_spec(field.substr(1), spec)) {
+            format_error_invalid_spec();
+        }
+        if (arg == sizeof...(Args)) {
+            format_error_more_placeholders_than_arguments();
+        }
+        if (!spec_fits(spec, kinds[arg])) {
+            format_error_spec_does_not_fit_argument_type();
+        }
+        ++arg;
+        i = close;
+    }
+    if (arg != sizeof...(Args)) {
+        format_error_more_arguments_than_placeholders();
+    }
+    return true;
+}
+
+// a type erased argument
+struct format_arg {
+    void const* value;
+    void (*write)(format_output& out, void const* value, format_spec const& spec);
+    bool numeric; // right aligned by default
+};
+
+template<typename T>
+void write_arg(format_output& out, void const* value, format_spec const& spec) {
+    auto const& arg = *static_cast<T const*>(value);
+    constexpr auto kind = kind_of<T>();
+    if constexpr (kind == arg_kind::custom) {
+        formatter<T>::format(out, arg, spec);
+    } else if constexpr (kind == arg_kind::integer) {
+        if constexpr (std::is_signed_v<T>) {
+            format_value(out, static_cast<long long>(arg), spec);
+        } else {
+            format_value(out, static_cast<unsigned long long>(arg), spec);
+        }
+    } else if constexpr (std::is_same_v<T, float>) {
+        format_value(out, arg, spec);
+    } else if constexpr (kind == arg_kind::floating) {
+        format_value(out, static_cast<double>(arg), spec);
+    } else if constexpr (kind == arg_kind::boolean || kind == arg_kind::character) {
+        format_value(out, arg, spec);
+    } else if constexpr (kind == arg_kind::string) {
+        if constexpr (std::is_pointer_v<T>) {
+            format_value(out, arg ? std::string_view(arg) : std::string_view("(null)"), spec);
+        } else {
+            format_value(out, std::string_view(arg), spec);
+        }
+    } else if constexpr (kind == arg_kind::pointer) {
+        format_value(out, static_cast<void const*>(arg), spec);
+    } else {
+        static_assert(kind == arg_kind::stream, "the type has neither a formatter nor an operator<<");
+        out.stream() << arg;
+    }
+}
+
+template<typename T>
+format_arg make_format_arg(T const& value) noexcept {
+    constexpr auto kind = kind_of<T>();
+    return {&value, &write_arg<T>, kind == arg_kind::integer || kind == arg_kind::floating};
+}
+
+// formats the checked `fmt` - defined in format.cpp
+EXT_EXPORT_VC void vformat(format_output& out, std::string_view fmt, format_arg const* args, std::size_t count);
+} // namespace _detail
+
+template<typename T>
+void format_output::write(T const& value, format_spec const& spec) {
+    auto const arg = _detail::make_format_arg(value);
+    arg.write(*this, arg.value, spec);
+}
+
+template<typename... Args>
+_detail::logger& _detail::logger::format(std::string_view fmt, Args const&... args) {
+    format_output out(_message.buffer, _ss);
+    format_arg const list[] = {make_format_arg(args)..., format_arg{nullptr, nullptr, false}};
+    vformat(out, fmt, list, sizeof...(Args));
+    return *this;
+}
+
+}}     // namespace ext::logging
+#endif // EXT_LOGGING_FORMAT_HEADER
@@ -4,67 +4,362 @@
 #define EXT_LOGGING_FUNCTIONALITY_HEADER
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <ext/logging/definitions.hpp>
+#include <ext/logging/metrics.hpp>
 #include <ext/macros/platform.hpp>
 #include <ext/util/basic.hpp>
 #include <iostream>
-#include <sstream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace ext { namespace logging {
 
 namespace _detail {
-inline bool variable_level_is_active(level macro_level, logtopic topic = topic::no_topic) {
+// Takes the topic by reference and reads its level with a relaxed load. A
+// disabled log statement costs one load and one compare - the checked level
+// includes the level kept by the flight recorder, the logger decides whether
+// the message is written or only recorded.
+inline bool variable_level_is_active(level macro_level, logtopic const& topic = topic::no_topic) noexcept {
     // activation_level 60(info) && macro_level 20 (error) -> log
     // activation_level 60(info) && macro_level 100(trace) -> no log
     // activation level must be greater than macro level
+    auto const activation_level = topic.checked_level.load(std::memory_order_relaxed);
 #ifdef NOT_DEFINED
     std::cerr << "####################" << std::endl;
-    std::cerr << "activation_level: " << level_to_str(topic.activation_level) << std::endl;
+    std::cerr << "activation_level: " << level_to_str(activation_level) << std::endl;
     std::cerr << "macro_level: " << level_to_str(macro_level) << std::endl;
-    std::cerr << "activates: " << std::boolalpha << (topic.activation_level >= macro_level) << std::endl;
+    std::cerr << "activates: " << std::boolalpha << (activation_level >= macro_level) << std::endl;
     std::cerr << "####################" << std::endl;
 #endif
-    return topic.activation_level >= macro_level;
+    if (activation_level >= macro_level) {
+        return true;
+    }
+#ifdef EXT_LOGGING_METRICS
+    count(topic.id, macro_level, metrics::counter::suppressed);
+#endif // EXT_LOGGING_METRICS
+    return false;
+}
+
+// the level of the topic alone - for statements the recorder does not keep
+inline bool level_is_emitted(level macro_level, logtopic const& topic) noexcept {
+    return topic.activation_level.load(std::memory_order_relaxed) >= macro_level;
 }
 
 inline constexpr bool constexpr_level_is_active(level macro_level) {
     return _detail::logtopic::default_level >= macro_level;
 }
 
-// this class does the real work it has to take care that messages
-// are not interleaved and it is reposible for organizing the output
-// stream, file, network
+template<logtopic const& topic_>
+inline constexpr bool constexpr_level_is_active(level macro_level) {
+    return constexpr_level_is_active(macro_level) && topic_ceiling<topic_> >= macro_level;
+}
+
+// strips the directory part of `__FILE__` without allocating
+inline constexpr std::string_view filename(std::string_view path) noexcept {
+    auto pos = path.find_last_of("/\\");
+    return pos == std::string_view::npos ? path : path.substr(pos + 1);
+}
+
+// streambuf that writes into an inline buffer and moves to the heap only if
+// a message does not fit. The storage is kept when the buffer is cleared so a
+// reused buffer does not allocate once it has seen the longest message.
+class message_buffer : public std::streambuf {
+public:
+    static constexpr std::size_t inline_size = 512;
+
+    message_buffer() noexcept {
+        setp(_inline, _inline + inline_size);
+    }
+    message_buffer(message_buffer const&) = delete;
+    message_buffer& operator=(message_buffer const&) = delete;
+
+    void clear() noexcept {
+        setp(pbase(), epptr());
+    }
+
+    char* data() noexcept {
+        return pbase();
+    }
+
+    std::string_view view() const noexcept {
+        return {pbase(), static_cast<std::size_t>(pptr() - pbase())};
+    }
+
+    std::size_t size() const noexcept {
+        return static_cast<std::size_t>(pptr() - pbase());
+    }
+
+    void append(std::string_view str) {
+        xsputn(str.data(), static_cast<std::streamsize>(str.size()));
+    }
+
+    void append(char c) {
+        if (pptr() == epptr()) {
+            grow(1);
+        }
+        *pptr() = c;
+        pbump(1);
+    }
+
+    // adds `count` uninitialized characters - used to escape in place
+    void extend(std::size_t count) {
+        if (static_cast<std::size_t>(epptr() - pptr()) < count) {
+            grow(count);
+        }
+        pbump(static_cast<int>(count));
+    }
+
+    // drops everything behind the first `size` characters
+    void truncate(std::size_t size_) noexcept {
+        setp(pbase(), epptr());
+        pbump(static_cast<int>(size_));
+    }
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(char const* str, std::streamsize count) override;
+
+private:
+    void grow(std::size_t required);
+
+    char _inline[inline_size];
+    std::unique_ptr<char[]> _heap;
+};
+
+// Writes the current time followed by a space as configured by
+// `configuration::timestamp` and returns the number of characters (0 when
+// timestamps are off). The date and time of day are cached per thread and
+// only formatted again when the second changes.
+constexpr std::size_t timestamp_max_size = 32;
+EXT_EXPORT_VC std::size_t format_timestamp(char (&out)[timestamp_max_size]) noexcept;
 
-// TODO - provide different backends
+// Encoders of the structured formats. They work on the buffer a message is
+// built in and never create temporary strings. Values are written raw and
+// escaped in place afterwards (json: `"`, `\` and control characters, logfmt
+// additionally quotes values with spaces, `=` or `"`), so an `operator<<`
+// can produce a value as well.
+//
+// escapes `buffer[start, size)` - for text and logfmt quotes are added if needed
+EXT_EXPORT_VC void escape_tail(message_buffer& buffer, std::size_t start, output_format format);
+// writes the separator and the key of a field: ` key=` or `,"key":`
+EXT_EXPORT_VC void begin_field(message_buffer& buffer, std::string_view key, output_format format);
+// integers and floating point values (json has no nan or inf - they are null)
+EXT_EXPORT_VC void put_number(message_buffer& buffer, long long value);
+EXT_EXPORT_VC void put_number(message_buffer& buffer, unsigned long long value);
+EXT_EXPORT_VC void put_number(message_buffer& buffer, double value, output_format format);
+
+// a buffer and the ostream that writes to it - one of these is kept per thread
+struct message_stream {
+    message_stream() : buffer(), stream(&buffer), fields_stream(&fields), defaults(stream.flags()) {}
+
+    message_buffer buffer;
+    message_buffer fields; // encoded `kv` fields - they go behind the message
+    std::ostream stream;
+    std::ostream fields_stream;
+    std::ios_base::fmtflags defaults;
+    bool in_use = false;
+
+    // returns the thread's stream or a fresh one if that is already in use
+    // (logging while a log message is built)
+    EXT_EXPORT_VC static message_stream& acquire();
+    EXT_EXPORT_VC static void release(message_stream& stream) noexcept;
+};
+
+// Static data of one log macro expansion. It is constant initialized, so it
+// costs nothing until the site logs for the first time. Then it registers
+// itself, so that it can be switched on and off by its log-id, and caches the
+// prefix of its messages for the current configuration.
+struct prefix_cache;
+
+struct call_site {
+    enum state_type : std::uint8_t { unregistered = 0, enabled_state = 1, disabled_state = 2 };
+
+    constexpr call_site(char const* id_,
+                        logtopic const* topic_,
+                        level level__,
+                        char const* file_,
+                        int line_,
+                        char const* function_) noexcept
+        : id(id_)
+        , hash(id_hash(id_))
+        , topic(topic_)
+        , level_(level__)
+        , file(file_)
+        , line(line_)
+        , function(function_) {}
+    call_site(call_site const&) = delete;
+    call_site& operator=(call_site const&) = delete;
+
+    bool enabled() noexcept {
+        auto current = state.load(std::memory_order_relaxed);
+        if (current == unregistered) {
+            current = register_site();
+        }
+        return current == enabled_state;
+    }
+
+    // prefix of every message of this site - rebuilt when the configuration
+    // changes, valid until the thread asks for the next prefix
+    EXT_EXPORT_VC std::string_view prefix();
+
+    char const* id;
+    std::uint64_t hash; // of the id - ids are compared by their hash
+    logtopic const* topic;
+    level level_;
+    char const* file;
+    int line;
+    char const* function;
+
+    std::atomic<std::uint8_t> state{unregistered};
+    std::atomic<prefix_cache const*> cached{nullptr};
+    call_site* next = nullptr; // registered sites
+#ifdef EXT_LOGGING_METRICS
+    std::atomic<std::uint64_t> emitted{0};
+#endif // EXT_LOGGING_METRICS
+
+private:
+    EXT_EXPORT_VC EXT_LOGGING_COLD std::uint8_t register_site();
+};
+
+// this class does the real work it has to take care that messages
+// are not interleaved - the output is done by `configuration::sink`
+// (see sinks.hpp) or `configuration::stream`
 
 struct logger {
-    std::stringstream _ss; // used to build up the log message
-    std::ostream& _out;    // output - may change
+    message_stream& _message; // reusable per thread buffer
+    std::ostream& _ss;        // used to build up the log message
+    std::ostream& _out;       // output - may change
     level _level;
+    logtopic const* _topic;
+    call_site* _site = nullptr;
+    std::uint64_t _suppressed = 0; // reported after the message
+    std::uint32_t _payload = 0;    // size of the prefix
+    bool _record_only = false;     // level not active - for the flight recorder
 
-    logger(char const* id,
-           logtopic const& topic,
-           level level_,
-           const char* file_name,
-           int line_no,
-           const char* function = "none");
+    EXT_LOGGING_COLD logger(char const* id,
+                            logtopic const& topic,
+                            level level_,
+                            const char* file_name,
+                            int line_no,
+                            const char* function = "none");
+    EXT_LOGGING_COLD explicit logger(call_site& site);
 
-    virtual ~logger();
-    void write(); // may become virtual
+    EXT_LOGGING_COLD virtual ~logger();
+    void write();
 
+    // number of messages a limiter suppressed since the last message of the site
+    logger& suppressed(std::uint64_t count) noexcept {
+        _suppressed = count;
+        return *this;
+    }
+
+    // Adds a field in the configured format, e.g.
+    //  EXT_LOG("cafe", info).kv("user", uid).kv("latency_us", t) << "done";
+    // Numbers and bools are written unquoted, everything else as escaped string.
     template<typename T>
-    logger& operator<<(T&& value) {
-        _ss << std::forward<T>(value);
+    logger& kv(std::string_view key, T const& value) {
+        auto const format = configuration::format;
+        auto& fields = _message.fields;
+        begin_field(fields, key, format);
+        if constexpr (std::is_same_v<T, bool>) {
+            fields.append(value ? "true" : "false");
+        } else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, char>) {
+            if constexpr (std::is_signed_v<T>) {
+                put_number(fields, static_cast<long long>(value));
+            } else {
+                put_number(fields, static_cast<unsigned long long>(value));
+            }
+        } else if constexpr (std::is_floating_point_v<T>) {
+            put_number(fields, static_cast<double>(value), format);
+        } else {
+            bool const json = format == output_format::json;
+            if (json) {
+                fields.append('"');
+            }
+            auto const start = fields.size();
+            if constexpr (std::is_convertible_v<T const&, std::string_view>) {
+                fields.append(std::string_view(value));
+            } else {
+                _message.fields_stream << value;
+            }
+            escape_tail(fields, start, format);
+            if (json) {
+                fields.append('"');
+            }
+        }
         return *this;
     }
+
+    // formats a message checked by `EXT_LOGF` - defined in format.hpp
+    template<typename... Args>
+    logger& format(std::string_view fmt, Args const&... args);
+
+    // strings and the common numbers are written by out of line functions,
+    // so a statement only expands to calls
+    template<typename T>
+    logger& operator<<(T&& value) {
+#ifndef EXT_LOGGING_NO_COLD
+        using type = std::decay_t<T>;
+        if constexpr (std::is_same_v<type, char const*> || std::is_same_v<type, char*> ||
+                      std::is_same_v<type, std::string> || std::is_same_v<type, std::string_view>) {
+            return put(std::string_view(value));
+        } else if constexpr (std::is_same_v<type, int> || std::is_same_v<type, long> ||
+                             std::is_same_v<type, long long> || std::is_same_v<type, unsigned> ||
+                             std::is_same_v<type, unsigned long> || std::is_same_v<type, unsigned long long> ||
+                             std::is_same_v<type, double>) {
+            return put(value);
+        } else
+#endif // EXT_LOGGING_NO_COLD
+        {
+            _ss << std::forward<T>(value);
+            return *this;
+        }
+    }
+
+    EXT_LOGGING_COLD logger& put(std::string_view value);
+    EXT_LOGGING_COLD logger& put(int value);
+    EXT_LOGGING_COLD logger& put(long value);
+    EXT_LOGGING_COLD logger& put(long long value);
+    EXT_LOGGING_COLD logger& put(unsigned value);
+    EXT_LOGGING_COLD logger& put(unsigned long value);
+    EXT_LOGGING_COLD logger& put(unsigned long long value);
+    EXT_LOGGING_COLD logger& put(double value);
 };
 
+// replaced prefixes that are not freed yet - a thread may still copy them
+EXT_EXPORT_VC std::size_t retired_prefixes();
+
+// a complete line of `site` in the configured format with `note` as message -
+// used by sinks that add lines of their own, returns the offset of the message
+EXT_EXPORT_VC std::uint32_t note_line(call_site& site, std::string_view note, std::string& out);
 } // namespace _detail
 
+// switches all log macros with the given log-id on or off - this includes
+// macros that have not logged yet
+EXT_EXPORT_VC void set_enabled(std::string_view id, bool enabled);
+EXT_EXPORT_VC bool is_enabled(std::string_view id);
+
+// levels may be changed from any thread while other threads are logging
+inline void set_level(_detail::logtopic& topic, level level_) noexcept {
+    topic.activation_level.store(level_);
+    _detail::update_checked_level(topic);
+}
+
+inline level get_level(_detail::logtopic const& topic) noexcept {
+    return topic.activation_level.load(std::memory_order_relaxed);
+}
+
 inline void set_level_all(level level_) {
     std::lock_guard<std::mutex> lock(_detail::logmutex);
-    for (auto& topic : _detail::topics_map) {
-        topic.second->activation_level = level_;
+    for (std::size_t id = 0; id < _detail::topics_end; ++id) {
+        if (auto* topic = _detail::topics[id]) {
+            set_level(*topic, level_);
+        }
     }
 }
 }}     // namespace ext::logging
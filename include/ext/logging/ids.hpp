@@ -0,0 +1,74 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Log ids:
+//
+// The id of every log macro is hashed (`id_hash`) while its call site is
+// constant initialized. Filters and sites compare the hashes only.
+//
+// Ids switched off with `set_enabled` never log. While an allow list is set
+// only the ids in it log. Both lists are small open addressing hash sets that
+// are consulted when a site logs for the first time or a list changes - the
+// site keeps the result, so a statement still loads a single byte.
+//
+// `duplicate_ids` reports ids used by more than one statement and different
+// ids that share a hash - among the statements that have logged so far. At
+// build time `ext-logging-idcheck <source directories>` finds duplicate ids.
+//
+// Usage
+//  ext::logging::set_allowed_ids({"cafe", "babe"}); // all other ids are quiet
+//  ext::logging::clear_allowed_ids();
+//  for (auto const& duplicate : ext::logging::duplicate_ids()) { ... }
+
+#ifndef EXT_LOGGING_IDS_HEADER
+#define EXT_LOGGING_IDS_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <ext/logging/definitions.hpp>
+#include <ext/macros/compiler.hpp>
+#include <string_view>
+#include <vector>
+
+namespace ext { namespace logging {
+
+EXT_EXPORT_VC void set_allowed_ids(std::vector<std::string_view> const& ids);
+EXT_EXPORT_VC void clear_allowed_ids();
+
+struct id_location {
+    char const* id;
+    char const* file;
+    int line;
+};
+
+struct duplicate_id {
+    std::uint64_t hash;
+    std::vector<id_location> sites; // more than one id if the hashes collide
+};
+
+EXT_EXPORT_VC std::vector<duplicate_id> duplicate_ids();
+
+namespace _detail {
+// set of id hashes - linear probing, 0 marks a free slot
+class EXT_EXPORT_VC id_set {
+public:
+    bool contains(std::uint64_t hash) const noexcept;
+    void insert(std::uint64_t hash);
+    void erase(std::uint64_t hash) noexcept;
+    void clear() noexcept;
+
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+private:
+    std::size_t home(std::uint64_t hash) const noexcept {
+        return static_cast<std::size_t>(hash ^ (hash >> 32)) & (_slots.size() - 1);
+    }
+
+    std::vector<std::uint64_t> _slots; // empty or a power of 2
+    std::size_t _size = 0;
+};
+} // namespace _detail
+}}     // namespace ext::logging
+#endif // EXT_LOGGING_IDS_HEADER
@@ -0,0 +1,114 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Limiters:
+//
+// State of the `EXT_LOG_EVERY_N`, `EXT_LOG_FIRST_N`, `EXT_LOG_RATE` and
+// `EXT_LOG_SAMPLE` macros (see logging.hpp). Every macro expansion owns a
+// constant initialized limiter that is only updated with atomics. A rejected
+// message is counted and never builds a logger. The next message that passes
+// reports how many were suppressed in between.
+
+#ifndef EXT_LOGGING_LIMITERS_HEADER
+#define EXT_LOGGING_LIMITERS_HEADER
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ext/logging/functionality.hpp>
+#include <ext/logging/metrics.hpp>
+
+namespace ext { namespace logging { namespace _detail {
+
+// counts rejected messages until the next message passes
+struct suppressed_counter {
+    std::uint64_t take() noexcept {
+        // avoid the read-modify-write while nothing was suppressed
+        return suppressed.load(std::memory_order_relaxed) ? suppressed.exchange(0, std::memory_order_relaxed) : 0;
+    }
+
+    bool reject() noexcept {
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    std::atomic<std::uint64_t> suppressed{0};
+};
+
+// passes the 1st, (n+1)th, (2n+1)th, ... message
+struct every_n_limiter : suppressed_counter {
+    bool allow(std::uint64_t n) noexcept {
+        auto const current = count.fetch_add(1, std::memory_order_relaxed);
+        return (n <= 1 || current % n == 0) ? true : reject();
+    }
+
+    std::atomic<std::uint64_t> count{0};
+};
+
+// passes the first n messages - the count stops once the limit is reached
+struct first_n_limiter {
+    bool allow(std::uint64_t n) noexcept {
+        if (count.load(std::memory_order_relaxed) >= n) {
+            return false;
+        }
+        return count.fetch_add(1, std::memory_order_relaxed) < n;
+    }
+
+    std::uint64_t take() noexcept {
+        return 0;
+    }
+
+    std::atomic<std::uint64_t> count{0};
+};
+
+// Token bucket that passes at most `k` messages per `window` (burst of up to
+// `k`). Implemented as generic cell rate algorithm: a single atomic holds the
+// theoretical arrival time of the next message.
+struct rate_limiter : suppressed_counter {
+    template<typename Rep, typename Period>
+    bool allow(std::uint64_t k, std::chrono::duration<Rep, Period> window) noexcept {
+        using namespace std::chrono;
+        auto const now = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+        auto const interval = duration_cast<nanoseconds>(window).count() / static_cast<std::int64_t>(k ? k : 1);
+        auto const tolerance = duration_cast<nanoseconds>(window).count() - interval;
+
+        auto tat = arrival.load(std::memory_order_relaxed);
+        for (;;) {
+            auto const start = tat > now ? tat : now;
+            if (start - now > tolerance) {
+                return reject();
+            }
+            if (arrival.compare_exchange_weak(tat, start + interval, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+    std::atomic<std::int64_t> arrival{0};
+};
+
+// passes a random share of `ratio` (0.0 - 1.0) of all messages
+struct sample_limiter : suppressed_counter {
+    bool allow(double ratio) noexcept {
+        // xorshift64* - one state per thread
+        thread_local std::uint64_t state = 0;
+        if (state == 0) {
+            // seeded per thread without a guard variable
+            state = (0x9e3779b97f4a7c15ull ^ reinterpret_cast<std::uintptr_t>(&state)) | 1;
+        }
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        auto const random = (state * 0x2545f4914f6cdd1dull) >> 11; // 53 bits
+        return static_cast<double>(random) < ratio * 9007199254740992.0 ? true : reject();
+    }
+};
+
+// counts a message rejected by a limiter in the metrics - always false
+inline bool limited(logtopic const& topic, level level_) noexcept {
+    count(topic.id, level_, metrics::counter::suppressed);
+    return false;
+}
+
+}}}    // namespace ext::logging::_detail
+#endif // EXT_LOGGING_LIMITERS_HEADER
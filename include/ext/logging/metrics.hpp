@@ -0,0 +1,117 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Metrics:
+//
+// When compiled with `EXT_LOGGING_METRICS` (cmake: EXTLOG_METRICS) every thread
+// counts into a block of its own, so counting never shares a cache line with
+// another thread. Counters are kept per topic and level - topics with an id
+// of `max_topics` or more are counted together in one extra slot.
+// `metrics::collect()` sums the blocks of all threads. Without the definition
+// all counting compiles to nothing and `collect()` returns zeros.
+//
+// Usage
+//  auto snap = ext::logging::metrics::collect();
+//  snap.get(ext::logging::topic::network, ext::logging::level::info, ext::logging::metrics::counter::emitted);
+//  for (auto const& site : ext::logging::metrics::top_sites(10)) { ... }
+
+#ifndef EXT_LOGGING_METRICS_HEADER
+#define EXT_LOGGING_METRICS_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <ext/logging/definitions.hpp>
+#include <ext/macros/compiler.hpp>
+#include <vector>
+
+namespace ext { namespace logging { namespace metrics {
+
+#ifdef EXT_LOGGING_METRICS
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif // EXT_LOGGING_METRICS
+
+enum class counter : std::uint8_t {
+    emitted,    // messages written or handed to the async queue
+    suppressed, // messages not logged because of the topic level
+    bytes,      // bytes of emitted messages
+    wait_ns,    // time spent waiting for `logmutex` or a full async queue
+    sink_ns,    // time spent in the sink or stream on the logging thread
+    dropped,    // messages discarded by the async queue
+};
+
+constexpr std::size_t counter_count = 6;
+constexpr std::size_t level_count = 6;
+// topics with a slot of their own - larger ids share one more slot
+constexpr std::size_t max_topics = 32;
+constexpr std::size_t overflow_slot = max_topics;
+constexpr std::size_t topic_slots = max_topics + 1;
+
+constexpr std::size_t topic_index(int topic_id) noexcept {
+    return (topic_id >= 0 && static_cast<std::size_t>(topic_id) < max_topics) ? static_cast<std::size_t>(topic_id)
+                                                                                 : overflow_slot;
+}
+
+constexpr std::size_t level_index(level level_) noexcept {
+    auto const index = static_cast<std::size_t>(level_) / 20;
+    return index < level_count ? index : level_count - 1;
+}
+
+struct snapshot {
+    std::uint64_t get(int topic_id, level level_, counter what) const noexcept {
+        return values[topic_index(topic_id)][level_index(level_)][static_cast<std::size_t>(what)];
+    }
+
+    std::uint64_t get(_detail::logtopic const& topic, level level_, counter what) const noexcept {
+        return get(topic.id, level_, what);
+    }
+
+    // summed over all levels of a topic
+    std::uint64_t total(_detail::logtopic const& topic, counter what) const noexcept {
+        std::uint64_t sum = 0;
+        for (std::size_t l = 0; l < level_count; ++l) {
+            sum += values[topic_index(topic.id)][l][static_cast<std::size_t>(what)];
+        }
+        return sum;
+    }
+
+    // summed over all topics and levels
+    std::uint64_t total(counter what) const noexcept {
+        std::uint64_t sum = 0;
+        for (std::size_t t = 0; t < topic_slots; ++t) {
+            for (std::size_t l = 0; l < level_count; ++l) {
+                sum += values[t][l][static_cast<std::size_t>(what)];
+            }
+        }
+        return sum;
+    }
+
+    std::uint64_t values[topic_slots][level_count][counter_count] = {};
+};
+
+struct site_count {
+    char const* id;
+    char const* file;
+    int line;
+    std::uint64_t emitted;
+};
+
+// sums the counters of all threads (including threads that have exited)
+EXT_EXPORT_VC snapshot collect();
+// the following snapshots only count what happens after the call
+EXT_EXPORT_VC void reset();
+// the `count` call sites that emitted the most messages
+EXT_EXPORT_VC std::vector<site_count> top_sites(std::size_t count);
+
+}}} // namespace ext::logging::metrics
+
+namespace ext { namespace logging { namespace _detail {
+#ifdef EXT_LOGGING_METRICS
+EXT_EXPORT_VC void count(int topic_id, level level_, metrics::counter what, std::uint64_t value = 1) noexcept;
+void reset_site_counts();
+#else
+inline void count(int, level, metrics::counter, std::uint64_t = 1) noexcept {}
+#endif // EXT_LOGGING_METRICS
+}}}    // namespace ext::logging::_detail
+#endif // EXT_LOGGING_METRICS_HEADER
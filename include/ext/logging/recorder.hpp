@@ -0,0 +1,54 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Flight recorder:
+//
+// While the recorder runs, messages of a level that is not active for their
+// topic but within `record_level` are built as usual but not written. They
+// are kept in a fixed size ring buffer of the thread that logged them - no
+// lock, no I/O and no allocation after the first message of a thread. When a
+// buffer is full the oldest messages are overwritten.
+//
+// A `fatal` message or `dump()` merges the buffers of all threads (including
+// threads that have exited) by time and writes them to `configuration::sink`
+// or `configuration::stream` - for `fatal` right before the fatal message.
+// Every recorded message is dumped once.
+//
+// Only `EXT_LOG` style statements are recorded. `EXT_LOG_CONST` statements
+// above the compiled in level do not exist.
+//
+// Usage
+//  ext::logging::recorder::start({ext::logging::level::trace, 64 * 1024});
+//  EXT_LOG("cafe", network, debug) << "kept in memory";
+//  ext::logging::recorder::dump(); // or wait for a fatal message
+
+#ifndef EXT_LOGGING_RECORDER_HEADER
+#define EXT_LOGGING_RECORDER_HEADER
+
+#include <cstddef>
+#include <ext/logging/definitions.hpp>
+#include <ext/macros/compiler.hpp>
+#include <string_view>
+
+namespace ext { namespace logging { namespace recorder {
+
+struct options {
+    level record_level = level::trace;        // most verbose level that is kept
+    std::size_t bytes_per_thread = 64 * 1024; // size of the buffer of each thread
+};
+
+// starts recording - messages recorded before are no longer dumped
+EXT_EXPORT_VC void start(options const& opts = options{});
+// stops recording - the buffers can still be dumped
+EXT_EXPORT_VC void stop() noexcept;
+EXT_EXPORT_VC bool active() noexcept;
+// writes all messages recorded and not dumped yet - returns their number
+EXT_EXPORT_VC std::size_t dump();
+
+}}} // namespace ext::logging::recorder
+
+namespace ext { namespace logging { namespace _detail {
+// keeps a finished message in the buffer of the calling thread
+EXT_EXPORT_VC void record_message(level level_, std::string_view message);
+}}}    // namespace ext::logging::_detail
+#endif // EXT_LOGGING_RECORDER_HEADER
@@ -0,0 +1,94 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Rotating file sink:
+//
+// Records are copied into memory mapped, preallocated segment files named
+// `<directory>/<base_name>.<sequence>.log`. A segment is finished when it is
+// full or when the rotation interval passes. A background thread prepares
+// the next segment ahead of time and finishes old ones (unmap and truncate to
+// the written size), so switching files is only a pointer swap for the
+// writing thread. The background thread also deletes the oldest files once
+// `max_files` or `max_total_bytes` is exceeded.
+//
+// Until a segment is finished its file has the full segment size and the
+// unwritten rest is filled with zeros. The blocks are allocated when the
+// segment is created, so a full disk throws `std::system_error` there
+// instead of raising SIGBUS in a write through the mapping.
+
+#ifndef EXT_LOGGING_ROTATING_SINK_HEADER
+#define EXT_LOGGING_ROTATING_SINK_HEADER
+#ifndef _WIN32
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ext/logging/sinks.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ext { namespace logging {
+
+class EXT_EXPORT_VC rotating_file_sink : public sink {
+public:
+    struct options {
+        std::string directory = ".";
+        std::string base_name = "log";
+        std::size_t segment_size = 16 * 1024 * 1024;
+        std::chrono::seconds interval{0}; // rotate at multiples of interval - 0 disables
+        std::size_t max_files = 0;        // 0 - keep all files
+        std::uint64_t max_total_bytes = 0; // 0 - no limit
+    };
+
+    explicit rotating_file_sink(options opts);
+    ~rotating_file_sink();
+    rotating_file_sink(rotating_file_sink const&) = delete;
+    rotating_file_sink& operator=(rotating_file_sink const&) = delete;
+
+    using sink::write;
+    void write(record const& rec) override;
+    void flush() override;
+
+    // finishes the current segment and continues in a new one
+    void rotate();
+    std::string current_file() const;
+
+private:
+    struct segment {
+        std::uint64_t sequence = 0;
+        std::string path;
+        int fd = -1;
+        char* data = nullptr;
+        std::size_t size = 0;
+        std::size_t used = 0;
+    };
+
+    std::unique_ptr<segment> take_prepared();
+    std::unique_ptr<segment> create_segment(std::uint64_t sequence);
+    static void finish_segment(segment& seg);
+    static void discard_segment(segment& seg);
+    void apply_retention(bool closed);
+    void background();
+    void update_deadline();
+
+    options _opts;
+    std::unique_ptr<segment> _current;
+    std::chrono::system_clock::time_point _deadline;
+
+    // shared with the background thread
+    mutable std::mutex _mutex;
+    std::condition_variable _wake;
+    std::unique_ptr<segment> _prepared;
+    std::vector<std::unique_ptr<segment>> _finished;
+    std::uint64_t _next_sequence;
+    std::uint64_t _active_sequence; // files with a lower sequence are finished
+    bool _stop;
+    std::thread _thread;
+};
+
+}}     // namespace ext::logging
+#endif // _WIN32
+#endif // EXT_LOGGING_ROTATING_SINK_HEADER
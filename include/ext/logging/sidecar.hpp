@@ -0,0 +1,110 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Sidecar index:
+//
+// A `file_sink` created with `index_every = N` writes `<path>.idx` next to the
+// log file. After every N records it appends one entry describing the block
+// of the log file those records occupy: offset and size, the time range in
+// which they were written, a bitmap of their levels and bloom filters of
+// their topics and log ids. A block that does not contain a level, topic or
+// id is skipped by queries without reading it - a bloom filter may only let a
+// block through that does not match.
+//
+// Id and topic are taken from the call site of a record. Records without call
+// site are indexed by the fixed fields at the start of every text line
+// (`[<id>] <level> (<topic>)`). Blocks with records that can not be indexed
+// always match.
+//
+// `ext-logging-query` selects the blocks with the index, maps the log file and
+// scans the selected blocks on all cores. Without index the whole file is
+// scanned.
+//
+// Usage
+//  ext::logging::file_sink out("/var/log/app.log", 64 * 1024, ext::logging::level::error, 1024);
+//  ext-logging-query --id cafe --level warn /var/log/app.log
+//
+// File format (native byte order)
+//  header - "EXTLOGI1"
+//  entry  - u64 offset, u64 size, u64 first and u64 last nanoseconds since
+//           epoch, u32 records, u32 levels, u8[32] topic bloom, u8[256] id bloom
+
+#ifndef EXT_LOGGING_SIDECAR_HEADER
+#define EXT_LOGGING_SIDECAR_HEADER
+#ifndef _WIN32
+
+#include <cstddef>
+#include <cstdint>
+#include <ext/logging/sinks.hpp>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ext { namespace logging { namespace sidecar {
+
+constexpr char magic[] = "EXTLOGI1";
+constexpr std::size_t entry_size = 328;
+constexpr std::size_t topic_bloom_bits = 256;
+constexpr std::size_t id_bloom_bits = 2048;
+constexpr std::uint32_t unindexed = 1u << 31; // in `levels` - the block matches every query
+
+struct block_entry {
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+    std::uint64_t first = 0; // nanoseconds since epoch
+    std::uint64_t last = 0;
+    std::uint32_t records = 0;
+    std::uint32_t levels = 0; // bit `level / 20`
+    std::uint8_t topics[topic_bloom_bits / 8] = {};
+    std::uint8_t ids[id_bloom_bits / 8] = {};
+};
+
+// fixed fields of a text line - empty if the line does not start a record
+struct line_fields {
+    std::string_view id;
+    std::string_view topic; // empty for `no_topic`
+    level level_ = level::trace;
+};
+
+EXT_EXPORT_VC bool parse_line(std::string_view line, line_fields& out) noexcept;
+
+struct query {
+    std::vector<std::uint64_t> ids;    // hashes (`id_hash`) - empty matches all
+    std::vector<std::uint64_t> topics; // hashes of the names - empty matches all
+    level max_level = level::trace;    // least severe level that matches
+    std::uint64_t from = 0;            // only blocks whose time range overlaps [from, to]
+    std::uint64_t to = std::numeric_limits<std::uint64_t>::max();
+};
+
+// false if the block can not contain a matching record
+EXT_EXPORT_VC bool may_match(block_entry const& entry, query const& q) noexcept;
+EXT_EXPORT_VC bool matches(line_fields const& fields, query const& q) noexcept;
+
+// reads all complete entries - false if the file can not be read or is no index
+EXT_EXPORT_VC bool read(std::string const& path, std::vector<block_entry>& entries);
+
+// collects the records of one block and appends its entry to the index
+class EXT_EXPORT_VC writer {
+public:
+    // `offset` is the size of the log file when it was opened
+    writer(std::string const& path, std::uint64_t offset, std::size_t block_records);
+    ~writer();
+    writer(writer const&) = delete;
+    writer& operator=(writer const&) = delete;
+
+    // returns true when the block is full - it is written by `finish_block`
+    bool add(record const& rec);
+    // the log file must contain all records added so far
+    void finish_block();
+
+private:
+    int _fd;
+    std::size_t _block_records;
+    std::uint64_t _end; // of the records added so far
+    block_entry _entry;
+};
+
+}}}    // namespace ext::logging::sidecar
+#endif // _WIN32
+#endif // EXT_LOGGING_SIDECAR_HEADER
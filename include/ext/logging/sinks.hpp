@@ -0,0 +1,200 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Sinks:
+//
+// A sink receives finished log records and moves them to their destination.
+// When `configuration::sink` is set, records are passed to it instead of being
+// written to `configuration::stream`. Sinks are always called while the
+// `logmutex` is held (or by the single async writer thread), so they do not
+// need to synchronize themselves.
+//
+// Usage
+//  auto errors = std::make_shared<ext::logging::fd_sink>(2);
+//  auto all = std::make_shared<ext::logging::file_sink>("/var/log/app.log");
+//  ext::logging::fanout_sink fanout;
+//  fanout.add(errors, ext::logging::level::error);
+//  fanout.add(all);
+//  ext::logging::configuration::sink = &fanout;
+
+#ifndef EXT_LOGGING_SINKS_HEADER
+#define EXT_LOGGING_SINKS_HEADER
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <ext/logging/definitions.hpp>
+#include <ext/macros/compiler.hpp>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace ext { namespace logging {
+namespace sidecar {
+class writer;
+} // namespace sidecar
+
+// a formatted log line - the text is shared by all sinks and must not be changed
+struct record {
+    level level_;
+    std::string_view text;
+    _detail::call_site* site = nullptr; // origin of the record - null if unknown
+    std::uint32_t payload = 0;          // offset of the message behind the prefix
+};
+
+class EXT_EXPORT_VC sink {
+public:
+    virtual ~sink() = default;
+    virtual void write(record const& rec) = 0;
+    // writes several records at once - the default writes them one by one
+    virtual void write(record const* records, std::size_t count);
+    virtual void flush() {}
+};
+
+// discards everything
+class EXT_EXPORT_VC null_sink : public sink {
+public:
+    void write(record const&) override {}
+    void write(record const*, std::size_t) override {}
+};
+
+// writes to a std::ostream and flushes after each record (like `configuration::stream`)
+class EXT_EXPORT_VC ostream_sink : public sink {
+public:
+    explicit ostream_sink(std::ostream& out) : _out(out) {}
+    void write(record const& rec) override;
+    void write(record const* records, std::size_t count) override;
+    void flush() override;
+
+private:
+    std::ostream& _out;
+};
+
+#ifndef _WIN32
+// Writes to a file descriptor with write(2) and writev(2) - no iostreams and
+// no buffering. Files are opened with O_APPEND so several processes may share
+// one file without overwriting each other.
+class EXT_EXPORT_VC fd_sink : public sink {
+public:
+    explicit fd_sink(int fd, bool close_on_destruction = false) noexcept;
+    explicit fd_sink(std::string const& path);
+    ~fd_sink();
+    fd_sink(fd_sink const&) = delete;
+    fd_sink& operator=(fd_sink const&) = delete;
+
+    void write(record const& rec) override;
+    void write(record const* records, std::size_t count) override;
+
+    int fd() const noexcept {
+        return _fd;
+    }
+
+private:
+    int _fd;
+    bool _close;
+};
+
+// Collects records in a buffer and writes it when it is full, when a record
+// of `flush_level` or more severe arrives or when it is flushed explicitly.
+// With `index_every` > 0 an entry is appended to the sidecar index
+// `<path>.idx` after every `index_every` records (see sidecar.hpp).
+class EXT_EXPORT_VC file_sink : public sink {
+public:
+    explicit file_sink(std::string const& path,
+                       std::size_t buffer_size = 64 * 1024,
+                       level flush_level = level::error,
+                       std::size_t index_every = 0);
+    ~file_sink();
+
+    using sink::write;
+    void write(record const& rec) override;
+    void flush() override;
+
+private:
+    fd_sink _file;
+    std::vector<char> _buffer;
+    std::size_t _used;
+    level _flush_level;
+    std::unique_ptr<sidecar::writer> _index;
+};
+#endif // _WIN32
+
+// Hands every record to all children whose level accepts it. The record is
+// formatted once and the same text is shared by all children.
+class EXT_EXPORT_VC fanout_sink : public sink {
+public:
+    // `max_level` is the least severe level that is passed to the child
+    void add(std::shared_ptr<sink> target, level max_level = level::trace);
+
+    void write(record const& rec) override;
+    void write(record const* records, std::size_t count) override;
+    void flush() override;
+
+private:
+    struct child {
+        std::shared_ptr<sink> target;
+        level max_level;
+    };
+    std::vector<child> _children;
+};
+
+// Coalesces bursts of the same message. A record of the same call site (and
+// with `site_and_payload` the same message) as the record before is not
+// written as long as it arrives within `window` of the first one. Instead a
+// single "last message repeated N times" line follows the burst. The summary
+// is written before the next different record or by a timer thread when the
+// window passed - whatever comes first. The timer takes `logmutex` before it
+// writes, so the target is still called by one thread at a time (the sink
+// must not be destroyed while `logmutex` is held). Only the key of the last
+// record is kept. `fatal` records and records without call site are always
+// written immediately.
+class EXT_EXPORT_VC coalescing_sink : public sink {
+public:
+    enum class match {
+        site,            // same call site
+        site_and_payload // same call site and same message
+    };
+
+    explicit coalescing_sink(std::shared_ptr<sink> target,
+                             std::chrono::milliseconds window = std::chrono::seconds(1),
+                             match match_ = match::site_and_payload);
+    ~coalescing_sink();
+    coalescing_sink(coalescing_sink const&) = delete;
+    coalescing_sink& operator=(coalescing_sink const&) = delete;
+
+    void write(record const& rec) override;
+    void write(record const* records, std::size_t count) override;
+    void flush() override;
+
+private:
+    // returns true if the record continues the current burst
+    bool repeated(record const& rec, std::chrono::steady_clock::time_point now) const;
+    void start(record const& rec, std::chrono::steady_clock::time_point now);
+    void write_summary();
+    void timer();
+
+    std::shared_ptr<sink> _target;
+    std::chrono::steady_clock::duration _window;
+    match _match;
+
+    _detail::call_site* _site = nullptr; // site of the current burst
+    std::uint64_t _hash = 0;
+    level _level = level::info;
+    std::chrono::steady_clock::time_point _first;
+    std::uint64_t _repeated = 0;
+    std::string _summary;
+
+    // the timer writes to the target as well - it takes `logmutex` before
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    bool _stop = false;
+    std::thread _timer;
+};
+
+}}     // namespace ext::logging
+#endif // EXT_LOGGING_SINKS_HEADER
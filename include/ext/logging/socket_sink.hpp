@@ -0,0 +1,103 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Unix domain socket sink:
+//
+// Sends records to a local collector listening on a unix domain socket. A
+// stream socket receives the lines as they are, a datagram socket receives
+// one datagram per record. Records are collected in a buffer and sent when
+// `batch_size` bytes are pending, when a record of `flush_level` or more
+// severe arrives or on `flush` - one send(2) per batch on stream sockets and
+// one sendmmsg(2) per batch of datagrams (linux). The socket never blocks the
+// logging thread, only `flush` and the destructor wait up to `flush_timeout`
+// for a slow collector.
+//
+// While the collector is away records stay in the buffer and the sink
+// reconnects at most every `retry_interval`. A record that was sent in part
+// is sent again completely. When more than `buffer_size` bytes are pending
+// new records are dropped and counted.
+//
+// Usage
+//  ext::logging::socket_sink collector({"/run/collector.sock"});
+//  ext::logging::configuration::sink = &collector;
+
+#ifndef EXT_LOGGING_SOCKET_SINK_HEADER
+#define EXT_LOGGING_SOCKET_SINK_HEADER
+#ifndef _WIN32
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ext/logging/sinks.hpp>
+#include <string>
+#include <vector>
+
+namespace ext { namespace logging {
+
+class EXT_EXPORT_VC socket_sink : public sink {
+public:
+    enum class socket_type { stream, datagram };
+
+    struct options {
+        std::string path; // of the collector's socket
+        socket_type type = socket_type::stream;
+        std::size_t batch_size = 64 * 1024;        // bytes collected before they are sent
+        std::size_t buffer_size = 4 * 1024 * 1024; // bytes kept while the collector is away
+        level flush_level = level::error;
+        std::chrono::milliseconds retry_interval{1000};
+        std::chrono::milliseconds flush_timeout{1000};
+    };
+
+    struct statistics {
+        std::uint64_t records = 0; // sent completely
+        std::uint64_t sends = 0;   // system calls that sent data
+        std::uint64_t dropped = 0; // did not fit into the buffer
+        std::uint64_t connects = 0;
+    };
+
+    // the collector need not be running yet
+    explicit socket_sink(options opts);
+    ~socket_sink();
+    socket_sink(socket_sink const&) = delete;
+    socket_sink& operator=(socket_sink const&) = delete;
+
+    void write(record const& rec) override;
+    void write(record const* records, std::size_t count) override;
+    void flush() override;
+
+    bool connected() const noexcept {
+        return _fd >= 0;
+    }
+    std::size_t pending() const noexcept {
+        return _buffer.size() - _sent;
+    }
+    // may be called from any thread
+    statistics stats() const noexcept;
+
+private:
+    bool connect();
+    void disconnect() noexcept;
+    void append(record const& rec);
+    // sends as much as the socket takes - true if nothing is pending
+    bool send();
+    bool send_stream();
+    bool send_datagrams();
+    void compact() noexcept;
+
+    options _opts;
+    int _fd = -1;
+    std::chrono::steady_clock::time_point _next_connect;
+    std::vector<char> _buffer;
+    std::vector<std::size_t> _ends; // end of every record in `_buffer`
+    std::size_t _sent = 0;          // bytes of `_buffer` sent
+
+    std::atomic<std::uint64_t> _records{0};
+    std::atomic<std::uint64_t> _sends{0};
+    std::atomic<std::uint64_t> _dropped{0};
+    std::atomic<std::uint64_t> _connects{0};
+};
+
+}}     // namespace ext::logging
+#endif // _WIN32
+#endif // EXT_LOGGING_SOCKET_SINK_HEADER
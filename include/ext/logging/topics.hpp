@@ -0,0 +1,95 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Topic registry:
+//
+// Every topic with an id in [0, max_topics) is kept in a table indexed by its
+// id. Besides the built in topics and topics defined as globals (see
+// `topic::network`) topics can be registered by name at runtime. They take
+// the lowest free id and live until the program ends. Registered topics have
+// no compile-time ceiling and are used with `EXT_LOG_TOPIC`.
+//
+// Levels can be configured with a list of `name=level` entries separated by
+// `,`, `;` or new lines. `*` names every topic, `#` starts a comment. A level
+// is a name (fatal, error, warn, warning, info, debug, trace) or a number.
+// Entries for topics that do not exist yet are applied when they are
+// registered - so the configuration may be read before the topics exist.
+// `EXT_LOG_LEVELS` is read when the library is initialized.
+//
+// Usage
+//  // EXT_LOG_LEVELS="network=debug,engine=error" ./myapp
+//  ext::logging::configure_levels_from_file("/etc/myapp/levels.conf");
+//  auto& db = ext::logging::register_topic("database", ext::logging::level::warn);
+//  EXT_LOG_TOPIC("cafe", db, info) << "connected";
+
+#ifndef EXT_LOGGING_TOPICS_HEADER
+#define EXT_LOGGING_TOPICS_HEADER
+
+#include <algorithm>
+#include <ext/logging/definitions.hpp>
+#include <ext/macros/compiler.hpp>
+#include <string>
+#include <string_view>
+
+namespace ext { namespace logging {
+
+// the topic named `name` - created with `level_` if there is none yet, a
+// configured level takes precedence
+EXT_EXPORT_VC _detail::logtopic& register_topic(std::string_view name,
+                                                level level_ = _detail::logtopic::default_level);
+// nullptr if there is no such topic
+EXT_EXPORT_VC _detail::logtopic* find_topic(std::string_view name) noexcept;
+EXT_EXPORT_VC _detail::logtopic* find_topic(int id) noexcept;
+
+// accepts the names of `level_to_str`, `warn` and numbers
+EXT_EXPORT_VC bool level_from_str(std::string_view text, level& out) noexcept;
+
+// apply `name=level` entries - return false if an entry could not be parsed
+// (the others are applied) or the file could not be read
+EXT_EXPORT_VC bool configure_levels(std::string_view entries);
+EXT_EXPORT_VC bool configure_levels_from_env(char const* variable = "EXT_LOG_LEVELS");
+EXT_EXPORT_VC bool configure_levels_from_file(std::string const& path);
+// forgets the entries kept for topics registered later - set levels stay
+EXT_EXPORT_VC void clear_configured_levels() noexcept;
+
+namespace _detail {
+inline std::string_view trim(std::string_view text) noexcept {
+    auto const first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+// calls `apply(name, value)` for every `name=value` entry and returns false
+// if an entry has no name or `=` or `apply` returned false
+template<typename Apply>
+bool for_each_entry(std::string_view entries, Apply&& apply) {
+    bool parsed = true;
+    while (!entries.empty()) {
+        auto const end = std::min(entries.find_first_of(",;\n"), entries.size());
+        auto entry = entries.substr(0, end);
+        entries.remove_prefix(std::min(end + 1, entries.size()));
+
+        if (auto const comment = entry.find('#'); comment != std::string_view::npos) {
+            entry = entry.substr(0, comment);
+        }
+        entry = trim(entry);
+        if (entry.empty()) {
+            continue;
+        }
+
+        auto const equal = entry.find('=');
+        auto const name = trim(entry.substr(0, std::min(equal, entry.size())));
+        if (equal == std::string_view::npos || name.empty() || !apply(name, trim(entry.substr(equal + 1)))) {
+            parsed = false;
+        }
+    }
+    return parsed;
+}
+
+// like a `name=level` entry
+EXT_EXPORT_VC void configure_level(std::string_view name, level level_);
+} // namespace _detail
+}}     // namespace ext::logging
+#endif // EXT_LOGGING_TOPICS_HEADER
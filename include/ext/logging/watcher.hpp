@@ -0,0 +1,68 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Live configuration:
+//
+// `apply_configuration` changes topic levels, log ids and output flags while
+// other threads log. The entries use the syntax of `configure_levels`
+// (topics.hpp) with two prefixes:
+//
+//  network=debug        level of a topic, `*` for every topic
+//  id.cafe=off          switches a log id on or off (`set_enabled`)
+//  option.filename=no   output flag: prefix_newline, append_newline, threads,
+//                       filename, function or utc
+//
+// Readers never lock. A statement reads a single atomic level and the flags
+// of a prefix are read as one snapshot, so no message sees a partly applied
+// update of the flags. Levels and ids are not part of that snapshot: each
+// entry takes effect on its own, so while an update is applied a thread may
+// see the new level of one topic and the old level of another. Entries that
+// are not in the file keep their value, entries that can not be parsed are
+// skipped and the others are applied.
+//
+// `watcher::start` applies a file and a background thread applies it again
+// whenever it changes (inotify on linux, polling otherwise) or the process
+// receives SIGHUP. The watcher is not available on windows.
+//
+// Usage
+//  ext::logging::watcher::start("/etc/myapp/logging.conf");
+//  // echo 'network=debug' > /etc/myapp/logging.conf
+//  ext::logging::watcher::stop();
+
+#ifndef EXT_LOGGING_WATCHER_HEADER
+#define EXT_LOGGING_WATCHER_HEADER
+
+#include <chrono>
+#include <cstdint>
+#include <ext/logging/definitions.hpp>
+#include <ext/macros/compiler.hpp>
+#include <string>
+#include <string_view>
+
+namespace ext { namespace logging {
+
+// returns false if an entry could not be parsed - the others are applied
+EXT_EXPORT_VC bool apply_configuration(std::string_view entries);
+
+#ifndef _WIN32
+namespace watcher {
+
+struct options {
+    bool sighup = true; // reload on SIGHUP - replaces the handler until `stop`
+    std::chrono::milliseconds poll_interval{1000}; // without inotify
+};
+
+// applies `path` and watches it - returns false if the file could not be read
+// or parsed. Throws std::system_error if the watcher can not be set up.
+EXT_EXPORT_VC bool start(std::string const& path, options const& opts = options{});
+EXT_EXPORT_VC void stop();
+EXT_EXPORT_VC bool active() noexcept;
+// makes the watcher apply the file again
+EXT_EXPORT_VC void reload() noexcept;
+// number of times the file was applied since `start`
+EXT_EXPORT_VC std::uint64_t reloads() noexcept;
+
+} // namespace watcher
+#endif // _WIN32
+}}     // namespace ext::logging
+#endif // EXT_LOGGING_WATCHER_HEADER
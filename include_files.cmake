@@ -1,5 +1,21 @@
 set(ext-logging-header
     "include/ext/logging.hpp"
+    "include/ext/logging/async.hpp"
+    "include/ext/logging/binary.hpp"
+    "include/ext/logging/compressed_sink.hpp"
+    "include/ext/logging/context.hpp"
     "include/ext/logging/definitions.hpp"
+    "include/ext/logging/emergency.hpp"
+    "include/ext/logging/format.hpp"
     "include/ext/logging/functionality.hpp"
+    "include/ext/logging/ids.hpp"
+    "include/ext/logging/limiters.hpp"
+    "include/ext/logging/metrics.hpp"
+    "include/ext/logging/recorder.hpp"
+    "include/ext/logging/rotating_sink.hpp"
+    "include/ext/logging/sidecar.hpp"
+    "include/ext/logging/sinks.hpp"
+    "include/ext/logging/socket_sink.hpp"
+    "include/ext/logging/topics.hpp"
+    "include/ext/logging/watcher.hpp"
 )
@@ -0,0 +1,397 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <ext/logging/async.hpp>
+#include <ext/logging/emergency.hpp>
+#include <ext/logging/functionality.hpp>
+#include <ext/logging/metrics.hpp>
+#include <ext/logging/sinks.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <thread>
+
+namespace ext { namespace logging {
+namespace {
+
+// Bounded multi-producer multi-consumer queue (D. Vyukov). Every slot carries
+// a sequence number that tells producers and consumers whether the slot is
+// free, filled or still in use. The message strings stay in their slots so
+// that their capacity is reused once the queue warmed up. Producers are
+// allowed to consume as well - this is how `drop_oldest` makes room.
+class message_queue {
+public:
+    static constexpr std::size_t max_batch = 1024;
+
+    struct alignas(64) slot {
+        std::atomic<std::size_t> sequence;
+        level level_;
+        int topic_id;
+        _detail::call_site* site;
+        std::uint32_t payload;
+        std::string message;
+    };
+
+    explicit message_queue(std::size_t size) {
+        std::size_t capacity = 2;
+        while (capacity < size) {
+            capacity <<= 1;
+        }
+        _mask = capacity - 1;
+        _slots = std::make_unique<slot[]>(capacity);
+        for (std::size_t i = 0; i < capacity; ++i) {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool try_push(record const& rec, int topic_id) {
+        std::size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+        slot* current;
+        for (;;) {
+            current = &_slots[pos & _mask];
+            std::size_t seq = current->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        current->level_ = rec.level_;
+        current->topic_id = topic_id;
+        current->site = rec.site;
+        current->payload = rec.payload;
+        current->message.assign(rec.text.data(), rec.text.size());
+        current->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // calls `func(slot&)` for the oldest message - returns false if empty
+    template<typename Func>
+    bool try_pop(Func&& func) {
+        std::size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+        slot* current;
+        for (;;) {
+            current = &_slots[pos & _mask];
+            std::size_t seq = current->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // empty
+            } else {
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        func(*current);
+        current->sequence.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // reserves up to `max` consecutive filled slots, calls `func(slot**, count)`
+    // and releases them afterwards - returns the number of slots
+    template<typename Func>
+    std::size_t try_pop_batch(std::size_t max, Func&& func) {
+        slot* reserved[max_batch];
+        max = std::min(max, max_batch);
+
+        std::size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+        std::size_t count;
+        for (;;) {
+            count = 0;
+            while (count < max) {
+                slot& current = _slots[(pos + count) & _mask];
+                if (current.sequence.load(std::memory_order_acquire) != pos + count + 1) {
+                    break;
+                }
+                reserved[count++] = &current;
+            }
+            if (count == 0) {
+                return 0;
+            }
+            if (_dequeue_pos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        func(reserved, count);
+        for (std::size_t i = 0; i < count; ++i) {
+            reserved[i]->sequence.store(pos + i + _mask + 1, std::memory_order_release);
+        }
+        return count;
+    }
+
+    bool empty() const noexcept {
+        return _dequeue_pos.load(std::memory_order_acquire) == _enqueue_pos.load(std::memory_order_acquire);
+    }
+
+private:
+    std::unique_ptr<slot[]> _slots;
+    std::size_t _mask;
+    alignas(64) std::atomic<std::size_t> _enqueue_pos{0};
+    alignas(64) std::atomic<std::size_t> _dequeue_pos{0};
+};
+
+struct async_state {
+    // serializes start / stop / flush - never taken by producers
+    std::mutex control_mutex;
+
+    std::unique_ptr<message_queue> queue;
+    async::options opts;
+    std::thread writer;
+
+    std::atomic<bool> running{false};
+    std::atomic<std::size_t> in_flight{0}; // producers between `running` check and push
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::atomic<bool> writer_sleeping{false};
+
+    std::mutex done_mutex;
+    std::condition_variable done;
+
+    std::atomic<std::uint64_t> enqueued{0};
+    std::atomic<std::uint64_t> written{0};
+    std::atomic<std::uint64_t> blocked{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::uint64_t> dropped_oldest{0};
+
+    void wake_writer() {
+        if (writer_sleeping.load(std::memory_order_acquire)) {
+            wake.notify_one();
+        }
+    }
+
+    // writes up to one batch - returns the number of written messages
+    std::size_t write_batch() {
+        std::size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(_detail::logmutex);
+            count = queue->try_pop_batch(opts.batch_size, [](message_queue::slot** slots, std::size_t size) {
+                record records[message_queue::max_batch];
+                for (std::size_t i = 0; i < size; ++i) {
+                    records[i] = record{slots[i]->level_, slots[i]->message, slots[i]->site, slots[i]->payload};
+                }
+
+                try {
+                    if (auto* target = configuration::sink) {
+                        target->write(records, size);
+                        target->flush();
+                    } else {
+                        ostream_sink(*configuration::stream).write(records, size);
+                    }
+                } catch (...) {
+                    // like the synchronous logger - failing output is ignored
+                }
+            });
+        }
+        if (count) {
+            written.fetch_add(count, std::memory_order_release);
+            std::lock_guard<std::mutex> lock(done_mutex);
+            done.notify_all();
+        }
+        return count;
+    }
+
+    void run() {
+        while (running.load(std::memory_order_acquire)) {
+            if (write_batch()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            writer_sleeping.store(true, std::memory_order_release);
+            // the timeout covers a producer that checked `writer_sleeping`
+            // just before it was set
+            wake.wait_for(lock, std::chrono::milliseconds(10), [this] {
+                return !queue->empty() || !running.load(std::memory_order_acquire);
+            });
+            writer_sleeping.store(false, std::memory_order_release);
+        }
+    }
+
+    std::uint64_t consumed() const noexcept {
+        return written.load(std::memory_order_acquire) + dropped_oldest.load(std::memory_order_acquire);
+    }
+};
+
+// never destroyed - loggers may still run during static destruction
+async_state& state() {
+    static async_state* instance = new async_state;
+    return *instance;
+}
+
+void stop_at_exit() {
+    try {
+        async::stop();
+    } catch (...) {
+    }
+}
+
+} // namespace
+
+bool _detail::async_enqueue(record const& rec, int topic_id) {
+    auto const level_ = rec.level_;
+    auto& s = state();
+    // store-load handshake with `stop` - all four operations are seq_cst, so
+    // either it sees the producer in flight or the producer sees it stopped
+    s.in_flight.fetch_add(1, std::memory_order_seq_cst);
+    if (!s.running.load(std::memory_order_seq_cst)) {
+        s.in_flight.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    bool pushed = s.queue->try_push(rec, topic_id);
+    if (!pushed) {
+        switch (s.opts.policy) {
+            case async::full_policy::block: {
+                s.blocked.fetch_add(1, std::memory_order_relaxed);
+#ifdef EXT_LOGGING_METRICS
+                auto const start = std::chrono::steady_clock::now();
+#endif // EXT_LOGGING_METRICS
+                do {
+                    s.wake_writer();
+                    std::this_thread::yield();
+                } while (!s.queue->try_push(rec, topic_id));
+#ifdef EXT_LOGGING_METRICS
+                count(topic_id,
+                      level_,
+                      metrics::counter::wait_ns,
+                      static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                     std::chrono::steady_clock::now() - start)
+                                                     .count()));
+#endif // EXT_LOGGING_METRICS
+                pushed = true;
+                break;
+            }
+            case async::full_policy::drop:
+                s.dropped.fetch_add(1, std::memory_order_relaxed);
+                count(topic_id, level_, metrics::counter::dropped);
+                break;
+            case async::full_policy::drop_oldest:
+                do {
+                    if (s.queue->try_pop([](message_queue::slot& oldest) {
+                            count(oldest.topic_id, oldest.level_, metrics::counter::dropped);
+                        })) {
+                        s.dropped_oldest.fetch_add(1, std::memory_order_release);
+                    }
+                } while (!s.queue->try_push(rec, topic_id));
+                pushed = true;
+                break;
+        }
+    }
+
+    if (pushed) {
+        s.enqueued.fetch_add(1, std::memory_order_release);
+        s.wake_writer();
+    }
+    s.in_flight.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void async::start(options const& opts) {
+    auto& s = state();
+    stop();
+    std::lock_guard<std::mutex> lock(s.control_mutex);
+    s.opts = opts;
+    if (s.opts.batch_size == 0) {
+        s.opts.batch_size = 1;
+    }
+    s.queue = std::make_unique<message_queue>(opts.queue_size);
+    s.enqueued.store(0, std::memory_order_relaxed);
+    s.written.store(0, std::memory_order_relaxed);
+    s.blocked.store(0, std::memory_order_relaxed);
+    s.dropped.store(0, std::memory_order_relaxed);
+    s.dropped_oldest.store(0, std::memory_order_relaxed);
+
+    // shutdown drain
+    static bool const registered = (std::atexit(stop_at_exit) == 0);
+    (void) registered;
+
+    s.running.store(true, std::memory_order_release);
+    s.writer = std::thread([&s] { s.run(); });
+}
+
+void async::stop() {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.control_mutex);
+    if (!s.running.exchange(false, std::memory_order_seq_cst)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> wake_lock(s.wake_mutex);
+        s.wake.notify_one();
+    }
+    s.writer.join();
+
+    // producers that saw `running == true` may still wait for room
+    while (s.in_flight.load(std::memory_order_seq_cst) != 0) {
+        s.write_batch();
+        std::this_thread::yield();
+    }
+
+    while (s.write_batch()) {
+    }
+}
+
+void async::flush() {
+    auto& s = state();
+    if (!s.running.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    auto const target = s.enqueued.load(std::memory_order_acquire);
+    {
+        std::lock_guard<std::mutex> wake_lock(s.wake_mutex);
+        s.wake.notify_one();
+    }
+
+    std::unique_lock<std::mutex> lock(s.done_mutex);
+    while (s.consumed() < target && s.running.load(std::memory_order_acquire)) {
+        s.done.wait_for(lock, std::chrono::milliseconds(1));
+    }
+}
+
+#ifndef _WIN32
+void _detail::async_forget_writer() noexcept {
+    auto& s = state();
+    if (!s.running.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    // the thread and the waiters of the primitives are gone - the old
+    // objects are left as they are, the queued messages belong to the parent
+    new (&s.writer) std::thread();
+    new (&s.control_mutex) std::mutex();
+    new (&s.wake_mutex) std::mutex();
+    new (&s.wake) std::condition_variable();
+    new (&s.done_mutex) std::mutex();
+    new (&s.done) std::condition_variable();
+    s.in_flight.store(0, std::memory_order_relaxed);
+    s.writer_sleeping.store(false, std::memory_order_relaxed);
+}
+#endif // _WIN32
+
+bool async::active() noexcept {
+    return state().running.load(std::memory_order_acquire);
+}
+
+async::statistics async::stats() noexcept {
+    auto const& s = state();
+    return {s.enqueued.load(std::memory_order_relaxed),
+            s.written.load(std::memory_order_relaxed),
+            s.blocked.load(std::memory_order_relaxed),
+            s.dropped.load(std::memory_order_relaxed),
+            s.dropped_oldest.load(std::memory_order_relaxed)};
+}
+
+}} // namespace ext::logging
@@ -0,0 +1,380 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <ext/logging/binary.hpp>
+#include <ext/logging/emergency.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace ext { namespace logging { namespace binary {
+namespace {
+// entry, index, timestamp and payload size
+constexpr std::size_t message_header_size = 1 + 4 + 8 + 4;
+
+std::atomic<sink*> binary_sink{nullptr};
+std::atomic<std::size_t> batch_bytes{default_batch_size};
+
+// protected by logmutex
+std::vector<site*>& sites() {
+    static std::vector<site*>* registry = new std::vector<site*>();
+    return *registry;
+}
+
+// encoded messages of one thread - the mutex is taken by the owner and by `flush`
+struct batch {
+    std::mutex mutex;
+    std::string data;
+    level most_severe = level::trace;
+};
+
+struct batch_registry {
+    std::mutex mutex;
+    std::vector<batch*> batches; // of running threads
+};
+
+batch_registry& batches() {
+    // leaked - threads may exit during static destruction
+    static batch_registry* instance = new batch_registry();
+    return *instance;
+}
+
+// one record for the whole batch - called with `b.mutex` held
+void hand_over(batch& b) {
+    if (b.data.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(ext::logging::_detail::logmutex);
+    if (auto* target = binary_sink.load(std::memory_order_relaxed)) {
+        target->write(record{b.most_severe, b.data});
+    }
+    b.data.clear();
+    b.most_severe = level::trace;
+}
+
+// hands the batch over when the thread exits
+struct thread_batch {
+    thread_batch() {
+        auto& reg = batches();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.batches.push_back(&mine);
+    }
+
+    ~thread_batch() {
+        {
+            auto& reg = batches();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.batches.erase(std::find(reg.batches.begin(), reg.batches.end(), &mine));
+        }
+        std::lock_guard<std::mutex> lock(mine.mutex);
+        try {
+            hand_over(mine);
+        } catch (...) {
+        }
+    }
+
+    batch mine;
+};
+
+template<typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+void put_string(std::string& out, std::string_view str) {
+    put(out, static_cast<std::uint32_t>(str.size()));
+    out.append(str.data(), str.size());
+}
+
+void write_site(sink& target, site const& site_) {
+    auto const& call = site_.call;
+    std::string out;
+    out.push_back(static_cast<char>(entry::site));
+    put(out, site_.index.load(std::memory_order_relaxed));
+    put(out, static_cast<std::uint8_t>(call.level_));
+    put(out, static_cast<std::uint32_t>(call.line));
+    put_string(out, call.id);
+    put_string(out, call.topic->id == topic::no_topic.id ? std::string_view() : std::string_view(call.topic->name));
+    put_string(out, call.file);
+    put_string(out, call.function);
+    target.write(record{call.level_, out});
+}
+
+EXT_LOGGING_COLD std::uint32_t register_site(site& site_) {
+    std::lock_guard<std::mutex> lock(ext::logging::_detail::logmutex);
+    auto index = site_.index.load(std::memory_order_relaxed);
+    if (index == 0) {
+        sites().push_back(&site_);
+        index = static_cast<std::uint32_t>(sites().size());
+        site_.index.store(index, std::memory_order_release);
+        if (auto* target = binary_sink.load(std::memory_order_relaxed)) {
+            write_site(*target, site_);
+        }
+    }
+    return index;
+}
+} // namespace
+
+void set_sink(sink* target, std::size_t batch_size) {
+    flush(); // the pending messages belong to the previous sink
+    std::lock_guard<std::mutex> lock(ext::logging::_detail::logmutex);
+    batch_bytes.store(batch_size, std::memory_order_relaxed);
+    auto* const previous = binary_sink.exchange(target, std::memory_order_acq_rel);
+    if (target && target != previous) {
+        target->write(record{level::info, std::string_view(magic, sizeof(magic) - 1)});
+        for (auto const* site_ : sites()) {
+            write_site(*target, *site_);
+        }
+    }
+}
+
+sink* get_sink() noexcept {
+    return binary_sink.load(std::memory_order_acquire);
+}
+
+void flush() {
+    {
+        auto& reg = batches();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (auto* b : reg.batches) {
+            std::lock_guard<std::mutex> batch_lock(b->mutex);
+            hand_over(*b);
+        }
+    }
+    std::lock_guard<std::mutex> lock(ext::logging::_detail::logmutex);
+    if (auto* target = binary_sink.load(std::memory_order_relaxed)) {
+        target->flush();
+    }
+}
+
+ext::logging::_detail::message_buffer& _detail::acquire_buffer() {
+    thread_local ext::logging::_detail::message_buffer buffer;
+    buffer.clear();
+    // placeholder for the header that is filled in by `write`
+    char header[message_header_size] = {};
+    buffer.append(std::string_view(header, message_header_size));
+    return buffer;
+}
+
+void _detail::write(site& site_, ext::logging::_detail::message_buffer& buffer) {
+    auto const now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+    auto const payload_size = static_cast<std::uint32_t>(buffer.size() - message_header_size);
+    auto index = site_.index.load(std::memory_order_acquire);
+    if (index == 0) {
+        index = register_site(site_);
+    }
+
+    char* header = buffer.data();
+    header[0] = static_cast<char>(entry::message);
+    std::memcpy(header + 1, &index, sizeof(index));
+    auto const timestamp = static_cast<std::uint64_t>(now);
+    std::memcpy(header + 5, &timestamp, sizeof(timestamp));
+    std::memcpy(header + 13, &payload_size, sizeof(payload_size));
+
+    auto const level_ = site_.call.level_;
+    {
+        thread_local thread_batch local;
+        auto& mine = local.mine;
+        std::lock_guard<std::mutex> lock(mine.mutex);
+        mine.data.append(buffer.data(), buffer.size());
+        mine.most_severe = std::min(mine.most_severe, level_);
+        if (level_ <= level::error || mine.data.size() >= batch_bytes.load(std::memory_order_relaxed)) {
+            hand_over(mine);
+        }
+    }
+
+    if (level_ == level::fatal) {
+        flush();
+        std::terminate();
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// decoder
+namespace {
+struct site_info {
+    level level_;
+    std::uint32_t line;
+    std::string id;
+    std::string topic;
+    std::string file;
+    std::string function;
+};
+
+template<typename T>
+bool get(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+bool get_string(std::istream& in, std::string& str) {
+    std::uint32_t size;
+    if (!get(in, size)) {
+        return false;
+    }
+    str.resize(size);
+    return size == 0 || static_cast<bool>(in.read(str.data(), size));
+}
+
+void write_timestamp(std::ostream& out, std::uint64_t nanoseconds) {
+    std::time_t seconds = static_cast<std::time_t>(nanoseconds / 1000000000);
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+    out << std::put_time(&utc, "%Y-%m-%d %H:%M:%S") << "." << std::setw(9) << std::setfill('0')
+        << (nanoseconds % 1000000000) << std::setfill(' ') << " ";
+}
+
+// prints the payload like the `operator<<` chain would have
+bool write_payload(std::string_view payload, std::ostream& out) {
+    auto take = [&payload](void* value, std::size_t size) {
+        if (payload.size() < size) {
+            return false;
+        }
+        std::memcpy(value, payload.data(), size);
+        payload.remove_prefix(size);
+        return true;
+    };
+
+    while (!payload.empty()) {
+        auto tag = static_cast<type>(payload.front());
+        payload.remove_prefix(1);
+        switch (tag) {
+            case type::i64: {
+                std::int64_t value;
+                if (!take(&value, sizeof(value))) {
+                    return false;
+                }
+                out << value;
+                break;
+            }
+            case type::u64: {
+                std::uint64_t value;
+                if (!take(&value, sizeof(value))) {
+                    return false;
+                }
+                out << value;
+                break;
+            }
+            case type::f64: {
+                double value;
+                if (!take(&value, sizeof(value))) {
+                    return false;
+                }
+                out << value;
+                break;
+            }
+            case type::boolean: {
+                char value;
+                if (!take(&value, sizeof(value))) {
+                    return false;
+                }
+                out << static_cast<bool>(value);
+                break;
+            }
+            case type::character: {
+                char value;
+                if (!take(&value, sizeof(value))) {
+                    return false;
+                }
+                out << value;
+                break;
+            }
+            case type::string: {
+                std::uint32_t size;
+                if (!take(&size, sizeof(size)) || payload.size() < size) {
+                    return false;
+                }
+                out << payload.substr(0, size);
+                payload.remove_prefix(size);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+bool decode(std::istream& in, std::ostream& out, decode_options const& opts) {
+    char header[sizeof(magic) - 1];
+    if (!in.read(header, sizeof(header)) || std::string_view(header, sizeof(header)) != magic) {
+        return false;
+    }
+
+    std::unordered_map<std::uint32_t, site_info> known;
+    std::string payload;
+    char kind;
+    while (in.get(kind)) {
+        if (kind == magic[0]) {
+            // another sink or process appended to the stream - its sites follow
+            header[0] = kind;
+            if (!in.read(header + 1, sizeof(header) - 1) || std::string_view(header, sizeof(header)) != magic) {
+                return false;
+            }
+            known.clear();
+        } else if (static_cast<entry>(kind) == entry::site) {
+            std::uint32_t index;
+            std::uint8_t level_;
+            site_info info;
+            if (!get(in, index) || !get(in, level_) || !get(in, info.line) || !get_string(in, info.id) ||
+                !get_string(in, info.topic) || !get_string(in, info.file) || !get_string(in, info.function)) {
+                return false;
+            }
+            info.level_ = static_cast<level>(level_);
+            known[index] = std::move(info);
+        } else if (static_cast<entry>(kind) == entry::message) {
+            std::uint32_t index;
+            std::uint64_t timestamp;
+            if (!get(in, index) || !get(in, timestamp) || !get_string(in, payload)) {
+                return false;
+            }
+            auto found = known.find(index);
+            if (found == known.end()) {
+                return false;
+            }
+            auto const& info = found->second;
+
+            if (opts.timestamp) {
+                write_timestamp(out, timestamp);
+            }
+            out << "[" << info.id << "] " << ext::logging::_detail::level_to_str(info.level_);
+            if (!info.topic.empty()) {
+                out << " (" << info.topic << ")";
+            }
+            if (opts.filename) {
+                out << " " << ext::logging::_detail::filename(info.file) << ":" << info.line;
+            }
+            if (opts.function) {
+                out << " in " << info.function << "()";
+            }
+            out << ": '";
+            if (!write_payload(payload, out)) {
+                return false;
+            }
+            out << "'\n";
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+}}} // namespace ext::logging::binary
+
+#ifndef _WIN32
+void ext::logging::_detail::binary_forget_sink() noexcept {
+    binary::binary_sink.store(nullptr, std::memory_order_relaxed);
+}
+#endif // _WIN32
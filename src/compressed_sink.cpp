@@ -0,0 +1,526 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <ext/logging/compressed_sink.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <system_error>
+#include <utility>
+
+#ifdef EXT_LOGGING_ZLIB
+#include <zlib.h>
+#endif // EXT_LOGGING_ZLIB
+
+namespace ext { namespace logging {
+namespace compressed {
+namespace {
+// LZ77 in the style of LZ4 blocks: every sequence is a token (literal length
+// and match length - 4 in 4 bits each, 15 continues with bytes of 255), the
+// literals, a 16 bit offset and the rest of the match length. The last
+// sequence consists of literals only.
+constexpr std::size_t min_match = 4;
+constexpr std::size_t max_offset = 65535;
+constexpr int hash_bits = 14;
+
+std::uint32_t hash4(char const* data) noexcept {
+    std::uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return (value * 2654435761u) >> (32 - hash_bits);
+}
+
+void put_length(std::string& out, std::size_t length) {
+    for (; length >= 255; length -= 255) {
+        out += static_cast<char>(255);
+    }
+    out += static_cast<char>(length);
+}
+
+void put_literals(std::string& out, char const* literals, std::size_t count, unsigned match_bits) {
+    out += static_cast<char>((std::min<std::size_t>(count, 15) << 4) | match_bits);
+    if (count >= 15) {
+        put_length(out, count - 15);
+    }
+    out.append(literals, count);
+}
+
+template<typename T>
+void put(char*& out, T value) noexcept {
+    std::memcpy(out, &value, sizeof(T));
+    out += sizeof(T);
+}
+
+template<typename T>
+T get(char const*& in) noexcept {
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+    return value;
+}
+
+std::uint64_t now_ns() noexcept {
+    auto const since_epoch = std::chrono::system_clock::now().time_since_epoch();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count());
+}
+
+// compresses `raw` into `out` - returns the codec that was used
+codec compress(codec method, std::string const& raw, std::string& out) {
+    switch (method) {
+        case codec::lz:
+            _detail::lz_compress(raw.data(), raw.size(), out);
+            break;
+#ifdef EXT_LOGGING_ZLIB
+        case codec::zlib: {
+            // the fastest level is about twice as fast as the default and compresses log text well
+            auto size = ::compressBound(static_cast<uLong>(raw.size()));
+            out.resize(size);
+            if (::compress2(reinterpret_cast<Bytef*>(&out[0]),
+                            &size,
+                            reinterpret_cast<Bytef const*>(raw.data()),
+                            static_cast<uLong>(raw.size()),
+                            Z_BEST_SPEED) != Z_OK) {
+                return codec::stored;
+            }
+            out.resize(size);
+            break;
+        }
+#endif // EXT_LOGGING_ZLIB
+        default:
+            return codec::stored;
+    }
+    return out.size() < raw.size() ? method : codec::stored;
+}
+
+bool parse_header(char const* in, std::uint64_t offset, block_info& block) noexcept {
+    block.offset = offset;
+    block.method = static_cast<codec>(get<std::uint8_t>(in));
+    in += 3;
+    block.raw_size = get<std::uint32_t>(in);
+    block.stored_size = get<std::uint32_t>(in);
+    block.records = get<std::uint32_t>(in);
+    block.first = get<std::uint64_t>(in);
+    block.last = get<std::uint64_t>(in);
+    return block.method <= codec::zlib;
+}
+
+// reads the index at the end of the file
+bool read_trailer(std::istream& in, std::uint64_t file_size, std::vector<block_info>& blocks) {
+    std::uint64_t const header_size = sizeof(magic) - 1;
+    std::uint64_t const trailer_size = sizeof(std::uint64_t) + sizeof(index_magic) - 1;
+    if (file_size < header_size + trailer_size) {
+        return false;
+    }
+    char trailer[trailer_size];
+    in.seekg(static_cast<std::streamoff>(file_size - trailer_size));
+    if (!in.read(trailer, trailer_size) || std::memcmp(trailer + 8, index_magic, sizeof(index_magic) - 1) != 0) {
+        return false;
+    }
+    char const* pos = trailer;
+    auto const count = get<std::uint64_t>(pos);
+    if (count > (file_size - header_size - trailer_size) / index_entry_size) {
+        return false;
+    }
+
+    auto const index_offset = file_size - trailer_size - count * index_entry_size;
+    std::string index(count * index_entry_size, '\0');
+    in.seekg(static_cast<std::streamoff>(index_offset));
+    if (!in.read(&index[0], static_cast<std::streamsize>(index.size()))) {
+        return false;
+    }
+    pos = index.data();
+    std::uint64_t end = header_size;
+    for (std::uint64_t i = 0; i < count; ++i) {
+        block_info block;
+        block.offset = get<std::uint64_t>(pos);
+        block.first = get<std::uint64_t>(pos);
+        block.last = get<std::uint64_t>(pos);
+        block.raw_size = get<std::uint32_t>(pos);
+        block.stored_size = get<std::uint32_t>(pos);
+        block.records = get<std::uint32_t>(pos);
+        block.method = static_cast<codec>(get<std::uint8_t>(pos));
+        pos += 3;
+        if (block.offset != end || block.method > codec::zlib) {
+            return false;
+        }
+        end += block_header_size + block.stored_size;
+        blocks.push_back(block);
+    }
+    return end == index_offset;
+}
+} // namespace
+
+bool available(codec method) noexcept {
+#ifdef EXT_LOGGING_ZLIB
+    return method <= codec::zlib;
+#else
+    return method <= codec::lz;
+#endif // EXT_LOGGING_ZLIB
+}
+
+codec default_codec() noexcept {
+    return available(codec::zlib) ? codec::zlib : codec::lz;
+}
+
+bool read_index(std::istream& in, std::vector<block_info>& blocks) {
+    blocks.clear();
+    char header[sizeof(magic) - 1];
+    in.clear();
+    in.seekg(0);
+    if (!in.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(header)) != 0) {
+        return false;
+    }
+    in.seekg(0, std::ios::end);
+    auto const file_size = static_cast<std::uint64_t>(in.tellg());
+    if (read_trailer(in, file_size, blocks)) {
+        return true;
+    }
+
+    // no index - the block that was written last may be incomplete
+    blocks.clear();
+    in.clear();
+    std::uint64_t offset = sizeof(header);
+    while (offset + block_header_size <= file_size) {
+        char raw[block_header_size];
+        in.seekg(static_cast<std::streamoff>(offset));
+        block_info block;
+        if (!in.read(raw, sizeof(raw)) || !parse_header(raw, offset, block)) {
+            return false;
+        }
+        offset += block_header_size + block.stored_size;
+        if (offset > file_size) {
+            break;
+        }
+        blocks.push_back(block);
+    }
+    return true;
+}
+
+bool read_block(std::istream& in, block_info const& block, std::string& out) {
+    std::string stored(block.stored_size, '\0');
+    in.clear();
+    in.seekg(static_cast<std::streamoff>(block.offset + block_header_size));
+    if (!in.read(&stored[0], static_cast<std::streamsize>(stored.size()))) {
+        return false;
+    }
+
+    auto const start = out.size();
+    out.resize(start + block.raw_size);
+    switch (block.method) {
+        case codec::stored:
+            if (block.stored_size != block.raw_size) {
+                return false;
+            }
+            std::memcpy(&out[start], stored.data(), stored.size());
+            return true;
+        case codec::lz:
+            return _detail::lz_decompress(stored.data(), stored.size(), &out[start], block.raw_size);
+#ifdef EXT_LOGGING_ZLIB
+        case codec::zlib: {
+            uLongf size = block.raw_size;
+            return ::uncompress(reinterpret_cast<Bytef*>(&out[start]),
+                                &size,
+                                reinterpret_cast<Bytef const*>(stored.data()),
+                                static_cast<uLong>(stored.size())) == Z_OK &&
+                   size == block.raw_size;
+        }
+#endif // EXT_LOGGING_ZLIB
+        default:
+            return false;
+    }
+}
+
+bool decode(std::istream& in, std::ostream& out, decode_options const& opts) {
+    std::vector<block_info> blocks;
+    if (!read_index(in, blocks)) {
+        return false;
+    }
+    std::string text;
+    for (auto const& block : blocks) {
+        if (block.last < opts.from || block.first > opts.to) {
+            continue;
+        }
+        text.clear();
+        if (!read_block(in, block, text)) {
+            return false;
+        }
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+    return static_cast<bool>(out);
+}
+
+void _detail::lz_compress(char const* data, std::size_t size, std::string& out) {
+    out.clear();
+    out.reserve(size / 2);
+    auto table = std::make_unique<std::uint32_t[]>(std::size_t(1) << hash_bits);
+
+    std::size_t anchor = 0;
+    std::size_t pos = 0;
+    // the last bytes are always literals - hashing reads 4 bytes
+    std::size_t const limit = size > 12 ? size - 5 : 0;
+    while (pos + min_match <= limit) {
+        auto& entry = table[hash4(data + pos)];
+        std::size_t const candidate = entry;
+        entry = static_cast<std::uint32_t>(pos);
+        if (candidate >= pos || pos - candidate > max_offset ||
+            std::memcmp(data + candidate, data + pos, min_match) != 0) {
+            // skip faster through data that does not compress
+            pos += 1 + ((pos - anchor) >> 6);
+            continue;
+        }
+
+        std::size_t length = min_match;
+        while (pos + length < size && data[candidate + length] == data[pos + length]) {
+            ++length;
+        }
+        auto const extra = length - min_match;
+        auto const offset = pos - candidate;
+        put_literals(out, data + anchor, pos - anchor, static_cast<unsigned>(std::min<std::size_t>(extra, 15)));
+        out += static_cast<char>(offset & 0xff);
+        out += static_cast<char>(offset >> 8);
+        if (extra >= 15) {
+            put_length(out, extra - 15);
+        }
+        pos += length;
+        anchor = pos;
+    }
+    put_literals(out, data + anchor, size - anchor, 0);
+}
+
+bool _detail::lz_decompress(char const* data, std::size_t size, char* out, std::size_t raw_size) noexcept {
+    auto in = reinterpret_cast<unsigned char const*>(data);
+    auto const end = in + size;
+    std::size_t written = 0;
+
+    auto read_length = [&in, end](std::size_t& length) {
+        unsigned char byte;
+        do {
+            if (in == end) {
+                return false;
+            }
+            byte = *in++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    };
+
+    while (in < end) {
+        unsigned const token = *in++;
+        std::size_t literals = token >> 4;
+        if (literals == 15 && !read_length(literals)) {
+            return false;
+        }
+        if (literals > static_cast<std::size_t>(end - in) || literals > raw_size - written) {
+            return false;
+        }
+        std::memcpy(out + written, in, literals);
+        in += literals;
+        written += literals;
+        if (in == end) {
+            break;
+        }
+
+        if (end - in < 2) {
+            return false;
+        }
+        std::size_t const offset = in[0] | (std::size_t(in[1]) << 8);
+        in += 2;
+        std::size_t length = token & 15;
+        if (length == 15 && !read_length(length)) {
+            return false;
+        }
+        length += min_match;
+        if (offset == 0 || offset > written || length > raw_size - written) {
+            return false;
+        }
+        // source and destination overlap for repeated patterns
+        char* target = out + written;
+        char const* source = target - offset;
+        for (std::size_t i = 0; i < length; ++i) {
+            target[i] = source[i];
+        }
+        written += length;
+    }
+    return written == raw_size;
+}
+} // namespace compressed
+
+/////////////////////////////////////////////////////////////////////////////
+compressed_file_sink::compressed_file_sink(options opts)
+    : _opts(std::move(opts)), _file(nullptr), _busy(false), _stop(false), _error(0), _offset(0) {
+    if (!compressed::available(_opts.method)) {
+        throw std::system_error(ENOTSUP, std::generic_category(), "ext::logging - codec not available");
+    }
+    _opts.block_size = std::max<std::size_t>(_opts.block_size, 1);
+    _opts.max_pending_blocks = std::max<std::size_t>(_opts.max_pending_blocks, 1);
+
+    _file = std::fopen(_opts.path.c_str(), "wb");
+    if (!_file) {
+        throw std::system_error(errno, std::generic_category(), "ext::logging - can not open: " + _opts.path);
+    }
+    _offset = sizeof(compressed::magic) - 1;
+    if (std::fwrite(compressed::magic, 1, _offset, _file) != _offset) {
+        auto const error = errno;
+        std::fclose(_file);
+        throw std::system_error(error, std::generic_category(), "ext::logging - can not write: " + _opts.path);
+    }
+    _current.text.reserve(_opts.block_size);
+    _thread = std::thread([this] { background(); });
+}
+
+compressed_file_sink::~compressed_file_sink() {
+    try {
+        flush();
+    } catch (...) {
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_one();
+    _thread.join();
+
+    // a file without index is still readable
+    if (!std::ferror(_file)) {
+        write_index();
+    }
+    std::fclose(_file);
+}
+
+void compressed_file_sink::write(record const& rec) {
+    write(&rec, 1);
+}
+
+void compressed_file_sink::write(record const* records, std::size_t count) {
+    auto const now = compressed::now_ns();
+    for (std::size_t i = 0; i < count; ++i) {
+        auto const& text = records[i].text;
+        if (_current.records && _current.text.size() + text.size() > _opts.block_size) {
+            hand_over();
+        }
+        if (_current.records == 0) {
+            _current.first = now;
+        }
+        _current.text.append(text.data(), text.size());
+        _current.last = now;
+        ++_current.records;
+    }
+    if (_current.text.size() >= _opts.block_size) {
+        hand_over();
+    }
+}
+
+void compressed_file_sink::flush() {
+    if (_current.records) {
+        hand_over();
+    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this] { return _pending.empty() && !_busy; });
+    auto const error = std::exchange(_error, 0);
+    lock.unlock();
+    if (error) {
+        throw std::system_error(error, std::generic_category(), "ext::logging - can not write: " + _opts.path);
+    }
+}
+
+void compressed_file_sink::hand_over() {
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        // the compression falls behind
+        _done.wait(lock, [this] { return _pending.size() < _opts.max_pending_blocks; });
+        _pending.push_back(std::move(_current));
+        if (_free.empty()) {
+            _current = block{};
+        } else {
+            _current = std::move(_free.back());
+            _free.pop_back();
+        }
+    }
+    _wake.notify_one();
+    _current.text.clear();
+    _current.text.reserve(_opts.block_size);
+    _current.records = 0;
+}
+
+int compressed_file_sink::write_block(block const& raw) {
+    auto method = compressed::compress(_opts.method, raw.text, _stored);
+    auto const& stored = method == compressed::codec::stored ? raw.text : _stored;
+
+    char header[compressed::block_header_size] = {};
+    char* pos = header;
+    compressed::put(pos, static_cast<std::uint8_t>(method));
+    pos += 3;
+    compressed::put(pos, static_cast<std::uint32_t>(raw.text.size()));
+    compressed::put(pos, static_cast<std::uint32_t>(stored.size()));
+    compressed::put(pos, raw.records);
+    compressed::put(pos, raw.first);
+    compressed::put(pos, raw.last);
+
+    if (std::fwrite(header, 1, sizeof(header), _file) != sizeof(header) ||
+        std::fwrite(stored.data(), 1, stored.size(), _file) != stored.size() || std::fflush(_file) != 0) {
+        return errno ? errno : EIO;
+    }
+    _index.push_back({_offset,
+                      raw.first,
+                      raw.last,
+                      static_cast<std::uint32_t>(raw.text.size()),
+                      static_cast<std::uint32_t>(stored.size()),
+                      raw.records,
+                      method});
+    _offset += sizeof(header) + stored.size();
+    return 0;
+}
+
+void compressed_file_sink::write_index() {
+    std::string index(_index.size() * compressed::index_entry_size + sizeof(std::uint64_t), '\0');
+    char* pos = &index[0];
+    for (auto const& entry : _index) {
+        compressed::put(pos, entry.offset);
+        compressed::put(pos, entry.first);
+        compressed::put(pos, entry.last);
+        compressed::put(pos, entry.raw_size);
+        compressed::put(pos, entry.stored_size);
+        compressed::put(pos, entry.records);
+        compressed::put(pos, static_cast<std::uint8_t>(entry.method));
+        pos += 3;
+    }
+    compressed::put(pos, static_cast<std::uint64_t>(_index.size()));
+    index.append(compressed::index_magic, sizeof(compressed::index_magic) - 1);
+    std::fwrite(index.data(), 1, index.size(), _file);
+}
+
+void compressed_file_sink::background() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        if (!_pending.empty()) {
+            auto raw = std::move(_pending.front());
+            _pending.pop_front();
+            _busy = true;
+            lock.unlock();
+            _done.notify_all(); // room for the writer
+
+            auto const error = write_block(raw);
+
+            lock.lock();
+            _busy = false;
+            if (error) {
+                _error = error;
+            }
+            if (_free.size() < _opts.max_pending_blocks) {
+                _free.push_back(std::move(raw));
+            }
+            _done.notify_all();
+            continue;
+        }
+
+        if (_stop) {
+            break;
+        }
+        _wake.wait(lock);
+    }
+}
+
+}} // namespace ext::logging
@@ -0,0 +1,199 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <ext/logging/context.hpp>
+#include <ext/logging/emergency.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#if defined(__linux__)
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#elif defined(__APPLE__)
+    #include <pthread.h>
+#elif defined(_WIN32)
+    #include <windows.h>
+#endif
+
+namespace ext { namespace logging {
+namespace {
+// constant initialized and trivially destructible - no guard, no allocation
+struct thread_state {
+    // identity
+    bool identified = false;
+    std::uint64_t tid = 0;
+    char name[16] = {};
+    std::size_t name_size = 0;
+    char field[48] = {};
+    std::size_t field_size = 0;
+
+    // context - the pairs are kept formatted as ` key=value`
+    std::uint16_t ends[context::max_entries] = {};
+    std::size_t entries = 0;
+    std::size_t size = 0;
+    char text[context::capacity] = {};
+
+    // and unformatted for the structured formats - never longer than `text`
+    std::uint16_t key_ends[context::max_entries] = {};
+    std::uint16_t value_ends[context::max_entries] = {};
+    bool numbers[context::max_entries] = {};
+    char raw[context::capacity] = {};
+};
+
+thread_local thread_state current;
+
+std::uint64_t read_thread_id() noexcept {
+#if defined(__linux__)
+    return static_cast<std::uint64_t>(::syscall(SYS_gettid));
+#elif defined(__APPLE__)
+    std::uint64_t tid = 0;
+    pthread_threadid_np(nullptr, &tid);
+    return tid;
+#elif defined(_WIN32)
+    return static_cast<std::uint64_t>(GetCurrentThreadId());
+#else
+    return static_cast<std::uint64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
+}
+
+// formats `{<tid> <name>} `
+void update_field(thread_state& state) noexcept {
+    char* out = state.field;
+    *out++ = '{';
+    out = std::to_chars(out, state.field + sizeof(state.field), state.tid).ptr;
+    if (state.name_size) {
+        *out++ = ' ';
+        std::memcpy(out, state.name, state.name_size);
+        out += state.name_size;
+    }
+    *out++ = '}';
+    *out++ = ' ';
+    state.field_size = static_cast<std::size_t>(out - state.field);
+}
+
+thread_state& identified() noexcept {
+    auto& state = current;
+    if (!state.identified) {
+        state.tid = read_thread_id();
+        update_field(state);
+        state.identified = true;
+    }
+    return state;
+}
+
+bool needs_quotes(std::string_view value) noexcept {
+    return value.empty() || value.find_first_of(" \"=\\") != std::string_view::npos;
+}
+} // namespace
+
+void set_thread_name(std::string_view name) noexcept {
+    auto& state = identified();
+    state.name_size = std::min(name.size(), sizeof(state.name) - 1);
+    std::memcpy(state.name, name.data(), state.name_size);
+    update_field(state);
+}
+
+std::string_view thread_name() noexcept {
+    auto const& state = current;
+    return {state.name, state.name_size};
+}
+
+std::uint64_t thread_id() noexcept {
+    return identified().tid;
+}
+
+#ifndef _WIN32
+void _detail::forget_thread_identity() noexcept {
+    current.identified = false;
+}
+#endif // _WIN32
+
+std::string_view _detail::thread_field() noexcept {
+    auto const& state = identified();
+    return {state.field, state.field_size};
+}
+
+std::string_view _detail::context_field() noexcept {
+    auto const& state = current;
+    return {state.text, state.size};
+}
+
+std::size_t _detail::context_pairs(context_pair (&out)[context::max_entries]) noexcept {
+    auto const& state = current;
+    std::size_t begin = 0;
+    for (std::size_t i = 0; i < state.entries; ++i) {
+        std::size_t const key_end = state.key_ends[i];
+        std::size_t const value_end = state.value_ends[i];
+        out[i] = {{state.raw + begin, key_end - begin},
+                  {state.raw + key_end, value_end - key_end},
+                  state.numbers[i]};
+        begin = value_end;
+    }
+    return state.entries;
+}
+
+context::context(std::string_view key, std::string_view value) noexcept : context(key, value, false) {}
+
+context::context(std::string_view key, std::string_view value, bool is_number) noexcept : _pushed(false) {
+    auto& state = current;
+    if (state.entries == max_entries) {
+        return;
+    }
+
+    char* out = state.text + state.size;
+    char* const end = state.text + capacity;
+    auto put = [&out, end](char c) {
+        if (out == end) {
+            return false;
+        }
+        *out++ = c;
+        return true;
+    };
+
+    bool fits = put(' ');
+    for (char c : key) {
+        fits = fits && put(c);
+    }
+    fits = fits && put('=');
+    if (needs_quotes(value)) {
+        fits = fits && put('"');
+        for (char c : value) {
+            if (c == '"' || c == '\\') {
+                fits = fits && put('\\');
+            }
+            fits = fits && put(c);
+        }
+        fits = fits && put('"');
+    } else {
+        for (char c : value) {
+            fits = fits && put(c);
+        }
+    }
+    if (!fits) {
+        return; // the pair is left out
+    }
+
+    std::size_t const raw_begin = state.entries ? state.value_ends[state.entries - 1] : 0;
+    std::memcpy(state.raw + raw_begin, key.data(), key.size());
+    std::memcpy(state.raw + raw_begin + key.size(), value.data(), value.size());
+    state.key_ends[state.entries] = static_cast<std::uint16_t>(raw_begin + key.size());
+    state.value_ends[state.entries] = static_cast<std::uint16_t>(raw_begin + key.size() + value.size());
+    state.numbers[state.entries] = is_number;
+
+    state.size = static_cast<std::size_t>(out - state.text);
+    state.ends[state.entries++] = static_cast<std::uint16_t>(state.size);
+    _pushed = true;
+}
+
+context::~context() {
+    if (!_pushed) {
+        return;
+    }
+    auto& state = current;
+    --state.entries;
+    state.size = state.entries ? state.ends[state.entries - 1] : 0;
+}
+
+}} // namespace ext::logging
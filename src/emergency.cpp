@@ -0,0 +1,183 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#ifndef _WIN32
+#include <ext/logging/emergency.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <ext/logging/functionality.hpp>
+#include <ext/logging/sinks.hpp>
+
+#include <pthread.h>
+#include <unistd.h>
+
+namespace ext { namespace logging {
+namespace {
+static_assert(std::atomic<int>::is_always_lock_free, "the fd is read in signal handlers");
+static_assert(emergency::line::capacity <= PIPE_BUF, "lines written to pipes must not interleave");
+
+std::atomic<int> emergency_fd{STDERR_FILENO};
+
+// room for the end of the line - "...'\n"
+constexpr std::size_t tail_size = 5;
+
+void before_fork() noexcept {
+    _detail::logmutex.lock();
+    _detail::lock_sites();
+    _detail::lock_recorder();
+    // the buffered output would be written by both processes
+    try {
+        if (auto* target = configuration::sink) {
+            target->flush();
+        }
+    } catch (...) {
+    }
+}
+
+void after_fork_in_parent() noexcept {
+    _detail::unlock_recorder();
+    _detail::unlock_sites();
+    _detail::logmutex.unlock();
+}
+
+void after_fork_in_child() noexcept {
+    _detail::async_forget_writer();
+    // threads of sinks are gone, mapped files are shared with the parent
+    configuration::sink = nullptr;
+    _detail::binary_forget_sink();
+    _detail::forget_thread_identity();
+    _detail::recorder_forget_threads();
+    _detail::unlock_recorder();
+    _detail::unlock_sites();
+    _detail::logmutex.unlock();
+}
+} // namespace
+
+void emergency::set_fd(int fd) noexcept {
+    emergency_fd.store(fd, std::memory_order_relaxed);
+}
+
+int emergency::fd() noexcept {
+    return emergency_fd.load(std::memory_order_relaxed);
+}
+
+emergency::line::line(char const* id,
+                      _detail::logtopic const& topic,
+                      level level_,
+                      char const* file_name,
+                      int line_no,
+                      char const* function) noexcept {
+    // the fixed fields of the text format (see `write_prefix`) - the flags
+    // are lock-free atomics, `topic.name` is not changed after registration
+    *this << '[' << id << "] " << _detail::level_to_str(level_);
+    if (topic.id != topic::no_topic.id) {
+        *this << " (" << std::string_view(topic.name) << ')';
+    }
+    if (configuration::filename.load(std::memory_order_relaxed)) {
+        *this << ' ' << _detail::filename(file_name) << ':' << line_no;
+    }
+    if (configuration::function.load(std::memory_order_relaxed)) {
+        *this << " in " << function << "()";
+    }
+    *this << ": '";
+}
+
+emergency::line::~line() {
+    auto const saved_errno = errno; // the interrupted code may check it
+    if (_cut) {
+        std::memcpy(_buffer + _size, "...", 3);
+        _size += 3;
+    }
+    _buffer[_size++] = '\'';
+    _buffer[_size++] = '\n';
+
+    auto const target = fd();
+    char const* data = _buffer;
+    auto left = _size;
+    while (left > 0) {
+        auto const written = ::write(target, data, left);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break; // nobody to tell
+        }
+        data += written;
+        left -= static_cast<std::size_t>(written);
+    }
+    errno = saved_errno;
+}
+
+void emergency::line::append(char const* data, std::size_t size) noexcept {
+    auto const room = capacity - tail_size - _size;
+    if (size > room) {
+        size = room;
+        _cut = true;
+    }
+    std::memcpy(_buffer + _size, data, size);
+    _size += size;
+}
+
+void emergency::line::put(long long value) noexcept {
+    char text[24];
+    auto const end = std::to_chars(text, text + sizeof(text), value).ptr;
+    append(text, static_cast<std::size_t>(end - text));
+}
+
+void emergency::line::put(unsigned long long value) noexcept {
+    char text[24];
+    auto const end = std::to_chars(text, text + sizeof(text), value).ptr;
+    append(text, static_cast<std::size_t>(end - text));
+}
+
+emergency::line& emergency::line::operator<<(double value) noexcept {
+    char text[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    auto const end = std::to_chars(text, text + sizeof(text), value).ptr;
+#else
+    // snprintf is not async-signal-safe - the integral part and 6 digits
+    char* end = text;
+    if (std::isnan(value)) {
+        end = std::copy_n("nan", 3, end);
+    } else if (std::fabs(value) >= 1e19) {
+        end = std::copy_n("(too large)", 11, end);
+    } else {
+        if (value < 0) {
+            *end++ = '-';
+            value = -value;
+        }
+        auto whole = static_cast<unsigned long long>(value);
+        auto fraction = static_cast<unsigned long long>((value - static_cast<double>(whole)) * 1e6 + 0.5);
+        whole += fraction / 1000000;
+        fraction %= 1000000;
+        end = std::to_chars(end, text + sizeof(text), whole).ptr;
+        *end++ = '.';
+        for (unsigned long long digit = 100000; digit > 0; digit /= 10) {
+            *end++ = static_cast<char>('0' + fraction / digit % 10);
+        }
+    }
+#endif
+    append(text, static_cast<std::size_t>(end - text));
+    return *this;
+}
+
+emergency::line& emergency::line::operator<<(void const* value) noexcept {
+    char text[2 + 2 * sizeof(void*)] = {'0', 'x'};
+    auto const end = std::to_chars(text + 2, text + sizeof(text), reinterpret_cast<std::uintptr_t>(value), 16).ptr;
+    append(text, static_cast<std::size_t>(end - text));
+    return *this;
+}
+
+bool _detail::install_fork_handlers() noexcept {
+    return ::pthread_atfork(before_fork, after_fork_in_parent, after_fork_in_child) == 0;
+}
+
+}} // namespace ext::logging
+#endif // _WIN32
@@ -0,0 +1,166 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <ext/logging/functionality.hpp>
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+namespace ext { namespace logging {
+namespace {
+// size of `c` inside a quoted string
+std::size_t escaped_size(unsigned char c) noexcept {
+    switch (c) {
+        case '"':
+        case '\\':
+        case '\n':
+        case '\r':
+        case '\t':
+        case '\b':
+        case '\f':
+            return 2;
+        default:
+            return c < 0x20 ? 6 : 1;
+    }
+}
+
+// logfmt values with these characters are quoted
+bool needs_quotes(unsigned char c) noexcept {
+    return c <= ' ' || c == '=' || c == '"' || c == '\\';
+}
+
+// writes `c` escaped in front of `out` and returns the new front
+char* put_escaped_backwards(char* out, unsigned char c) noexcept {
+    char short_form = 0;
+    switch (c) {
+        case '"':
+            short_form = '"';
+            break;
+        case '\\':
+            short_form = '\\';
+            break;
+        case '\n':
+            short_form = 'n';
+            break;
+        case '\r':
+            short_form = 'r';
+            break;
+        case '\t':
+            short_form = 't';
+            break;
+        case '\b':
+            short_form = 'b';
+            break;
+        case '\f':
+            short_form = 'f';
+            break;
+        default:
+            if (c >= 0x20) {
+                *--out = static_cast<char>(c);
+                return out;
+            }
+            // \u00XX
+            static constexpr char hex[] = "0123456789abcdef";
+            *--out = hex[c & 0xf];
+            *--out = hex[c >> 4];
+            *--out = '0';
+            *--out = '0';
+            *--out = 'u';
+            *--out = '\\';
+            return out;
+    }
+    *--out = short_form;
+    *--out = '\\';
+    return out;
+}
+} // namespace
+
+void _detail::escape_tail(message_buffer& buffer, std::size_t start, output_format format) {
+    bool const json = format == output_format::json;
+    auto const size = buffer.size();
+
+    std::size_t escaped = 0;
+    bool quote = !json && start == size; // empty logfmt value
+    auto const* text = reinterpret_cast<unsigned char const*>(buffer.data());
+    for (std::size_t i = start; i < size; ++i) {
+        escaped += escaped_size(text[i]);
+        quote = quote || (!json && needs_quotes(text[i]));
+    }
+
+    auto const added = escaped - (size - start) + (quote ? 2 : 0);
+    if (added == 0) {
+        return; // the common case - nothing to escape
+    }
+
+    // move the value back to front so every character is read before it is overwritten
+    buffer.extend(added);
+    char* const begin = buffer.data() + start;
+    char* in = buffer.data() + size;
+    char* out = in + added;
+    if (quote) {
+        *--out = '"';
+    }
+    while (in != begin) {
+        out = put_escaped_backwards(out, static_cast<unsigned char>(*--in));
+    }
+    if (quote) {
+        *--out = '"';
+    }
+}
+
+void _detail::begin_field(message_buffer& buffer, std::string_view key, output_format format) {
+    if (format == output_format::json) {
+        buffer.append(",\"");
+        auto const start = buffer.size();
+        buffer.append(key);
+        escape_tail(buffer, start, format);
+        buffer.append("\":");
+        return;
+    }
+
+    // logfmt keys can not be quoted
+    buffer.append(' ');
+    for (char c : key) {
+        buffer.append(needs_quotes(static_cast<unsigned char>(c)) ? '_' : c);
+    }
+    if (key.empty()) {
+        buffer.append('_');
+    }
+    buffer.append('=');
+}
+
+void _detail::put_number(message_buffer& buffer, long long value) {
+    char text[24];
+    auto const end = std::to_chars(text, text + sizeof(text), value).ptr;
+    buffer.append(std::string_view(text, static_cast<std::size_t>(end - text)));
+}
+
+void _detail::put_number(message_buffer& buffer, unsigned long long value) {
+    char text[24];
+    auto const end = std::to_chars(text, text + sizeof(text), value).ptr;
+    buffer.append(std::string_view(text, static_cast<std::size_t>(end - text)));
+}
+
+void _detail::put_number(message_buffer& buffer, double value, output_format format) {
+    if (!std::isfinite(value)) {
+        if (format == output_format::json) {
+            buffer.append("null");
+        } else {
+            buffer.append(std::isnan(value) ? "nan" : value > 0 ? "inf" : "-inf");
+        }
+        return;
+    }
+
+    char text[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    // shortest representation that reads back to the same value
+    auto const end = std::to_chars(text, text + sizeof(text), value).ptr;
+    auto const size = static_cast<std::size_t>(end - text);
+#else
+    // no floating point to_chars (gcc < 11) - 17 digits always read back
+    auto const size = static_cast<std::size_t>(std::snprintf(text, sizeof(text), "%.17g", value));
+#endif
+    buffer.append(std::string_view(text, size));
+}
+
+}} // namespace ext::logging
@@ -0,0 +1,281 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <ext/logging/format.hpp>
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace ext { namespace logging {
+namespace {
+// inserts `count` times `c` at `offset`
+void insert(_detail::message_buffer& buffer, std::size_t offset, std::size_t count, char c) {
+    auto const size = buffer.size();
+    buffer.extend(count);
+    char* const at = buffer.data() + offset;
+    std::memmove(at + count, at, size - offset);
+    std::memset(at, c, count);
+}
+
+// fills up to the width with zeros behind the sign and base prefix
+void zero_pad(_detail::message_buffer& buffer, std::size_t start, std::size_t digits, format_spec const& spec) {
+    auto const length = buffer.size() - start;
+    if (spec.zero && spec.align == format_spec::none && length < static_cast<std::size_t>(spec.width)) {
+        insert(buffer, digits, static_cast<std::size_t>(spec.width) - length, '0');
+    }
+}
+
+// writes the sign of a non negative number
+void put_sign(_detail::message_buffer& buffer, bool negative, format_spec const& spec) {
+    if (negative) {
+        buffer.append('-');
+    } else if (spec.sign != '-') {
+        buffer.append(spec.sign);
+    }
+}
+
+int base_of(char type) noexcept {
+    switch (type) {
+        case 'x':
+        case 'X':
+            return 16;
+        case 'b':
+        case 'B':
+            return 2;
+        case 'o':
+            return 8;
+        default:
+            return 10;
+    }
+}
+
+void format_integer(_detail::message_buffer& buffer,
+                    unsigned long long magnitude,
+                    bool negative,
+                    format_spec const& spec) {
+    auto const start = buffer.size();
+    put_sign(buffer, negative, spec);
+    int const base = base_of(spec.type);
+    if (spec.alternate && base != 10) {
+        buffer.append(base == 8 ? "0" : spec.type == 'X' ? "0X" : spec.type == 'B' ? "0B" : spec.type == 'b' ? "0b" : "0x");
+    }
+    auto const digits = buffer.size();
+
+    char text[64];
+    auto const end = std::to_chars(text, text + sizeof(text), magnitude, base).ptr;
+    if (spec.type == 'X') {
+        for (char* c = text; c != end; ++c) {
+            if (*c >= 'a' && *c <= 'f') {
+                *c = static_cast<char>(*c - 'a' + 'A');
+            }
+        }
+    }
+    buffer.append(std::string_view(text, static_cast<std::size_t>(end - text)));
+    zero_pad(buffer, start, digits, spec);
+}
+
+// characters `to_chars` may need for `value` in `format` with `precision`
+std::size_t float_size(double value, int precision) noexcept {
+    int exponent = 0;
+    std::frexp(value, &exponent);
+    // digits before the point (fixed) plus sign, point, exponent and precision
+    return static_cast<std::size_t>(std::abs(exponent)) / 3 + 32 + static_cast<std::size_t>(precision < 0 ? 17 : precision);
+}
+} // namespace
+
+void _detail::format_value(format_output& out, long long value, format_spec const& spec) {
+    if (spec.type == 'c') {
+        format_value(out, static_cast<char>(value), format_spec{});
+        return;
+    }
+    auto const magnitude = value < 0 ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+    format_integer(out.buffer(), magnitude, value < 0, spec);
+}
+
+void _detail::format_value(format_output& out, unsigned long long value, format_spec const& spec) {
+    if (spec.type == 'c') {
+        format_value(out, static_cast<char>(value), format_spec{});
+        return;
+    }
+    format_integer(out.buffer(), value, false, spec);
+}
+
+namespace {
+// float and double - the shortest representation depends on the type
+template<typename T>
+void format_floating(format_output& out, T value, format_spec const& spec) {
+    auto& buffer = out.buffer();
+    auto const start = buffer.size();
+    put_sign(buffer, std::signbit(value), spec);
+    auto const digits = buffer.size();
+    auto const magnitude = std::fabs(value);
+
+    bool const upper = spec.type == 'F' || spec.type == 'E' || spec.type == 'G' || spec.type == 'A';
+    if (!std::isfinite(magnitude)) {
+        buffer.append(std::isnan(magnitude) ? (upper ? "NAN" : "nan") : (upper ? "INF" : "inf"));
+        return; // never zero padded
+    }
+
+    auto const capacity = float_size(static_cast<double>(magnitude), spec.precision);
+    buffer.extend(capacity);
+    char* const first = buffer.data() + digits;
+    char* end = first;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    char* const last = first + capacity;
+    std::chars_format format = std::chars_format::general;
+    switch (spec.type) {
+        case 'f':
+        case 'F':
+            format = std::chars_format::fixed;
+            break;
+        case 'e':
+        case 'E':
+            format = std::chars_format::scientific;
+            break;
+        case 'a':
+        case 'A':
+            format = std::chars_format::hex;
+            break;
+        default:
+            break;
+    }
+    if (spec.precision >= 0) {
+        end = std::to_chars(first, last, magnitude, format, spec.precision).ptr;
+    } else if (spec.type == 'a' || spec.type == 'A') {
+        end = std::to_chars(first, last, magnitude, format).ptr;
+    } else if (spec.type) {
+        end = std::to_chars(first, last, magnitude, format, 6).ptr; // like printf
+    } else {
+        end = std::to_chars(first, last, magnitude).ptr; // shortest
+    }
+#else
+    // no floating point to_chars (gcc < 11)
+    char pattern[8] = "%.*";
+    pattern[3] = spec.type ? static_cast<char>(spec.type | 0x20) : 'g';
+    int precision = spec.precision;
+    if (precision < 0 && !spec.type) {
+        // the shortest representation that reads back to the same value
+        for (precision = 1; precision < std::numeric_limits<T>::max_digits10; ++precision) {
+            std::snprintf(first, capacity, pattern, precision, static_cast<double>(magnitude));
+            if (static_cast<T>(std::strtod(first, nullptr)) == magnitude) {
+                break;
+            }
+        }
+    } else if (precision < 0) {
+        precision = spec.type == 'a' ? -1 : 6;
+    }
+    end = first + std::snprintf(first, capacity, pattern, precision, static_cast<double>(magnitude));
+#endif
+    if (upper) {
+        for (char* c = first; c != end; ++c) {
+            if (*c >= 'a' && *c <= 'z') {
+                *c = static_cast<char>(*c - 'a' + 'A');
+            }
+        }
+    }
+    buffer.truncate(static_cast<std::size_t>(end - buffer.data()));
+
+    if (spec.alternate && std::string_view(first, static_cast<std::size_t>(end - first)).find_first_of(".eEpP") ==
+                              std::string_view::npos) {
+        buffer.append('.');
+    }
+    zero_pad(buffer, start, digits, spec);
+}
+} // namespace
+
+void _detail::format_value(format_output& out, float value, format_spec const& spec) {
+    format_floating(out, value, spec);
+}
+
+void _detail::format_value(format_output& out, double value, format_spec const& spec) {
+    format_floating(out, value, spec);
+}
+
+void _detail::format_value(format_output& out, bool value, format_spec const& spec) {
+    if (spec.type && spec.type != 's') {
+        format_value(out, static_cast<unsigned long long>(value), spec);
+        return;
+    }
+    out.append(value ? "true" : "false");
+}
+
+void _detail::format_value(format_output& out, char value, format_spec const& spec) {
+    if (spec.type && spec.type != 'c') {
+        format_value(out, static_cast<long long>(value), spec);
+        return;
+    }
+    out.append(value);
+}
+
+void _detail::format_value(format_output& out, std::string_view value, format_spec const& spec) {
+    if (spec.precision >= 0 && static_cast<std::size_t>(spec.precision) < value.size()) {
+        value = value.substr(0, static_cast<std::size_t>(spec.precision));
+    }
+    out.append(value);
+}
+
+void _detail::format_value(format_output& out, void const* value, format_spec const&) {
+    format_spec hex;
+    hex.type = 'x';
+    hex.alternate = true;
+    format_integer(out.buffer(), reinterpret_cast<std::uintptr_t>(value), false, hex);
+}
+
+void _detail::vformat(format_output& out, std::string_view fmt, format_arg const* args, std::size_t count) {
+    auto& buffer = out.buffer();
+    std::size_t arg = 0;
+    std::size_t literal = 0; // start of the text not written yet
+    for (std::size_t i = 0; i < fmt.size(); ++i) {
+        char const c = fmt[i];
+        if (c != '{' && c != '}') {
+            continue;
+        }
+        buffer.append(fmt.substr(literal, i - literal));
+        if (i + 1 < fmt.size() && fmt[i + 1] == c) {
+            // escaped brace
+            buffer.append(c);
+            literal = ++i + 1;
+            continue;
+        }
+
+        auto const close = fmt.find('}', i);
+        if (c == '}' || close == std::string_view::npos || arg == count) {
+            literal = i; // not checked - written as is
+            break;
+        }
+        auto const field = fmt.substr(i + 1, close - i - 1);
+        format_spec spec;
+        if (!field.empty()) {
+            parse_spec(field.substr(1), spec);
+        }
+
+        auto const start = buffer.size();
+        args[arg].write(out, args[arg].value, spec);
+        ++arg;
+
+        // fill and align
+        auto const length = buffer.size() - start;
+        if (length < static_cast<std::size_t>(spec.width)) {
+            auto const padding = static_cast<std::size_t>(spec.width) - length;
+            auto align = spec.align;
+            if (align == format_spec::none) {
+                align = args[arg - 1].numeric ? format_spec::right : format_spec::left;
+            }
+            std::size_t const before = align == format_spec::right ? padding
+                                       : align == format_spec::center ? padding / 2
+                                                                      : 0;
+            insert(buffer, start, before, spec.fill);
+            insert(buffer, buffer.size(), padding - before, spec.fill);
+        }
+        literal = close + 1;
+        i = close;
+    }
+    if (literal < fmt.size()) {
+        buffer.append(fmt.substr(literal));
+    }
+}
+
+}} // namespace ext::logging
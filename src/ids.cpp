@@ -0,0 +1,80 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <ext/logging/ids.hpp>
+
+namespace ext { namespace logging {
+
+bool _detail::id_set::contains(std::uint64_t hash) const noexcept {
+    if (_size == 0) {
+        return false;
+    }
+    auto const mask = _slots.size() - 1;
+    for (auto i = home(hash);; i = (i + 1) & mask) {
+        if (_slots[i] == hash) {
+            return true;
+        }
+        if (_slots[i] == 0) {
+            return false;
+        }
+    }
+}
+
+void _detail::id_set::insert(std::uint64_t hash) {
+    if (contains(hash)) {
+        return;
+    }
+    // at most half full
+    if (2 * (_size + 1) > _slots.size()) {
+        std::vector<std::uint64_t> old(_slots.empty() ? 16 : 2 * _slots.size(), 0);
+        old.swap(_slots);
+        _size = 0;
+        for (auto value : old) {
+            if (value) {
+                insert(value);
+            }
+        }
+    }
+    auto const mask = _slots.size() - 1;
+    auto i = home(hash);
+    while (_slots[i]) {
+        i = (i + 1) & mask;
+    }
+    _slots[i] = hash;
+    ++_size;
+}
+
+void _detail::id_set::erase(std::uint64_t hash) noexcept {
+    if (_size == 0) {
+        return;
+    }
+    auto const mask = _slots.size() - 1;
+    auto hole = home(hash);
+    while (_slots[hole] != hash) {
+        if (_slots[hole] == 0) {
+            return;
+        }
+        hole = (hole + 1) & mask;
+    }
+
+    // moves later entries of the probe sequence into the hole
+    for (auto i = (hole + 1) & mask; _slots[i]; i = (i + 1) & mask) {
+        auto const wanted = home(_slots[i]);
+        // the entry stays if its home lies cyclically in (hole, i]
+        bool const stays = hole < i ? (wanted > hole && wanted <= i) : (wanted > hole || wanted <= i);
+        if (!stays) {
+            _slots[hole] = _slots[i];
+            hole = i;
+        }
+    }
+    _slots[hole] = 0;
+    --_size;
+}
+
+void _detail::id_set::clear() noexcept {
+    for (auto& value : _slots) {
+        value = 0;
+    }
+    _size = 0;
+}
+
+}} // namespace ext::logging
@@ -1,9 +1,17 @@
 // Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
 // Please see LICENSE.md for license or visit https://github.com/extcpp/basics
 #include <ext/logging.hpp>
+#include <ext/logging/context.hpp>
+#include <ext/logging/sinks.hpp>
 #include <ext/macros/compiler.hpp>
 #include <ext/util/except.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
 namespace ext { namespace logging {
 using namespace std::literals::string_literals;
 
@@ -12,10 +20,15 @@ EXT_INIT_PRIORITY_VC_HIGH
 // NEEDS TO BE CREATED FIRST!!!!
 EXT_INIT_PRIORITY_GNU(101) std::mutex _detail::logmutex{};
 
-// on construction topics register in this map beware of fiasco
-EXT_INIT_PRIORITY_GNU(102)
-std::map<int, _detail::logtopic*> _detail::topics_map{};
+#ifndef _WIN32
+// the child of a fork must not inherit a locked `logmutex` (emergency.cpp)
+namespace {
+bool const fork_handlers = _detail::install_fork_handlers();
+} // namespace
+#endif // _WIN32
 
+// on construction topics register in `_detail::topics` (topics.cpp) - it is
+// constant initialized and needs no priority
 EXT_INIT_PRIORITY_GNU(103)
 _detail::logtopic topic::no_topic{1, "default"s, level::warn};
 EXT_INIT_PRIORITY_GNU(103)
@@ -25,80 +38,788 @@ _detail::logtopic topic::network{3, "network"s, level::warn};
 EXT_INIT_PRIORITY_GNU(103)
 _detail::logtopic topic::engine{4, "engine"s, level::warn};
 
-bool configuration::prefix_newline{false};
-bool configuration::append_newline{true};
-bool configuration::filename{true};
-bool configuration::function{true};
+std::atomic<bool> configuration::prefix_newline{false};
+std::atomic<bool> configuration::append_newline{true};
+std::atomic<bool> configuration::threads{false};
+std::atomic<bool> configuration::filename{true};
+std::atomic<bool> configuration::function{true};
 #ifdef EXT_LOGGING_ENABLE_VIM_GDB
 bool configuration::vim{false};
 bool configuration::gdb{false};
 #endif
+timestamp_precision configuration::timestamp{timestamp_precision::none};
+output_format configuration::format{output_format::text};
+std::atomic<bool> configuration::utc{true};
+std::atomic<unsigned> _detail::configuration_sequence{0};
+bool configuration::coarse_clock{false};
 std::ostream* configuration::stream = &std::cout;
+sink* configuration::sink = nullptr;
 /////////////////////////////////////////////////////////////////////////////
 
-// the logger is a class that creates the log stream and writes
-// it threadsafe to a file descriptor
-_detail::logger::logger(
-    char const* id, logtopic const& topic, level level_, const char* file_name, int line_no, const char* function)
-    : _ss(), _out(*configuration::stream) {
-    _level = level_;
-    if (configuration::prefix_newline) {
-        _ss << "\n";
+void _detail::message_buffer::grow(std::size_t required) {
+    std::size_t const used = size();
+    std::size_t capacity = static_cast<std::size_t>(epptr() - pbase()) * 2;
+    if (capacity < used + required) {
+        capacity = used + required;
+    }
+
+    auto storage = std::make_unique<char[]>(capacity);
+    std::copy(pbase(), pptr(), storage.get());
+    _heap = std::move(storage);
+    setp(_heap.get(), _heap.get() + capacity);
+    pbump(static_cast<int>(used));
+}
+
+_detail::message_buffer::int_type _detail::message_buffer::overflow(int_type ch) {
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+        return traits_type::not_eof(ch);
+    }
+    append(traits_type::to_char_type(ch));
+    return ch;
+}
+
+std::streamsize _detail::message_buffer::xsputn(char const* str, std::streamsize count) {
+    auto const length = static_cast<std::size_t>(count);
+    if (static_cast<std::size_t>(epptr() - pptr()) < length) {
+        grow(length);
+    }
+    std::copy(str, str + length, pptr());
+    pbump(static_cast<int>(length));
+    return count;
+}
+
+namespace {
+_detail::message_stream& thread_stream() {
+    thread_local _detail::message_stream stream;
+    return stream;
+}
+} // namespace
+
+_detail::message_stream& _detail::message_stream::acquire() {
+    message_stream* stream = &thread_stream();
+    if (stream->in_use) {
+        stream = new message_stream();
+    }
+
+    stream->in_use = true;
+    stream->buffer.clear();
+    stream->fields.clear();
+    stream->fields_stream.clear();
+    stream->stream.clear();
+    stream->stream.flags(stream->defaults);
+    stream->stream.precision(6);
+    stream->stream.width(0);
+    stream->stream.fill(' ');
+    return *stream;
+}
+
+void _detail::message_stream::release(message_stream& stream) noexcept {
+    if (!stream.in_use) {
+        return;
+    }
+    stream.in_use = false;
+    // a nested stream was allocated by acquire
+    if (&stream != &thread_stream()) {
+        delete &stream;
+    }
+}
+
+namespace {
+// per message and per thread fields - they go in front of the cached prefix
+bool has_line_head() noexcept {
+    return configuration::timestamp != timestamp_precision::none ||
+           configuration::threads.load(std::memory_order_relaxed);
+}
+
+// a string value of a structured format
+void put_string(_detail::message_buffer& buffer, std::string_view value, output_format format) {
+    bool const json = format == output_format::json;
+    if (json) {
+        buffer.append('"');
+    }
+    auto const start = buffer.size();
+    buffer.append(value);
+    _detail::escape_tail(buffer, start, format);
+    if (json) {
+        buffer.append('"');
+    }
+}
+
+void write_line_head(_detail::message_buffer& buffer) {
+    auto const format = configuration::format;
+    if (format == output_format::text) {
+        if (configuration::timestamp != timestamp_precision::none) {
+            char stamp[_detail::timestamp_max_size];
+            buffer.append(std::string_view(stamp, _detail::format_timestamp(stamp)));
+        }
+        if (configuration::threads) {
+            buffer.append(_detail::thread_field());
+        }
+        return;
+    }
+
+    // structured formats - every field is followed by its separator
+    bool const json = format == output_format::json;
+    char const separator = json ? ',' : ' ';
+    if (configuration::timestamp != timestamp_precision::none) {
+        // ISO 8601 without the trailing space
+        char stamp[_detail::timestamp_max_size];
+        auto size = _detail::format_timestamp(stamp) - 1;
+        stamp[10] = 'T';
+        if (configuration::utc) {
+            stamp[size++] = 'Z';
+        }
+        buffer.append(json ? "\"time\":\"" : "time=");
+        buffer.append(std::string_view(stamp, size));
+        if (json) {
+            buffer.append('"');
+        }
+        buffer.append(separator);
+    }
+    if (configuration::threads) {
+        buffer.append(json ? "\"tid\":" : "tid=");
+        _detail::put_number(buffer, static_cast<unsigned long long>(thread_id()));
+        buffer.append(separator);
+        auto const name = thread_name();
+        if (!name.empty()) {
+            buffer.append(json ? "\"thread\":" : "thread=");
+            put_string(buffer, name, format);
+            buffer.append(separator);
+        }
+    }
+}
+
+// offset in a cached prefix the line head is inserted at
+std::size_t line_head_offset(std::string_view prefix) noexcept {
+    switch (configuration::format) {
+        case output_format::json:
+            return 1; // behind `{`
+        case output_format::logfmt:
+            return 0;
+        default:
+            // behind the lines written by `prefix_newline`, `vim` and `gdb`
+            return prefix.rfind('\n') + 1; // npos + 1 == 0
+    }
+}
+
+// the configuration the prefix depends on - a cached prefix is valid as long
+// as this value does not change
+enum generation_flag : unsigned { newline_flag = 2, filename_flag = 4, function_flag = 8, vim_flag = 16, gdb_flag = 32 };
+
+unsigned read_generation() noexcept {
+    unsigned generation = 1;
+    generation |= configuration::prefix_newline.load(std::memory_order_relaxed) ? newline_flag : 0u;
+    generation |= configuration::filename.load(std::memory_order_relaxed) ? filename_flag : 0u;
+    generation |= configuration::function.load(std::memory_order_relaxed) ? function_flag : 0u;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+    generation |= configuration::vim ? vim_flag : 0u;
+    generation |= configuration::gdb ? gdb_flag : 0u;
+#endif
+    generation |= static_cast<unsigned>(configuration::format) << 6;
+    return generation;
+}
+
+// the flags of one configuration - never some of an update in progress
+unsigned prefix_generation() noexcept {
+    auto& sequence = _detail::configuration_sequence;
+    for (;;) {
+        auto const before = sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            std::this_thread::yield(); // an update is applied
+            continue;
+        }
+        auto const generation = read_generation();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) {
+            return generation;
+        }
+    }
+}
+
+// `id=... level=... ... msg=` or `{"id":...,"msg":"` - the message follows
+void write_structured_prefix(_detail::message_buffer& buffer,
+                             unsigned generation,
+                             char const* id,
+                             _detail::logtopic const& topic,
+                             level level_,
+                             const char* file_name,
+                             int line_no,
+                             const char* function,
+                             bool line_head) {
+    auto const format = static_cast<output_format>(generation >> 6);
+    bool const json = format == output_format::json;
+    if (json) {
+        buffer.append('{');
+    }
+
+    // not part of cached prefixes
+    if (line_head && has_line_head()) {
+        write_line_head(buffer);
+    }
+
+    buffer.append(json ? "\"id\":" : "id=");
+    put_string(buffer, id, format);
+    _detail::begin_field(buffer, "level", format);
+    put_string(buffer, _detail::level_to_str(level_), format);
+    if (topic.id != topic::no_topic.id) {
+        _detail::begin_field(buffer, "topic", format);
+        put_string(buffer, topic.name, format);
+    }
+    if (generation & filename_flag) {
+        _detail::begin_field(buffer, "file", format);
+        put_string(buffer, _detail::filename(file_name), format);
+        _detail::begin_field(buffer, "line", format);
+        _detail::put_number(buffer, static_cast<long long>(line_no));
+    }
+    if (generation & function_flag) {
+        _detail::begin_field(buffer, "function", format);
+        put_string(buffer, function, format);
+    }
+    _detail::begin_field(buffer, "msg", format);
+    if (json) {
+        buffer.append('"');
+    }
+}
+
+// `out` writes to `buffer`
+void write_prefix(_detail::message_buffer& buffer,
+                  std::ostream& out,
+                  unsigned generation,
+                  char const* id,
+                  _detail::logtopic const& topic,
+                  level level_,
+                  const char* file_name,
+                  int line_no,
+                  const char* function,
+                  bool line_head) {
+    if (static_cast<output_format>(generation >> 6) != output_format::text) {
+        write_structured_prefix(buffer, generation, id, topic, level_, file_name, line_no, function, line_head);
+        return;
+    }
+
+    if (generation & newline_flag) {
+        out << "\n";
     }
 
 #ifdef EXT_LOGGING_ENABLE_VIM_GDB
     // # vim <filename> +<lineno>
-    if (configuration::vim) {
-        _ss << "# vim " << file_name << " +" << line_no << "\n";
+    if (generation & vim_flag) {
+        out << "# vim " << file_name << " +" << line_no << "\n";
     }
 
-    if (configuration::gdb) {
-        _ss << "# break " << ext::util::filename(file_name, true, true) << ":" << line_no << "\n";
+    if (generation & gdb_flag) {
+        out << "# break " << _detail::filename(file_name) << ":" << line_no << "\n";
     }
 #endif
 
+    // not part of cached prefixes
+    if (line_head && has_line_head()) {
+        write_line_head(buffer);
+    }
+
     // id
-    _ss << "[" << id << "] ";
+    out << "[" << id << "] ";
     // log level
-    _ss << level_to_str(level_);
+    out << _detail::level_to_str(level_);
 
     // log topic
     if (topic.id != topic::no_topic.id) {
-        _ss << " (" << topic.name << ")";
+        out << " (" << topic.name << ")";
     }
 
     // log filename
-    if (configuration::filename) {
-            _ss << " "
-                << ext::util::filename(file_name, true, true)
+    if (generation & filename_flag) {
+            out << " "
+                << _detail::filename(file_name)
                 << ":" << line_no;
     }
 
     // log function name
-    if (configuration::function) {
-        _ss << " in " << function << "()";
+    if (generation & function_flag) {
+        out << " in " << function << "()";
     }
-    _ss << ": '";
+    out << ": '";
+}
+
+// closes the message and adds the context of the thread and fields behind it
+void write_line_tail(_detail::message_stream& message,
+                     std::uint32_t payload,
+                     std::uint64_t suppressed,
+                     bool with_context = true) {
+    auto& buffer = message.buffer;
+    auto const format = configuration::format;
+    if (format == output_format::text) {
+        buffer.append('\'');
+        auto const context = with_context ? _detail::context_field() : std::string_view();
+        if (!context.empty()) {
+            buffer.append(context);
+        }
+        buffer.append(message.fields.view());
+        if (suppressed) {
+            message.stream << " (" << suppressed << " suppressed)";
+        }
+        return;
+    }
+
+    _detail::escape_tail(buffer, payload, format);
+    bool const json = format == output_format::json;
+    if (json) {
+        buffer.append('"');
+    }
+    _detail::context_pair pairs[context::max_entries];
+    auto const count = with_context ? _detail::context_pairs(pairs) : 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        _detail::begin_field(buffer, pairs[i].key, format);
+        if (pairs[i].number) {
+            buffer.append(pairs[i].value);
+        } else {
+            put_string(buffer, pairs[i].value, format);
+        }
+    }
+    buffer.append(message.fields.view());
+    if (suppressed) {
+        _detail::begin_field(buffer, "suppressed", format);
+        _detail::put_number(buffer, static_cast<unsigned long long>(suppressed));
+    }
+    if (json) {
+        buffer.append('}');
+    }
+}
+
+struct hazard_slot;
+
+// registered call sites and the ids that are switched off
+struct site_registry {
+    std::mutex mutex;
+    _detail::call_site* head = nullptr;
+    _detail::id_set disabled;
+    _detail::id_set allowed;
+    bool allow_list = false;
+    // replaced prefixes - freed once no hazard slot points to them
+    std::vector<std::unique_ptr<_detail::prefix_cache const>> retired;
+    std::vector<hazard_slot*> slots; // of all threads that asked for a prefix
+    std::vector<hazard_slot*> free_slots;
+};
+
+// never destroyed - sites may log during static destruction
+site_registry& registry() {
+    static site_registry* instance = new site_registry();
+    return *instance;
+}
+
+// state of the sites of an id - the registry must be locked
+std::uint8_t id_state(site_registry const& reg, std::uint64_t hash) noexcept {
+    bool const enabled = !reg.disabled.contains(hash) && (!reg.allow_list || reg.allowed.contains(hash));
+    return enabled ? _detail::call_site::enabled_state : _detail::call_site::disabled_state;
+}
+
+// applies the lists to all registered sites - the registry must be locked
+void update_sites(site_registry& reg) noexcept {
+    for (auto* site = reg.head; site; site = site->next) {
+        site->state.store(id_state(reg, site->hash), std::memory_order_relaxed);
+    }
+}
+
+#ifdef EXT_LOGGING_METRICS
+std::uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) noexcept {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+#endif // EXT_LOGGING_METRICS
+} // namespace
+
+struct _detail::prefix_cache {
+    unsigned generation;
+    std::string text;
+};
+
+namespace {
+// the prefix a thread copies - set until the thread asks for the next one
+struct hazard_slot {
+    std::atomic<_detail::prefix_cache const*> in_use{nullptr};
+    std::unique_ptr<_detail::prefix_cache const> unpublished; // lost the race - only this thread knows it
+};
+
+// trivially destructible - still usable by destructors of other thread_local
+// objects that log after the slot was handed back
+thread_local hazard_slot* local_slot = nullptr;
+thread_local bool slot_returned = false;
+
+// hands the slot back when the thread exits
+struct thread_hazard {
+    ~thread_hazard() {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        local_slot->in_use.store(nullptr, std::memory_order_relaxed);
+        local_slot->unpublished.reset();
+        reg.free_slots.push_back(local_slot);
+        local_slot = nullptr;
+        slot_returned = true;
+    }
+};
+
+hazard_slot& local_hazard() {
+    if (!local_slot) {
+        auto& reg = registry();
+        std::unique_lock<std::mutex> lock(reg.mutex);
+        if (slot_returned || reg.free_slots.empty()) {
+            // a slot taken after the thread handed its own back is never recycled
+            local_slot = new hazard_slot();
+            reg.slots.push_back(local_slot);
+        } else {
+            local_slot = reg.free_slots.back();
+            reg.free_slots.pop_back();
+        }
+        lock.unlock();
+        if (!slot_returned) {
+            thread_local thread_hazard owner;
+        }
+    }
+    return *local_slot;
+}
+
+// frees the retired prefixes that no thread copies - the registry must be locked
+void reclaim(site_registry& reg) {
+    auto const in_use = [&reg](_detail::prefix_cache const* cache) {
+        return std::any_of(reg.slots.begin(), reg.slots.end(), [cache](hazard_slot const* slot) {
+            return slot->in_use.load() == cache;
+        });
+    };
+    reg.retired.erase(std::remove_if(reg.retired.begin(),
+                                     reg.retired.end(),
+                                     [&in_use](auto const& cache) { return !in_use(cache.get()); }),
+                      reg.retired.end());
+}
+} // namespace
+
+std::uint8_t _detail::call_site::register_site() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    auto current = state.load(std::memory_order_relaxed);
+    if (current != unregistered) {
+        return current; // another thread was faster
+    }
+
+    next = reg.head;
+    reg.head = this;
+    current = id_state(reg, hash);
+    state.store(current, std::memory_order_relaxed);
+    return current;
+}
+
+std::size_t _detail::retired_prefixes() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.retired.size();
+}
+
+#ifndef _WIN32
+void _detail::lock_sites() noexcept {
+    registry().mutex.lock();
+}
+
+void _detail::unlock_sites() noexcept {
+    registry().mutex.unlock();
+}
+#endif // _WIN32
+
+std::string_view _detail::call_site::prefix() {
+    auto const generation = prefix_generation();
+    auto& hazard = local_hazard();
+    hazard.unpublished.reset();
+    auto const* current = cached.load(std::memory_order_acquire);
+    while (current && current->generation == generation) {
+        // announced before it is read - `reclaim` runs after the exchange
+        // below, so it sees the slot unless the prefix was replaced before
+        hazard.in_use.store(current);
+        auto const* again = cached.load();
+        if (again == current) {
+            return current->text;
+        }
+        current = again;
+    }
+
+    message_buffer buffer;
+    std::ostream out(&buffer);
+    write_prefix(buffer, out, generation, id, *topic, level_, file, line, function, false);
+    auto* fresh = new prefix_cache{generation, std::string(buffer.view())};
+
+    hazard.in_use.store(fresh);
+    if (cached.compare_exchange_strong(current, fresh)) {
+        if (current) {
+            auto& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.retired.emplace_back(current);
+            reclaim(reg);
+        }
+    } else {
+        // another thread replaced the prefix - ours is used for this message only
+        hazard.unpublished.reset(fresh);
+    }
+    return fresh->text;
+}
+
+void set_enabled(std::string_view id, bool enabled) {
+    auto const hash = id_hash(id);
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    if (enabled) {
+        reg.disabled.erase(hash);
+    } else {
+        reg.disabled.insert(hash);
+    }
+
+    auto const state = id_state(reg, hash);
+    for (auto* site = reg.head; site; site = site->next) {
+        if (site->hash == hash) {
+            site->state.store(state, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool is_enabled(std::string_view id) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return id_state(reg, id_hash(id)) == _detail::call_site::enabled_state;
+}
+
+void set_allowed_ids(std::vector<std::string_view> const& ids) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.allowed.clear();
+    for (auto id : ids) {
+        reg.allowed.insert(id_hash(id));
+    }
+    reg.allow_list = true;
+    update_sites(reg);
+}
+
+void clear_allowed_ids() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.allowed.clear();
+    reg.allow_list = false;
+    update_sites(reg);
+}
+
+std::vector<duplicate_id> duplicate_ids() {
+    std::vector<_detail::call_site const*> sites;
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (auto* site = reg.head; site; site = site->next) {
+            sites.push_back(site);
+        }
+    }
+    std::sort(sites.begin(), sites.end(), [](_detail::call_site const* left, _detail::call_site const* right) {
+        return left->hash < right->hash;
+    });
+
+    std::vector<duplicate_id> result;
+    for (auto first = sites.begin(); first != sites.end();) {
+        auto const last = std::find_if(first, sites.end(), [first](_detail::call_site const* site) {
+            return site->hash != (*first)->hash;
+        });
+        // sites of one location are the same statement (e.g. in a static
+        // function of a header that several translation units include)
+        duplicate_id found{(*first)->hash, {}};
+        for (auto it = first; it != last; ++it) {
+            bool const known = std::any_of(found.sites.begin(), found.sites.end(), [it](id_location const& seen) {
+                return seen.line == (*it)->line && std::strcmp(seen.file, (*it)->file) == 0;
+            });
+            if (!known) {
+                found.sites.push_back({(*it)->id, (*it)->file, (*it)->line});
+            }
+        }
+        if (found.sites.size() > 1) {
+            result.push_back(std::move(found));
+        }
+        first = last;
+    }
+    return result;
+}
+
+std::vector<metrics::site_count> metrics::top_sites(std::size_t count) {
+    std::vector<site_count> result;
+#ifdef EXT_LOGGING_METRICS
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (auto* site = reg.head; site; site = site->next) {
+            result.push_back({site->id, site->file, site->line, site->emitted.load(std::memory_order_relaxed)});
+        }
+    }
+    auto const middle = result.begin() + static_cast<std::ptrdiff_t>(std::min(count, result.size()));
+    std::partial_sort(result.begin(), middle, result.end(), [](site_count const& left, site_count const& right) {
+        return left.emitted > right.emitted;
+    });
+    result.erase(middle, result.end());
+#else
+    (void) count;
+#endif // EXT_LOGGING_METRICS
+    return result;
+}
+
+#ifdef EXT_LOGGING_METRICS
+// called by `metrics::reset`
+void _detail::reset_site_counts() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (auto* site = reg.head; site; site = site->next) {
+        site->emitted.store(0, std::memory_order_relaxed);
+    }
+}
+#endif // EXT_LOGGING_METRICS
+
+// the logger is a class that creates the log stream and writes
+// it threadsafe to a file descriptor
+_detail::logger::logger(
+    char const* id, logtopic const& topic, level level_, const char* file_name, int line_no, const char* function)
+    : _message(message_stream::acquire()), _ss(_message.stream), _out(*configuration::stream), _topic(&topic) {
+    _level = level_;
+    write_prefix(_message.buffer, _ss, prefix_generation(), id, topic, level_, file_name, line_no, function, true);
+    _payload = static_cast<std::uint32_t>(_message.buffer.size());
+    _record_only = topic.activation_level.load(std::memory_order_relaxed) < level_;
+}
+
+// same as above but copies the prefix cached by the call site
+_detail::logger::logger(call_site& site)
+    : _message(message_stream::acquire())
+    , _ss(_message.stream)
+    , _out(*configuration::stream)
+    , _topic(site.topic)
+    , _site(&site) {
+    _level = site.level_;
+    auto const prefix = site.prefix();
+    if (!has_line_head()) {
+        _message.buffer.append(prefix);
+    } else {
+        auto const line = line_head_offset(prefix);
+        _message.buffer.append(prefix.substr(0, line));
+        write_line_head(_message.buffer);
+        _message.buffer.append(prefix.substr(line));
+    }
+    _payload = static_cast<std::uint32_t>(_message.buffer.size());
+    _record_only = _topic->activation_level.load(std::memory_order_relaxed) < _level;
 }
 
 void _detail::logger::write() {
-    std::lock_guard<std::mutex> lock(logmutex);
+    write_line_tail(_message, _payload, _suppressed);
+    if (configuration::append_newline.load(std::memory_order_relaxed)) {
+        _message.buffer.append('\n');
+    }
+
+    auto const message = _message.buffer.view();
+    if (_record_only) {
+        record_message(_level, message);
+        return;
+    }
+
+    record const rec{_level, message, _site, _payload};
+#ifdef EXT_LOGGING_METRICS
+    count(_topic->id, _level, metrics::counter::emitted);
+    count(_topic->id, _level, metrics::counter::bytes, message.size());
+    if (_site) {
+        _site->emitted.fetch_add(1, std::memory_order_relaxed);
+    }
+#endif // EXT_LOGGING_METRICS
+    if (_level == level::fatal) {
+        // everything logged so far must be written before we terminate
+        async::flush();
+        recorder::dump();
+    } else if (async_enqueue(rec, _topic->id)) {
+        return;
+    }
 
-    _out << _ss.rdbuf() << "'";
-    if (configuration::append_newline) {
-        _out << "\n";
+#ifdef EXT_LOGGING_METRICS
+    // the clock is only read when the mutex is contended
+    std::unique_lock<std::mutex> lock(logmutex, std::try_to_lock);
+    if (!lock) {
+        auto const start = std::chrono::steady_clock::now();
+        lock.lock();
+        count(_topic->id, _level, metrics::counter::wait_ns, elapsed_ns(start));
     }
-    _out << std::flush; // close message
+    auto const sink_start = std::chrono::steady_clock::now();
+#else
+    std::lock_guard<std::mutex> lock(logmutex);
+#endif // EXT_LOGGING_METRICS
+    if (auto* target = configuration::sink) {
+        target->write(rec);
+        if (_level == level::fatal) {
+            target->flush();
+        }
+    } else {
+        _out.write(message.data(), static_cast<std::streamsize>(message.size())) << std::flush; // close message
+    }
+#ifdef EXT_LOGGING_METRICS
+    count(_topic->id, _level, metrics::counter::sink_ns, elapsed_ns(sink_start));
+#endif // EXT_LOGGING_METRICS
 
     if (_level == level::fatal) {
         std::terminate();
     }
 }
 
+std::uint32_t _detail::note_line(call_site& site, std::string_view note, std::string& out) {
+    auto& message = message_stream::acquire();
+    message.buffer.append(site.prefix());
+    auto const payload = static_cast<std::uint32_t>(message.buffer.size());
+    message.buffer.append(note);
+    write_line_tail(message, payload, 0, false);
+    if (configuration::append_newline.load(std::memory_order_relaxed)) {
+        message.buffer.append('\n');
+    }
+    out.assign(message.buffer.view());
+    message_stream::release(message);
+    return payload;
+}
+
+_detail::logger& _detail::logger::put(std::string_view value) {
+    _ss << value;
+    return *this;
+}
+
+// each type on its own - the stream formats them differently (e.g. in hex)
+_detail::logger& _detail::logger::put(int value) {
+    _ss << value;
+    return *this;
+}
+
+_detail::logger& _detail::logger::put(long value) {
+    _ss << value;
+    return *this;
+}
+
+_detail::logger& _detail::logger::put(long long value) {
+    _ss << value;
+    return *this;
+}
+
+_detail::logger& _detail::logger::put(unsigned value) {
+    _ss << value;
+    return *this;
+}
+
+_detail::logger& _detail::logger::put(unsigned long value) {
+    _ss << value;
+    return *this;
+}
+
+_detail::logger& _detail::logger::put(unsigned long long value) {
+    _ss << value;
+    return *this;
+}
+
+_detail::logger& _detail::logger::put(double value) {
+    _ss << value;
+    return *this;
+}
+
 _detail::logger::~logger() {
     try {
         write();
     } catch (...) {
     }
+    message_stream::release(_message);
 }
 }} // namespace ext::logging
@@ -0,0 +1,128 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <ext/logging/metrics.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ext { namespace logging {
+#ifdef EXT_LOGGING_METRICS
+namespace {
+// counters of one thread - only the owning thread writes, so plain relaxed
+// loads and stores are enough
+struct alignas(64) counter_block {
+    std::atomic<std::uint64_t> values[metrics::topic_slots][metrics::level_count][metrics::counter_count] = {};
+};
+
+struct block_registry {
+    std::mutex mutex;
+    std::vector<counter_block*> blocks;   // all blocks ever created
+    std::vector<counter_block*> free;     // blocks of exited threads
+    metrics::snapshot exited;             // counts of exited threads
+    metrics::snapshot baseline;           // subtracted by `collect` - set by `reset`
+};
+
+block_registry& registry() {
+    // leaked - threads may exit during static destruction
+    static block_registry* instance = new block_registry();
+    return *instance;
+}
+
+void add_block(metrics::snapshot& snap, counter_block const& block) {
+    for (std::size_t t = 0; t < metrics::topic_slots; ++t) {
+        for (std::size_t l = 0; l < metrics::level_count; ++l) {
+            for (std::size_t c = 0; c < metrics::counter_count; ++c) {
+                snap.values[t][l][c] += block.values[t][l][c].load(std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+// hands the block back when the thread exits - without memory the thread
+// counts nothing, `count` must not throw
+struct thread_block {
+    thread_block() noexcept {
+        try {
+            auto& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            if (reg.free.empty()) {
+                auto fresh = std::make_unique<counter_block>();
+                reg.blocks.push_back(fresh.get());
+                block = fresh.release();
+            } else {
+                block = reg.free.back();
+                reg.free.pop_back();
+            }
+        } catch (...) {
+            block = nullptr;
+        }
+    }
+
+    ~thread_block() {
+        if (!block) {
+            return;
+        }
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        add_block(reg.exited, *block);
+        for (auto& topic : block->values) {
+            for (auto& level_ : topic) {
+                for (auto& value : level_) {
+                    value.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+        reg.free.push_back(block);
+    }
+
+    counter_block* block = nullptr;
+};
+} // namespace
+
+void _detail::count(int topic_id, level level_, metrics::counter what, std::uint64_t value) noexcept {
+    thread_local thread_block mine;
+    if (!mine.block) {
+        return;
+    }
+    auto& counter = mine.block->values[metrics::topic_index(topic_id)][metrics::level_index(level_)]
+                                      [static_cast<std::size_t>(what)];
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+metrics::snapshot metrics::collect() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    snapshot result = reg.exited;
+    for (auto const* block : reg.blocks) {
+        add_block(result, *block);
+    }
+    for (std::size_t t = 0; t < topic_slots; ++t) {
+        for (std::size_t l = 0; l < level_count; ++l) {
+            for (std::size_t c = 0; c < counter_count; ++c) {
+                result.values[t][l][c] -= reg.baseline.values[t][l][c];
+            }
+        }
+    }
+    return result;
+}
+
+void metrics::reset() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    snapshot current = reg.exited;
+    for (auto const* block : reg.blocks) {
+        add_block(current, *block);
+    }
+    reg.baseline = current;
+    _detail::reset_site_counts();
+}
+#else
+metrics::snapshot metrics::collect() {
+    return snapshot{};
+}
+
+void metrics::reset() {}
+#endif // EXT_LOGGING_METRICS
+}} // namespace ext::logging
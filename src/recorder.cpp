@@ -0,0 +1,291 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <ext/logging/recorder.hpp>
+#include <ext/logging/emergency.hpp>
+#include <ext/logging/sinks.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace ext { namespace logging {
+std::atomic<int> _detail::record_level{-1};
+
+namespace {
+struct entry_header {
+    std::uint64_t time; // steady clock nanoseconds - comparable between threads
+    std::uint32_t size; // of the text behind the header
+    std::int32_t level_;
+};
+
+std::uint64_t now_ns() noexcept {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now().time_since_epoch())
+                                          .count());
+}
+
+// Messages of one thread. Offsets only grow and are taken modulo the capacity,
+// so an entry may wrap around the end. The owning thread writes without a
+// lock, `dump` copies the buffer and retries if the sequence changed (odd
+// while the owner writes).
+struct ring {
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<std::uint64_t> head{0}; // end of the newest entry
+    std::atomic<std::uint64_t> tail{0}; // begin of the oldest entry
+    std::uint64_t dumped = 0;           // time of the newest entry dumped - guarded by the registry
+    std::size_t capacity = 0;
+    std::unique_ptr<char[]> data;
+};
+
+void copy_in(char* data, std::size_t capacity, std::uint64_t offset, void const* from, std::size_t size) noexcept {
+    auto const begin = static_cast<std::size_t>(offset % capacity);
+    auto const first = std::min(size, capacity - begin);
+    std::memcpy(data + begin, from, first);
+    std::memcpy(data, static_cast<char const*>(from) + first, size - first);
+}
+
+void copy_out(char const* data, std::size_t capacity, std::uint64_t offset, void* to, std::size_t size) noexcept {
+    auto const begin = static_cast<std::size_t>(offset % capacity);
+    auto const first = std::min(size, capacity - begin);
+    std::memcpy(to, data + begin, first);
+    std::memcpy(static_cast<char*>(to) + first, data, size - first);
+}
+
+struct ring_registry {
+    std::mutex mutex;
+    std::vector<ring*> rings; // all rings ever created
+    std::vector<ring*> free;  // rings of exited threads
+    std::atomic<std::size_t> bytes_per_thread{recorder::options{}.bytes_per_thread};
+    std::uint64_t started = 0; // older entries are not dumped
+};
+
+ring_registry& registry() {
+    // leaked - threads may exit during static destruction
+    static ring_registry* instance = new ring_registry();
+    return *instance;
+}
+
+// hands the ring back when the thread exits - its messages stay until a new
+// thread overwrites them
+struct thread_ring {
+    ~thread_ring() {
+        if (mine) {
+            auto& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.free.push_back(mine);
+        }
+    }
+
+    ring* acquire(std::size_t capacity) {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        if (!mine) {
+            if (reg.free.empty()) {
+                mine = new ring();
+                reg.rings.push_back(mine);
+            } else {
+                mine = reg.free.back();
+                reg.free.pop_back();
+            }
+        }
+        if (mine->capacity != capacity) {
+            // `dump` holds the mutex while it reads
+            mine->data = std::make_unique<char[]>(capacity);
+            mine->capacity = capacity;
+            mine->head.store(0, std::memory_order_relaxed);
+            mine->tail.store(0, std::memory_order_relaxed);
+        }
+        return mine;
+    }
+
+    ring* mine = nullptr;
+};
+
+thread_ring& local_ring() {
+    thread_local thread_ring local;
+    return local;
+}
+
+struct recorded {
+    std::uint64_t time;
+    level level_;
+    std::string_view text;
+};
+
+// copies the entries of `r` newer than `after` into `storage`
+void collect(ring& r, std::uint64_t after, std::vector<char>& storage, std::vector<recorded>& out) {
+    if (!r.data) {
+        return;
+    }
+    std::uint64_t head = 0, tail = 0;
+    storage.resize(r.capacity);
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        auto const before = r.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            std::this_thread::yield(); // the owner is writing
+            continue;
+        }
+        head = r.head.load(std::memory_order_relaxed);
+        tail = r.tail.load(std::memory_order_relaxed);
+        std::memcpy(storage.data(), r.data.get(), r.capacity);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (r.sequence.load(std::memory_order_relaxed) == before) {
+            break;
+        }
+        head = tail = 0; // the owner keeps writing - give up on this ring
+    }
+
+    // the text may wrap - entries are linearized behind the copy
+    auto const linear = storage.size();
+    storage.resize(linear + static_cast<std::size_t>(head - tail));
+    char* text = storage.data() + linear;
+    for (auto offset = tail; offset < head;) {
+        entry_header header;
+        copy_out(storage.data(), r.capacity, offset, &header, sizeof(header));
+        copy_out(storage.data(), r.capacity, offset + sizeof(header), text, header.size);
+        if (header.time > after) {
+            out.push_back({header.time, static_cast<level>(header.level_), {text, header.size}});
+        }
+        text += header.size;
+        offset += sizeof(header) + header.size;
+    }
+}
+
+// the log macros compare the checked level of the topic only
+void update_checked_levels() noexcept {
+    std::lock_guard<std::mutex> lock(_detail::logmutex);
+    for (std::size_t id = 0; id < _detail::topics_end; ++id) {
+        if (auto* topic = _detail::topics[id]) {
+            _detail::update_checked_level(*topic);
+        }
+    }
+}
+} // namespace
+
+void _detail::record_message(level level_, std::string_view message) {
+    auto& local = local_ring();
+    auto const capacity = registry().bytes_per_thread.load(std::memory_order_relaxed);
+    ring* r = local.mine;
+    if (!r || r->capacity != capacity) {
+        r = local.acquire(capacity);
+    }
+    if (message.size() + sizeof(entry_header) > capacity) {
+        message = message.substr(0, capacity - sizeof(entry_header));
+    }
+
+    entry_header const header{now_ns(), static_cast<std::uint32_t>(message.size()), static_cast<std::int32_t>(level_)};
+    auto const needed = sizeof(header) + message.size();
+
+    auto const sequence = r->sequence.load(std::memory_order_relaxed);
+    r->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto const head = r->head.load(std::memory_order_relaxed);
+    auto tail = r->tail.load(std::memory_order_relaxed);
+    while (head + needed - tail > capacity) {
+        // overwrite the oldest entry
+        entry_header oldest;
+        copy_out(r->data.get(), capacity, tail, &oldest, sizeof(oldest));
+        tail += sizeof(oldest) + oldest.size;
+    }
+    copy_in(r->data.get(), capacity, head, &header, sizeof(header));
+    copy_in(r->data.get(), capacity, head + sizeof(header), message.data(), message.size());
+    r->tail.store(tail, std::memory_order_relaxed);
+    r->head.store(head + needed, std::memory_order_relaxed);
+
+    r->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+#ifndef _WIN32
+void _detail::lock_recorder() noexcept {
+    registry().mutex.lock();
+}
+
+void _detail::unlock_recorder() noexcept {
+    registry().mutex.unlock();
+}
+
+void _detail::recorder_forget_threads() noexcept {
+    // the messages belong to the parent and the other threads do not exist -
+    // their rings are free, a write they interrupted leaves an odd sequence
+    auto& reg = registry();
+    auto* mine = local_ring().mine;
+    reg.free.clear();
+    for (auto* r : reg.rings) {
+        r->tail.store(r->head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        r->sequence.store((r->sequence.load(std::memory_order_relaxed) | 1) + 1, std::memory_order_relaxed);
+        if (r != mine) {
+            reg.free.push_back(r);
+        }
+    }
+}
+#endif // _WIN32
+
+void recorder::start(options const& opts) {
+    auto& reg = registry();
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.started = now_ns();
+        reg.bytes_per_thread.store(std::max(opts.bytes_per_thread, sizeof(entry_header) + 64),
+                                   std::memory_order_relaxed);
+    }
+    _detail::record_level.store(static_cast<int>(opts.record_level));
+    update_checked_levels();
+}
+
+void recorder::stop() noexcept {
+    _detail::record_level.store(-1);
+    update_checked_levels();
+}
+
+bool recorder::active() noexcept {
+    return _detail::record_level.load(std::memory_order_relaxed) >= 0;
+}
+
+std::size_t recorder::dump() {
+    auto& reg = registry();
+    std::vector<std::vector<char>> storage;
+    std::vector<recorded> entries;
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        if (reg.rings.empty()) {
+            return 0;
+        }
+        storage.resize(reg.rings.size());
+        for (std::size_t i = 0; i < reg.rings.size(); ++i) {
+            auto& r = *reg.rings[i];
+            auto const first = entries.size();
+            collect(r, std::max(reg.started, r.dumped), storage[i], entries);
+            for (auto j = first; j < entries.size(); ++j) {
+                r.dumped = std::max(r.dumped, entries[j].time);
+            }
+        }
+    }
+
+    // every ring is sorted already
+    std::stable_sort(entries.begin(), entries.end(), [](recorded const& left, recorded const& right) {
+        return left.time < right.time;
+    });
+
+    std::lock_guard<std::mutex> lock(_detail::logmutex);
+    if (auto* target = configuration::sink) {
+        for (auto const& entry : entries) {
+            target->write(record{entry.level_, entry.text});
+        }
+        target->flush();
+    } else {
+        for (auto const& entry : entries) {
+            configuration::stream->write(entry.text.data(), static_cast<std::streamsize>(entry.text.size()));
+        }
+        configuration::stream->flush();
+    }
+    return entries.size();
+}
+
+}} // namespace ext::logging
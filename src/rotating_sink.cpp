@@ -0,0 +1,308 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#ifndef _WIN32
+#include <ext/logging/rotating_sink.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace ext { namespace logging {
+namespace fs = std::filesystem;
+
+namespace {
+std::string segment_name(std::string const& base_name, std::uint64_t sequence) {
+    char number[32];
+    std::snprintf(number, sizeof(number), ".%08llu.log", static_cast<unsigned long long>(sequence));
+    return base_name + number;
+}
+
+// returns the sequence number of `<base_name>.<sequence>.log` or -1
+long long segment_sequence(std::string const& base_name, std::string const& name) {
+    std::string_view view(name);
+    if (view.size() <= base_name.size() + 5 || view.substr(0, base_name.size()) != base_name ||
+        view[base_name.size()] != '.' || view.substr(view.size() - 4) != ".log") {
+        return -1;
+    }
+    view = view.substr(base_name.size() + 1, view.size() - base_name.size() - 5);
+    // too many digits for a sequence number - not one of ours
+    long long sequence = -1;
+    auto const [end, error] = std::from_chars(view.data(), view.data() + view.size(), sequence);
+    if (view.empty() || error != std::errc() || end != view.data() + view.size() || view[0] == '-') {
+        return -1;
+    }
+    return sequence;
+}
+
+struct segment_file {
+    std::uint64_t sequence;
+    fs::path path;
+    std::uint64_t size;
+};
+
+std::vector<segment_file> list_segments(std::string const& directory, std::string const& base_name) {
+    std::vector<segment_file> files;
+    std::error_code ec;
+    for (auto const& entry : fs::directory_iterator(directory, ec)) {
+        auto sequence = segment_sequence(base_name, entry.path().filename().string());
+        if (sequence >= 0 && entry.is_regular_file(ec)) {
+            files.push_back({static_cast<std::uint64_t>(sequence), entry.path(), entry.file_size(ec)});
+        }
+    }
+    std::sort(files.begin(), files.end(), [](auto const& l, auto const& r) { return l.sequence < r.sequence; });
+    return files;
+}
+} // namespace
+
+rotating_file_sink::rotating_file_sink(options opts)
+    : _opts(std::move(opts)), _next_sequence(0), _active_sequence(0), _stop(false) {
+    if (_opts.segment_size == 0) {
+        _opts.segment_size = 1;
+    }
+
+    auto existing = list_segments(_opts.directory, _opts.base_name);
+    if (!existing.empty()) {
+        _next_sequence = existing.back().sequence + 1;
+    }
+
+    _current = create_segment(_next_sequence++);
+    _active_sequence = _current->sequence;
+    update_deadline();
+    _thread = std::thread([this] { background(); });
+}
+
+rotating_file_sink::~rotating_file_sink() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_one();
+    _thread.join();
+
+    for (auto& seg : _finished) {
+        finish_segment(*seg);
+    }
+    _finished.clear();
+    if (_prepared) {
+        discard_segment(*_prepared);
+    }
+    if (_current) {
+        finish_segment(*_current);
+        _active_sequence = _current->sequence + 1;
+    }
+    try {
+        apply_retention(true);
+    } catch (...) {
+    }
+}
+
+void rotating_file_sink::write(record const& rec) {
+    if (_opts.interval.count() && std::chrono::system_clock::now() >= _deadline) {
+        rotate();
+    }
+
+    std::string_view text = rec.text;
+    // do not split records that fit into a fresh segment
+    if (text.size() > _current->size - _current->used && text.size() <= _opts.segment_size) {
+        rotate();
+    }
+
+    while (!text.empty()) {
+        auto count = std::min(text.size(), _current->size - _current->used);
+        std::memcpy(_current->data + _current->used, text.data(), count);
+        _current->used += count;
+        text.remove_prefix(count);
+        if (!text.empty()) {
+            rotate();
+        }
+    }
+}
+
+void rotating_file_sink::flush() {
+    if (_current->used) {
+        ::msync(_current->data, _current->used, MS_ASYNC);
+    }
+}
+
+void rotating_file_sink::rotate() {
+    auto next = take_prepared();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _finished.push_back(std::move(_current));
+        _active_sequence = next->sequence;
+    }
+    _current = std::move(next);
+    update_deadline();
+    _wake.notify_one();
+}
+
+std::string rotating_file_sink::current_file() const {
+    return _current->path;
+}
+
+void rotating_file_sink::update_deadline() {
+    if (_opts.interval.count() == 0) {
+        return;
+    }
+    // align to multiples of the interval, so hourly files start at full hours
+    auto since_epoch = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    auto boundary = (since_epoch / _opts.interval + 1) * _opts.interval;
+    _deadline = std::chrono::system_clock::time_point(boundary);
+}
+
+std::unique_ptr<rotating_file_sink::segment> rotating_file_sink::take_prepared() {
+    std::uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_prepared) {
+            return std::move(_prepared);
+        }
+        sequence = _next_sequence++;
+    }
+    // the background thread fell behind - do it ourselves
+    return create_segment(sequence);
+}
+
+std::unique_ptr<rotating_file_sink::segment> rotating_file_sink::create_segment(std::uint64_t sequence) {
+    auto seg = std::make_unique<segment>();
+    seg->sequence = sequence;
+    seg->path = (fs::path(_opts.directory) / segment_name(_opts.base_name, sequence)).string();
+    seg->size = _opts.segment_size;
+
+    seg->fd = ::open(seg->path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (seg->fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "ext::logging - can not open: " + seg->path);
+    }
+    // the blocks are allocated now - a sparse file would raise SIGBUS when a
+    // write through the mapping hits a full disk
+#ifdef __APPLE__
+    fstore_t store = {F_ALLOCATEALL, F_PEOFPOSMODE, 0, static_cast<off_t>(seg->size), 0};
+    auto allocate_error = ::fcntl(seg->fd, F_PREALLOCATE, &store) == -1 ? errno : 0;
+    if (allocate_error == 0 && ::ftruncate(seg->fd, static_cast<off_t>(seg->size)) != 0) {
+        allocate_error = errno;
+    }
+#else
+    auto allocate_error = ::posix_fallocate(seg->fd, 0, static_cast<off_t>(seg->size));
+#endif // __APPLE__
+    if (allocate_error != 0) {
+        ::close(seg->fd);
+        ::unlink(seg->path.c_str());
+        throw std::system_error(
+            allocate_error, std::generic_category(), "ext::logging - can not allocate: " + seg->path);
+    }
+    void* data = ::mmap(nullptr, seg->size, PROT_READ | PROT_WRITE, MAP_SHARED, seg->fd, 0);
+    if (data == MAP_FAILED) {
+        auto error = errno;
+        ::close(seg->fd);
+        throw std::system_error(error, std::generic_category(), "ext::logging - can not map: " + seg->path);
+    }
+    seg->data = static_cast<char*>(data);
+    return seg;
+}
+
+void rotating_file_sink::finish_segment(segment& seg) {
+    if (seg.data) {
+        ::munmap(seg.data, seg.size);
+        seg.data = nullptr;
+    }
+    if (seg.fd >= 0) {
+        // drop the unwritten zeros
+        (void) ::ftruncate(seg.fd, static_cast<off_t>(seg.used));
+        ::close(seg.fd);
+        seg.fd = -1;
+    }
+}
+
+void rotating_file_sink::discard_segment(segment& seg) {
+    finish_segment(seg);
+    ::unlink(seg.path.c_str());
+}
+
+void rotating_file_sink::apply_retention(bool closed) {
+    if (_opts.max_files == 0 && _opts.max_total_bytes == 0) {
+        return;
+    }
+
+    std::uint64_t active;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        active = _active_sequence;
+    }
+
+    auto files = list_segments(_opts.directory, _opts.base_name);
+    files.erase(std::remove_if(files.begin(), files.end(), [active](auto const& f) { return f.sequence >= active; }),
+                files.end());
+
+    // the segment that is still written counts with its full size
+    std::size_t count = files.size() + (closed ? 0 : 1);
+    std::uint64_t total = closed ? 0 : _opts.segment_size;
+    for (auto const& file : files) {
+        total += file.size;
+    }
+
+    std::error_code ec;
+    for (auto const& file : files) {
+        bool too_many = _opts.max_files && count > _opts.max_files;
+        bool too_large = _opts.max_total_bytes && total > _opts.max_total_bytes;
+        if (!too_many && !too_large) {
+            break;
+        }
+        fs::remove(file.path, ec);
+        --count;
+        total -= file.size;
+    }
+}
+
+void rotating_file_sink::background() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        if (!_finished.empty()) {
+            auto finished = std::move(_finished);
+            _finished.clear();
+            lock.unlock();
+            for (auto& seg : finished) {
+                finish_segment(*seg);
+            }
+            try {
+                apply_retention(false);
+            } catch (...) {
+            }
+            lock.lock();
+            continue;
+        }
+
+        if (_stop) {
+            break;
+        }
+
+        if (!_prepared) {
+            auto sequence = _next_sequence++;
+            lock.unlock();
+            std::unique_ptr<segment> seg;
+            try {
+                seg = create_segment(sequence);
+            } catch (...) {
+                // the writer creates the segment when it needs one
+            }
+            lock.lock();
+            if (seg) {
+                _prepared = std::move(seg);
+                continue;
+            }
+        }
+
+        _wake.wait(lock);
+    }
+}
+
+}} // namespace ext::logging
+#endif // _WIN32
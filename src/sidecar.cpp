@@ -0,0 +1,243 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#ifndef _WIN32
+#include <ext/logging/sidecar.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#include <ext/logging/functionality.hpp>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ext { namespace logging { namespace sidecar {
+namespace {
+constexpr int bloom_probes = 3;
+
+// double hashing - the upper half of the hash is the step
+template<std::size_t Bits>
+void bloom_insert(std::uint8_t (&bloom)[Bits / 8], std::uint64_t hash) noexcept {
+    auto const step = (hash >> 32) | 1;
+    for (int i = 0; i < bloom_probes; ++i) {
+        auto const bit = (hash + static_cast<std::uint64_t>(i) * step) & (Bits - 1);
+        bloom[bit / 8] |= static_cast<std::uint8_t>(1u << (bit % 8));
+    }
+}
+
+template<std::size_t Bits>
+bool bloom_contains(std::uint8_t const (&bloom)[Bits / 8], std::uint64_t hash) noexcept {
+    auto const step = (hash >> 32) | 1;
+    for (int i = 0; i < bloom_probes; ++i) {
+        auto const bit = (hash + static_cast<std::uint64_t>(i) * step) & (Bits - 1);
+        if (!(bloom[bit / 8] & (1u << (bit % 8)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<std::size_t Bits>
+bool bloom_contains_any(std::uint8_t const (&bloom)[Bits / 8], std::vector<std::uint64_t> const& hashes) noexcept {
+    return hashes.empty() || std::any_of(hashes.begin(), hashes.end(), [&bloom](std::uint64_t hash) {
+               return bloom_contains<Bits>(bloom, hash);
+           });
+}
+
+std::uint32_t level_bit(level level_) noexcept {
+    return 1u << std::min(static_cast<int>(level_) / 20, 30);
+}
+
+template<typename T>
+void put(char*& out, T const& value) noexcept {
+    std::memcpy(out, &value, sizeof(T));
+    out += sizeof(T);
+}
+
+template<typename T>
+void get(char const*& in, T& value) noexcept {
+    std::memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+}
+
+void write_all(int fd, char const* data, std::size_t size) {
+    while (size > 0) {
+        auto written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "ext::logging - can not write index");
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+} // namespace
+
+bool parse_line(std::string_view line, line_fields& out) noexcept {
+    using namespace std::literals::string_view_literals;
+    static constexpr std::string_view levels[] = {"fatal"sv, "error"sv, "warning"sv, "info"sv, "debug"sv, "trace"sv};
+
+    // the line head (time, thread) comes before the id
+    for (auto open = line.find('['); open != std::string_view::npos; open = line.find('[', open + 1)) {
+        auto const close = line.find(']', open + 1);
+        if (close == std::string_view::npos) {
+            return false;
+        }
+        if (close + 1 >= line.size() || line[close + 1] != ' ') {
+            continue;
+        }
+        auto rest = line.substr(close + 2);
+        for (std::size_t i = 0; i < std::size(levels); ++i) {
+            auto const& name = levels[i];
+            if (rest.substr(0, name.size()) != name || (rest.size() > name.size() && rest[name.size()] != ' ' &&
+                                                        rest[name.size()] != ':')) {
+                continue;
+            }
+            out.id = line.substr(open + 1, close - open - 1);
+            out.level_ = static_cast<level>(i * 20);
+            out.topic = {};
+            rest.remove_prefix(name.size());
+            if (rest.substr(0, 2) == " ("sv) {
+                auto const end = rest.find(')');
+                if (end != std::string_view::npos) {
+                    out.topic = rest.substr(2, end - 2);
+                }
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool may_match(block_entry const& entry, query const& q) noexcept {
+    if (entry.last < q.from || entry.first > q.to) {
+        return false;
+    }
+    if (entry.levels & unindexed) {
+        return true;
+    }
+    // all levels as severe as `max_level` or more
+    auto const levels = (level_bit(q.max_level) << 1) - 1;
+    return (entry.levels & levels) && bloom_contains_any<id_bloom_bits>(entry.ids, q.ids) &&
+           bloom_contains_any<topic_bloom_bits>(entry.topics, q.topics);
+}
+
+bool matches(line_fields const& fields, query const& q) noexcept {
+    if (fields.level_ > q.max_level) {
+        return false;
+    }
+    auto const wanted = [](std::vector<std::uint64_t> const& hashes, std::string_view value) {
+        return hashes.empty() || std::find(hashes.begin(), hashes.end(), id_hash(value)) != hashes.end();
+    };
+    return wanted(q.ids, fields.id) && (q.topics.empty() || (!fields.topic.empty() && wanted(q.topics, fields.topic)));
+}
+
+bool read(std::string const& path, std::vector<block_entry>& entries) {
+    entries.clear();
+    std::ifstream in(path, std::ios::binary);
+    std::string const content{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    if (content.compare(0, sizeof(magic) - 1, magic) != 0) {
+        return false;
+    }
+
+    // an incomplete entry at the end is still being written
+    for (auto pos = sizeof(magic) - 1; pos + entry_size <= content.size(); pos += entry_size) {
+        char const* in_entry = content.data() + pos;
+        block_entry entry;
+        get(in_entry, entry.offset);
+        get(in_entry, entry.size);
+        get(in_entry, entry.first);
+        get(in_entry, entry.last);
+        get(in_entry, entry.records);
+        get(in_entry, entry.levels);
+        get(in_entry, entry.topics);
+        get(in_entry, entry.ids);
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+writer::writer(std::string const& path, std::uint64_t offset, std::size_t block_records)
+    : _fd(-1), _block_records(std::max<std::size_t>(block_records, 1)), _end(offset) {
+    auto const index_path = path + ".idx";
+    _fd = ::open(index_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (_fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "ext::logging - can not open: " + index_path);
+    }
+    struct ::stat info;
+    if (::fstat(_fd, &info) == 0 && info.st_size == 0) {
+        try {
+            write_all(_fd, magic, sizeof(magic) - 1);
+        } catch (...) {
+            ::close(_fd);
+            throw;
+        }
+    }
+    _entry.offset = offset;
+}
+
+writer::~writer() {
+    ::close(_fd);
+}
+
+bool writer::add(record const& rec) {
+    auto const now = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count());
+    if (_entry.records == 0) {
+        _entry.first = now;
+    }
+    _entry.last = now;
+    ++_entry.records;
+    _end += rec.text.size();
+    _entry.levels |= level_bit(rec.level_);
+
+    if (rec.site) {
+        bloom_insert<id_bloom_bits>(_entry.ids, rec.site->hash);
+        if (rec.site->topic->id != topic::no_topic.id) {
+            bloom_insert<topic_bloom_bits>(_entry.topics, id_hash(rec.site->topic->name));
+        }
+    } else if (line_fields fields; parse_line(rec.text, fields)) {
+        bloom_insert<id_bloom_bits>(_entry.ids, id_hash(fields.id));
+        if (!fields.topic.empty()) {
+            bloom_insert<topic_bloom_bits>(_entry.topics, id_hash(fields.topic));
+        }
+    } else {
+        _entry.levels |= unindexed;
+    }
+    return _entry.records >= _block_records;
+}
+
+void writer::finish_block() {
+    if (_entry.records == 0) {
+        return;
+    }
+    _entry.size = _end - _entry.offset;
+
+    char buffer[entry_size];
+    char* out = buffer;
+    put(out, _entry.offset);
+    put(out, _entry.size);
+    put(out, _entry.first);
+    put(out, _entry.last);
+    put(out, _entry.records);
+    put(out, _entry.levels);
+    put(out, _entry.topics);
+    put(out, _entry.ids);
+    write_all(_fd, buffer, sizeof(buffer));
+
+    _entry = block_entry{};
+    _entry.offset = _end;
+}
+
+}}} // namespace ext::logging::sidecar
+#endif // _WIN32
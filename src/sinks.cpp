@@ -0,0 +1,361 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <ext/logging/functionality.hpp>
+#include <ext/logging/sidecar.hpp>
+#include <ext/logging/sinks.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <climits>
+    #include <fcntl.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif // _WIN32
+
+namespace ext { namespace logging {
+
+void sink::write(record const* records, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        write(records[i]);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+void ostream_sink::write(record const& rec) {
+    _out.write(rec.text.data(), static_cast<std::streamsize>(rec.text.size())) << std::flush;
+}
+
+void ostream_sink::write(record const* records, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        _out.write(records[i].text.data(), static_cast<std::streamsize>(records[i].text.size()));
+    }
+    _out << std::flush;
+}
+
+void ostream_sink::flush() {
+    _out << std::flush;
+}
+
+#ifndef _WIN32
+/////////////////////////////////////////////////////////////////////////////
+namespace {
+void write_all(int fd, char const* data, std::size_t size) {
+    while (size > 0) {
+        auto written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "ext::logging - write failed");
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+#ifdef IOV_MAX
+constexpr std::size_t max_iovecs = IOV_MAX < 64 ? IOV_MAX : 64;
+#else
+constexpr std::size_t max_iovecs = 16;
+#endif
+
+// writes all iovecs - partially written vectors are adjusted and retried
+void writev_all(int fd, ::iovec* vecs, std::size_t count) {
+    while (count > 0) {
+        auto written = ::writev(fd, vecs, static_cast<int>(count));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "ext::logging - writev failed");
+        }
+        auto rest = static_cast<std::size_t>(written);
+        while (count > 0 && rest >= vecs->iov_len) {
+            rest -= vecs->iov_len;
+            ++vecs;
+            --count;
+        }
+        if (count > 0) {
+            vecs->iov_base = static_cast<char*>(vecs->iov_base) + rest;
+            vecs->iov_len -= rest;
+        }
+    }
+}
+} // namespace
+
+fd_sink::fd_sink(int fd, bool close_on_destruction) noexcept : _fd(fd), _close(close_on_destruction) {}
+
+fd_sink::fd_sink(std::string const& path) : _fd(-1), _close(true) {
+    _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (_fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "ext::logging - can not open: " + path);
+    }
+}
+
+fd_sink::~fd_sink() {
+    if (_close && _fd >= 0) {
+        ::close(_fd);
+    }
+}
+
+void fd_sink::write(record const& rec) {
+    write_all(_fd, rec.text.data(), rec.text.size());
+}
+
+void fd_sink::write(record const* records, std::size_t count) {
+    ::iovec vecs[max_iovecs];
+    while (count > 0) {
+        std::size_t batch = std::min(count, max_iovecs);
+        for (std::size_t i = 0; i < batch; ++i) {
+            vecs[i].iov_base = const_cast<char*>(records[i].text.data());
+            vecs[i].iov_len = records[i].text.size();
+        }
+        writev_all(_fd, vecs, batch);
+        records += batch;
+        count -= batch;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+file_sink::file_sink(std::string const& path, std::size_t buffer_size, level flush_level, std::size_t index_every)
+    : _file(path), _buffer(std::max<std::size_t>(buffer_size, 1)), _used(0), _flush_level(flush_level) {
+    if (index_every) {
+        auto const offset = std::max<off_t>(::lseek(_file.fd(), 0, SEEK_END), 0);
+        _index = std::make_unique<sidecar::writer>(path, static_cast<std::uint64_t>(offset), index_every);
+    }
+}
+
+file_sink::~file_sink() {
+    try {
+        flush();
+        if (_index) {
+            _index->finish_block();
+        }
+    } catch (...) {
+    }
+}
+
+void file_sink::write(record const& rec) {
+    auto const& text = rec.text;
+    if (_used + text.size() > _buffer.size()) {
+        flush();
+    }
+
+    if (text.size() >= _buffer.size()) {
+        _file.write(rec);
+    } else {
+        std::memcpy(_buffer.data() + _used, text.data(), text.size());
+        _used += text.size();
+    }
+
+    if (_index && _index->add(rec)) {
+        // the entry must not describe records that are not in the file yet
+        flush();
+        _index->finish_block();
+    } else if (rec.level_ <= _flush_level) {
+        flush();
+    }
+}
+
+void file_sink::flush() {
+    if (_used) {
+        write_all(_file.fd(), _buffer.data(), _used);
+        _used = 0;
+    }
+}
+#endif // _WIN32
+
+/////////////////////////////////////////////////////////////////////////////
+void fanout_sink::add(std::shared_ptr<sink> target, level max_level) {
+    _children.push_back({std::move(target), max_level});
+}
+
+void fanout_sink::write(record const& rec) {
+    for (auto& entry : _children) {
+        if (rec.level_ <= entry.max_level) {
+            entry.target->write(rec);
+        }
+    }
+}
+
+void fanout_sink::write(record const* records, std::size_t count) {
+    constexpr std::size_t chunk_size = 64;
+    record selected[chunk_size];
+
+    for (auto& entry : _children) {
+        std::size_t used = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (records[i].level_ <= entry.max_level) {
+                selected[used++] = records[i];
+                if (used == chunk_size) {
+                    entry.target->write(selected, used);
+                    used = 0;
+                }
+            }
+        }
+        if (used) {
+            entry.target->write(selected, used);
+        }
+    }
+}
+
+void fanout_sink::flush() {
+    for (auto& entry : _children) {
+        entry.target->flush();
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+namespace {
+// FNV-1a
+std::uint64_t hash_text(std::string_view text) noexcept {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string_view payload_of(record const& rec) noexcept {
+    return rec.text.substr(std::min<std::size_t>(rec.payload, rec.text.size()));
+}
+} // namespace
+
+coalescing_sink::coalescing_sink(std::shared_ptr<sink> target, std::chrono::milliseconds window, match match_)
+    : _target(std::move(target)), _window(window), _match(match_) {
+    _timer = std::thread([this] { timer(); });
+}
+
+coalescing_sink::~coalescing_sink() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_one();
+    _timer.join();
+    try {
+        write_summary();
+        _target->flush();
+    } catch (...) {
+    }
+}
+
+void coalescing_sink::timer() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stop) {
+        if (_repeated == 0) {
+            _wake.wait(lock);
+        } else if (std::chrono::steady_clock::now() - _first < _window) {
+            _wake.wait_until(lock, _first + _window);
+        } else {
+            // the target is called under `logmutex` like by the logging threads -
+            // taken first, so the burst may have changed meanwhile
+            lock.unlock();
+            std::lock_guard<std::mutex> log_lock(_detail::logmutex);
+            lock.lock();
+            if (_stop || _repeated == 0 || std::chrono::steady_clock::now() - _first < _window) {
+                continue;
+            }
+            try {
+                write_summary();
+                _target->flush();
+            } catch (...) {
+                _repeated = 0; // nobody to tell
+            }
+            _site = nullptr;
+        }
+    }
+}
+
+bool coalescing_sink::repeated(record const& rec, std::chrono::steady_clock::time_point now) const {
+    if (_site == nullptr || rec.site != _site || rec.level_ == level::fatal || now - _first >= _window) {
+        return false;
+    }
+    return _match == match::site || hash_text(payload_of(rec)) == _hash;
+}
+
+void coalescing_sink::start(record const& rec, std::chrono::steady_clock::time_point now) {
+    if (rec.site == nullptr || rec.level_ == level::fatal) {
+        _site = nullptr;
+        return;
+    }
+    _site = rec.site;
+    _hash = _match == match::site ? 0 : hash_text(payload_of(rec));
+    _level = rec.level_;
+    _first = now;
+}
+
+void coalescing_sink::write_summary() {
+    if (_repeated == 0) {
+        return;
+    }
+    auto const payload =
+        _detail::note_line(*_site, "last message repeated " + std::to_string(_repeated) + " times", _summary);
+    _repeated = 0;
+    _target->write(record{_level, _summary, _site, payload});
+}
+
+void coalescing_sink::write(record const& rec) {
+    auto const now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (repeated(rec, now)) {
+        if (_repeated++ == 0) {
+            _wake.notify_one(); // the timer waits for the end of the window
+        }
+        return;
+    }
+    write_summary();
+    _target->write(rec);
+    start(rec, now);
+}
+
+void coalescing_sink::write(record const* records, std::size_t count) {
+    constexpr std::size_t chunk_size = 64;
+    record selected[chunk_size];
+    std::size_t used = 0;
+
+    auto const now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto const& rec = records[i];
+        if (repeated(rec, now)) {
+            if (_repeated++ == 0) {
+                _wake.notify_one();
+            }
+            continue;
+        }
+        if (_repeated) {
+            // the summary goes between the burst and this record
+            if (used) {
+                _target->write(selected, used);
+                used = 0;
+            }
+            write_summary();
+        }
+        selected[used++] = rec;
+        start(rec, now);
+        if (used == chunk_size) {
+            _target->write(selected, used);
+            used = 0;
+        }
+    }
+    if (used) {
+        _target->write(selected, used);
+    }
+}
+
+void coalescing_sink::flush() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_repeated && std::chrono::steady_clock::now() - _first >= _window) {
+        write_summary();
+        _site = nullptr;
+    }
+    _target->flush();
+}
+
+}} // namespace ext::logging
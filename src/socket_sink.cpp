@@ -0,0 +1,242 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#ifndef _WIN32
+#include <ext/logging/socket_sink.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0 // SO_NOSIGPIPE is set instead
+#endif
+
+namespace ext { namespace logging {
+namespace {
+constexpr std::size_t max_datagrams = 64; // per sendmmsg
+
+bool would_block(int error) noexcept {
+    return error == EAGAIN || error == EWOULDBLOCK || error == ENOBUFS;
+}
+} // namespace
+
+socket_sink::socket_sink(options opts) : _opts(std::move(opts)) {
+    if (_opts.path.size() >= sizeof(::sockaddr_un::sun_path)) {
+        throw std::system_error(
+            ENAMETOOLONG, std::generic_category(), "ext::logging - socket path too long: " + _opts.path);
+    }
+    _opts.batch_size = std::max<std::size_t>(_opts.batch_size, 1);
+    _buffer.reserve(std::min(_opts.batch_size, _opts.buffer_size));
+    connect();
+}
+
+socket_sink::~socket_sink() {
+    try {
+        flush();
+    } catch (...) {
+    }
+    disconnect();
+}
+
+bool socket_sink::connect() {
+    auto const now = std::chrono::steady_clock::now();
+    if (now < _next_connect) {
+        return false;
+    }
+    _next_connect = now + _opts.retry_interval;
+
+    int const fd = ::socket(AF_UNIX, _opts.type == socket_type::stream ? SOCK_STREAM : SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+    int const on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+    ::sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, _opts.path.data(), _opts.path.size());
+    if (::connect(fd, reinterpret_cast<::sockaddr const*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return false;
+    }
+    _fd = fd;
+    _connects.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void socket_sink::disconnect() noexcept {
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+    // a record sent in part is sent again on the next connection
+    auto const done = std::upper_bound(_ends.begin(), _ends.end(), _sent);
+    _sent = done == _ends.begin() ? 0 : *(done - 1);
+}
+
+void socket_sink::append(record const& rec) {
+    auto const size = rec.text.size();
+    if (_buffer.size() + size > _opts.buffer_size) {
+        send();
+        compact();
+        if (_buffer.size() + size > _opts.buffer_size) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    _buffer.insert(_buffer.end(), rec.text.begin(), rec.text.end());
+    _ends.push_back(_buffer.size());
+}
+
+void socket_sink::write(record const& rec) {
+    write(&rec, 1);
+}
+
+void socket_sink::write(record const* records, std::size_t count) {
+    bool urgent = false;
+    for (std::size_t i = 0; i < count; ++i) {
+        append(records[i]);
+        urgent = urgent || records[i].level_ <= _opts.flush_level;
+    }
+    // urgent records are sent at once but never waited for - the caller may
+    // hold `logmutex`, only `flush` and the destructor wait
+    if (urgent || pending() >= _opts.batch_size) {
+        send();
+        compact();
+    }
+}
+
+void socket_sink::flush() {
+    auto const deadline = std::chrono::steady_clock::now() + _opts.flush_timeout;
+    while (!send()) {
+        auto const now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            break;
+        }
+        // the collector is away - wait for the next attempt
+        auto const until = _fd >= 0 ? deadline : std::max(std::min(_next_connect, deadline), now);
+        auto const wait = std::chrono::duration_cast<std::chrono::milliseconds>(until - now).count() + 1;
+        ::pollfd writable{_fd, POLLOUT, 0};
+        ::poll(&writable, _fd >= 0 ? 1 : 0, static_cast<int>(wait));
+    }
+    compact();
+}
+
+bool socket_sink::send() {
+    if (pending() == 0) {
+        return true;
+    }
+    if (_fd < 0 && !connect()) {
+        return false;
+    }
+    return _opts.type == socket_type::stream ? send_stream() : send_datagrams();
+}
+
+bool socket_sink::send_stream() {
+    auto const before = std::upper_bound(_ends.begin(), _ends.end(), _sent) - _ends.begin();
+    while (_sent < _buffer.size()) {
+        auto const sent = ::send(_fd, _buffer.data() + _sent, _buffer.size() - _sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (!would_block(errno)) {
+                disconnect(); // EPIPE, ECONNRESET, ... - reconnect later
+            }
+            break;
+        }
+        _sends.fetch_add(1, std::memory_order_relaxed);
+        _sent += static_cast<std::size_t>(sent);
+    }
+    auto const after = std::upper_bound(_ends.begin(), _ends.end(), _sent) - _ends.begin();
+    _records.fetch_add(static_cast<std::uint64_t>(after - before), std::memory_order_relaxed);
+    return _sent == _buffer.size();
+}
+
+bool socket_sink::send_datagrams() {
+    // `_sent` is always the end of a record
+    auto next = static_cast<std::size_t>(std::upper_bound(_ends.begin(), _ends.end(), _sent) - _ends.begin());
+    while (next < _ends.size()) {
+#ifdef __linux__
+        ::mmsghdr messages[max_datagrams];
+        ::iovec vecs[max_datagrams];
+        auto const batch = std::min(_ends.size() - next, max_datagrams);
+        auto begin = _sent;
+        for (std::size_t i = 0; i < batch; ++i) {
+            vecs[i].iov_base = _buffer.data() + begin;
+            vecs[i].iov_len = _ends[next + i] - begin;
+            messages[i] = {};
+            messages[i].msg_hdr.msg_iov = &vecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            begin = _ends[next + i];
+        }
+        auto const sent = ::sendmmsg(_fd, messages, static_cast<unsigned>(batch), MSG_DONTWAIT | MSG_NOSIGNAL);
+#else
+        auto const begin = _sent;
+        auto const size = _ends[next] - begin;
+        auto const sent = ::send(_fd, _buffer.data() + begin, size, MSG_DONTWAIT | MSG_NOSIGNAL) < 0 ? -1 : 1;
+#endif
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EMSGSIZE) {
+                // never fits - skip the record
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                _sent = _ends[next++];
+                continue;
+            }
+            if (!would_block(errno)) {
+                disconnect();
+            }
+            break;
+        }
+        if (sent == 0) {
+            break;
+        }
+        _sends.fetch_add(1, std::memory_order_relaxed);
+        _records.fetch_add(static_cast<std::uint64_t>(sent), std::memory_order_relaxed);
+        next += static_cast<std::size_t>(sent);
+        _sent = _ends[next - 1];
+    }
+    return next == _ends.size();
+}
+
+void socket_sink::compact() noexcept {
+    auto const done = std::upper_bound(_ends.begin(), _ends.end(), _sent);
+    if (done == _ends.begin()) {
+        return;
+    }
+    auto const bytes = *(done - 1);
+    _buffer.erase(_buffer.begin(), _buffer.begin() + static_cast<std::ptrdiff_t>(bytes));
+    _ends.erase(_ends.begin(), done);
+    for (auto& end : _ends) {
+        end -= bytes;
+    }
+    _sent -= bytes;
+}
+
+socket_sink::statistics socket_sink::stats() const noexcept {
+    statistics result;
+    result.records = _records.load(std::memory_order_relaxed);
+    result.sends = _sends.load(std::memory_order_relaxed);
+    result.dropped = _dropped.load(std::memory_order_relaxed);
+    result.connects = _connects.load(std::memory_order_relaxed);
+    return result;
+}
+
+}} // namespace ext::logging
+#endif // _WIN32
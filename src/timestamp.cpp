@@ -0,0 +1,104 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <ext/logging/functionality.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+namespace ext { namespace logging {
+namespace {
+struct wall_time {
+    std::time_t seconds;
+    std::uint32_t nanoseconds;
+};
+
+wall_time now() noexcept {
+#if defined(__linux__) && defined(CLOCK_REALTIME_COARSE)
+    timespec ts;
+    clock_gettime(configuration::coarse_clock ? CLOCK_REALTIME_COARSE : CLOCK_REALTIME, &ts);
+    return {ts.tv_sec, static_cast<std::uint32_t>(ts.tv_nsec)};
+#else
+    auto const since_epoch =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    return {static_cast<std::time_t>(since_epoch / 1000000000), static_cast<std::uint32_t>(since_epoch % 1000000000)};
+#endif
+}
+
+// writes `value` with exactly `digits` digits
+void put_digits(char* out, std::uint32_t value, int digits) noexcept {
+    for (int i = digits - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+// "YYYY-MM-DD HH:MM:SS" of the last second a thread logged in
+struct second_cache {
+    static constexpr std::size_t size = 19;
+
+    std::time_t second = -1;
+    bool utc = true;
+    char text[size];
+
+    void update(std::time_t now, bool utc_) noexcept {
+        std::tm parts{};
+#ifdef _WIN32
+        utc_ ? gmtime_s(&parts, &now) : localtime_s(&parts, &now);
+#else
+        utc_ ? gmtime_r(&now, &parts) : localtime_r(&now, &parts);
+#endif
+        put_digits(text, static_cast<std::uint32_t>(parts.tm_year + 1900), 4);
+        text[4] = '-';
+        put_digits(text + 5, static_cast<std::uint32_t>(parts.tm_mon + 1), 2);
+        text[7] = '-';
+        put_digits(text + 8, static_cast<std::uint32_t>(parts.tm_mday), 2);
+        text[10] = ' ';
+        put_digits(text + 11, static_cast<std::uint32_t>(parts.tm_hour), 2);
+        text[13] = ':';
+        put_digits(text + 14, static_cast<std::uint32_t>(parts.tm_min), 2);
+        text[16] = ':';
+        put_digits(text + 17, static_cast<std::uint32_t>(parts.tm_sec), 2);
+        second = now;
+        utc = utc_;
+    }
+};
+} // namespace
+
+std::size_t _detail::format_timestamp(char (&out)[timestamp_max_size]) noexcept {
+    int digits;
+    std::uint32_t divisor;
+    switch (configuration::timestamp) {
+        case timestamp_precision::milliseconds:
+            digits = 3;
+            divisor = 1000000;
+            break;
+        case timestamp_precision::microseconds:
+            digits = 6;
+            divisor = 1000;
+            break;
+        case timestamp_precision::nanoseconds:
+            digits = 9;
+            divisor = 1;
+            break;
+        default:
+            return 0;
+    }
+
+    thread_local second_cache cache;
+    auto const current = now();
+    bool const utc = configuration::utc.load(std::memory_order_relaxed);
+    if (current.seconds != cache.second || utc != cache.utc) {
+        cache.update(current.seconds, utc);
+    }
+
+    std::memcpy(out, cache.text, second_cache::size);
+    out[second_cache::size] = '.';
+    put_digits(out + second_cache::size + 1, current.nanoseconds / divisor, digits);
+    auto const size = second_cache::size + 1 + static_cast<std::size_t>(digits);
+    out[size] = ' ';
+    return size + 1;
+}
+
+}} // namespace ext::logging
@@ -0,0 +1,192 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <ext/logging/functionality.hpp>
+#include <ext/logging/topics.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ext { namespace logging {
+// constant initialized - usable while globals are constructed
+_detail::logtopic* _detail::topics[_detail::max_topics] = {};
+std::size_t _detail::topics_end = 0;
+
+namespace {
+// configured levels of topics that do not exist yet - guarded by `logmutex`
+struct configured_level {
+    std::string name; // `*` for every topic
+    level level_;
+};
+std::vector<configured_level>* configured = nullptr;
+
+void apply_configured(_detail::logtopic& topic) noexcept {
+    if (!configured) {
+        return;
+    }
+    // the entry naming the topic wins over `*`
+    level const* named = nullptr;
+    level const* every = nullptr;
+    for (auto const& entry : *configured) {
+        if (entry.name == topic.name) {
+            named = &entry.level_;
+        } else if (entry.name == "*") {
+            every = &entry.level_;
+        }
+    }
+    if (named || every) {
+        set_level(topic, named ? *named : *every);
+    }
+}
+
+void insert(_detail::logtopic& topic) noexcept {
+    auto const id = static_cast<std::size_t>(topic.id);
+    _detail::topics[id] = &topic;
+    _detail::topics_end = std::max(_detail::topics_end, id + 1);
+    apply_configured(topic);
+}
+
+_detail::logtopic* find_locked(std::string_view name) noexcept {
+    for (std::size_t id = 0; id < _detail::topics_end; ++id) {
+        if (auto* topic = _detail::topics[id]; topic && topic->name == name) {
+            return topic;
+        }
+    }
+    return nullptr;
+}
+} // namespace
+
+void _detail::add_topic(logtopic& topic) noexcept {
+    if (topic.id < 0 || static_cast<std::size_t>(topic.id) >= max_topics) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(logmutex);
+    insert(topic);
+}
+
+_detail::logtopic& register_topic(std::string_view name, level level_) {
+    std::lock_guard<std::mutex> lock(_detail::logmutex);
+    if (auto* topic = find_locked(name)) {
+        return *topic;
+    }
+
+    // id 0 is not used by the built in topics - leave it to the user as well
+    std::size_t id = 1;
+    while (id < _detail::max_topics && _detail::topics[id]) {
+        ++id;
+    }
+    if (id == _detail::max_topics) {
+        return topic::no_topic;
+    }
+
+    // a negative id is not registered by the constructor - leaked on purpose
+    auto* topic = new _detail::logtopic(-1, std::string(name), level_);
+    topic->id = static_cast<int>(id);
+    insert(*topic);
+    return *topic;
+}
+
+_detail::logtopic* find_topic(std::string_view name) noexcept {
+    std::lock_guard<std::mutex> lock(_detail::logmutex);
+    return find_locked(name);
+}
+
+_detail::logtopic* find_topic(int id) noexcept {
+    if (id < 0 || static_cast<std::size_t>(id) >= _detail::max_topics) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(_detail::logmutex);
+    return _detail::topics[id];
+}
+
+bool level_from_str(std::string_view text, level& out) noexcept {
+    for (auto candidate : {level::fatal, level::error, level::warn, level::info, level::debug, level::trace}) {
+        if (text == _detail::level_to_str(candidate)) {
+            out = candidate;
+            return true;
+        }
+    }
+    if (text == "warn") {
+        out = level::warn;
+        return true;
+    }
+
+    int number = 0;
+    auto const end = text.data() + text.size();
+    auto const result = std::from_chars(text.data(), end, number);
+    if (text.empty() || result.ec != std::errc{} || result.ptr != end || number < 0) {
+        return false;
+    }
+    out = static_cast<level>(number);
+    return true;
+}
+
+void _detail::configure_level(std::string_view name, level level_) {
+    std::lock_guard<std::mutex> lock(logmutex);
+    if (!configured) {
+        configured = new std::vector<configured_level>(); // leaked like the topics
+    }
+    if (name == "*") {
+        // later entries for single topics still win
+        configured->clear();
+        for (std::size_t id = 0; id < topics_end; ++id) {
+            if (auto* topic = topics[id]) {
+                set_level(*topic, level_);
+            }
+        }
+    } else if (auto* topic = find_locked(name)) {
+        set_level(*topic, level_);
+    }
+    auto it = std::find_if(configured->begin(), configured->end(), [name](configured_level const& known) {
+        return known.name == name;
+    });
+    if (it == configured->end()) {
+        configured->push_back({std::string(name), level_});
+    } else {
+        it->level_ = level_;
+    }
+}
+
+bool configure_levels(std::string_view entries) {
+    return _detail::for_each_entry(entries, [](std::string_view name, std::string_view value) {
+        level level_ = level::info;
+        if (!level_from_str(value, level_)) {
+            return false;
+        }
+        _detail::configure_level(name, level_);
+        return true;
+    });
+}
+
+bool configure_levels_from_env(char const* variable) {
+    char const* value = std::getenv(variable);
+    return value ? configure_levels(value) : true;
+}
+
+void clear_configured_levels() noexcept {
+    std::lock_guard<std::mutex> lock(_detail::logmutex);
+    if (configured) {
+        configured->clear();
+    }
+}
+
+bool configure_levels_from_file(std::string const& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string const content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    return configure_levels(content);
+}
+
+namespace {
+// topics constructed later get their level on registration
+bool const levels_from_env = configure_levels_from_env();
+} // namespace
+
+}} // namespace ext::logging
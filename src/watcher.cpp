@@ -0,0 +1,343 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <ext/logging/functionality.hpp>
+#include <ext/logging/topics.hpp>
+#include <ext/logging/watcher.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <csignal>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #ifdef __linux__
+        #include <sys/inotify.h>
+    #endif // __linux__
+#endif     // _WIN32
+
+namespace ext { namespace logging {
+namespace {
+bool bool_from_str(std::string_view text, bool& out) noexcept {
+    if (text == "true" || text == "on" || text == "yes" || text == "1") {
+        out = true;
+        return true;
+    }
+    if (text == "false" || text == "off" || text == "no" || text == "0") {
+        out = false;
+        return true;
+    }
+    return false;
+}
+
+std::atomic<bool>* find_flag(std::string_view name) noexcept {
+    if (name == "prefix_newline") {
+        return &configuration::prefix_newline;
+    } else if (name == "append_newline") {
+        return &configuration::append_newline;
+    } else if (name == "threads") {
+        return &configuration::threads;
+    } else if (name == "filename") {
+        return &configuration::filename;
+    } else if (name == "function") {
+        return &configuration::function;
+    } else if (name == "utc") {
+        return &configuration::utc;
+    }
+    return nullptr;
+}
+
+// serializes writers - readers only use the sequence
+std::mutex update_mutex;
+} // namespace
+
+bool apply_configuration(std::string_view entries) {
+    using namespace std::literals::string_view_literals;
+    struct flag_update {
+        std::atomic<bool>* flag;
+        bool value;
+    };
+    std::vector<flag_update> flags;
+    std::vector<std::pair<std::string_view, bool>> ids;
+    std::vector<std::pair<std::string_view, level>> levels;
+
+    // collected first so the flags change together - entries that can not be
+    // parsed are skipped, the others are applied
+    bool const parsed = _detail::for_each_entry(entries, [&](std::string_view name, std::string_view value) {
+        bool on = false;
+        if (name.substr(0, 3) == "id."sv) {
+            if (name.size() == 3 || !bool_from_str(value, on)) {
+                return false;
+            }
+            ids.emplace_back(name.substr(3), on);
+        } else if (name.substr(0, 7) == "option."sv) {
+            auto* flag = find_flag(name.substr(7));
+            if (!flag || !bool_from_str(value, on)) {
+                return false;
+            }
+            flags.push_back({flag, on});
+        } else {
+            level level_ = level::info;
+            if (!level_from_str(value, level_)) {
+                return false;
+            }
+            levels.emplace_back(name, level_);
+        }
+        return true;
+    });
+
+    // levels and ids take effect one by one - only the flags are bracketed
+    std::lock_guard<std::mutex> lock(update_mutex);
+    if (!flags.empty()) {
+        // odd while the flags change - prefixes are built from the flags
+        // before or after the update (see `prefix_generation`)
+        auto& sequence = _detail::configuration_sequence;
+        sequence.fetch_add(1, std::memory_order_acq_rel);
+        for (auto const& update : flags) {
+            update.flag->store(update.value, std::memory_order_relaxed);
+        }
+        sequence.fetch_add(1, std::memory_order_release);
+    }
+    for (auto const& [id, on] : ids) {
+        set_enabled(id, on);
+    }
+    for (auto const& [name, level_] : levels) {
+        _detail::configure_level(name, level_);
+    }
+    return parsed;
+}
+
+#ifndef _WIN32
+/////////////////////////////////////////////////////////////////////////////
+namespace {
+// written by `stop`, `reload` and the signal handler - `q` stops the thread
+std::atomic<int> wake_fd{-1};
+
+void wake(char command) noexcept {
+    auto const fd = wake_fd.load(std::memory_order_acquire);
+    if (fd >= 0) {
+        // a full pipe has a reload pending anyway
+        auto const written = ::write(fd, &command, 1);
+        (void) written;
+    }
+}
+
+void on_sighup(int) {
+    auto const saved = errno;
+    wake('r');
+    errno = saved;
+}
+
+struct watcher_state {
+    // serializes start / stop
+    std::mutex control_mutex;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<std::uint64_t> reloads{0};
+
+    std::string path;
+    std::string file; // name of the file in its directory
+    watcher::options opts;
+    int pipe[2] = {-1, -1};
+    int inotify = -1;
+    bool sighup = false;
+    struct sigaction previous {};
+    struct stat last {}; // polled without inotify
+
+    bool apply() {
+        std::ifstream in(path);
+        if (!in) {
+            return false;
+        }
+        std::string const content{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        bool const parsed = apply_configuration(content);
+        reloads.fetch_add(1, std::memory_order_release);
+        return parsed;
+    }
+
+    // true if the file has been replaced or written since the last call
+    bool changed() noexcept {
+        struct stat now {};
+        if (::stat(path.c_str(), &now) != 0) {
+            return false;
+        }
+        bool const result = now.st_ino != last.st_ino || now.st_size != last.st_size || now.st_mtime != last.st_mtime;
+        last = now;
+        return result;
+    }
+
+    // true if an event of the inotify descriptor names our file
+    bool notified() noexcept {
+        bool result = false;
+    #ifdef __linux__
+        alignas(inotify_event) char buffer[4096];
+        for (;;) {
+            auto const size = ::read(inotify, buffer, sizeof(buffer));
+            if (size <= 0) {
+                break;
+            }
+            for (char* at = buffer; at < buffer + size;) {
+                auto const* event = reinterpret_cast<inotify_event const*>(at);
+                if (event->len && file == event->name) {
+                    result = true;
+                }
+                at += sizeof(inotify_event) + event->len;
+            }
+        }
+    #endif // __linux__
+        return result;
+    }
+
+    void run() {
+        ::pollfd fds[2] = {{pipe[0], POLLIN, 0}, {inotify, POLLIN, 0}};
+        nfds_t const count = inotify >= 0 ? 2 : 1;
+        int const timeout = inotify >= 0 ? -1 : static_cast<int>(opts.poll_interval.count());
+        for (;;) {
+            fds[0].revents = fds[1].revents = 0;
+            if (::poll(fds, count, timeout) < 0 && errno != EINTR) {
+                return;
+            }
+
+            bool reload = false;
+            if (fds[0].revents & POLLIN) {
+                char commands[64];
+                auto const size = ::read(pipe[0], commands, sizeof(commands));
+                for (ssize_t i = 0; i < size; ++i) {
+                    if (commands[i] == 'q') {
+                        return;
+                    }
+                    reload = true;
+                }
+            }
+            if (count == 2 && (fds[1].revents & POLLIN)) {
+                reload = notified() || reload;
+            } else if (count == 1) {
+                reload = changed() || reload;
+            }
+
+            if (reload) {
+                try {
+                    apply();
+                } catch (...) {
+                }
+            }
+        }
+    }
+
+    void close_all() noexcept {
+        auto close = [](int& fd) {
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        };
+        close(pipe[0]);
+        close(pipe[1]);
+        close(inotify);
+    }
+};
+
+watcher_state& state() {
+    // leaked - the thread is joined at exit
+    static watcher_state* instance = new watcher_state();
+    return *instance;
+}
+
+void stop_at_exit() {
+    watcher::stop();
+}
+
+void set_flags(int fd, int flags) {
+    ::fcntl(fd, F_SETFD, ::fcntl(fd, F_GETFD) | FD_CLOEXEC);
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | flags);
+}
+} // namespace
+
+bool watcher::start(std::string const& path, options const& opts) {
+    auto& s = state();
+    stop();
+    std::lock_guard<std::mutex> lock(s.control_mutex);
+    s.path = path;
+    s.opts = opts;
+    auto const slash = path.find_last_of('/');
+    s.file = slash == std::string::npos ? path : path.substr(slash + 1);
+
+    if (::pipe(s.pipe) != 0) {
+        throw std::system_error(errno, std::generic_category(), "ext::logging - can not create pipe");
+    }
+    set_flags(s.pipe[0], O_NONBLOCK);
+    set_flags(s.pipe[1], O_NONBLOCK);
+
+    #ifdef __linux__
+    // the directory is watched - editors and `mv` replace the file
+    s.inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    std::string const directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    if (s.inotify < 0 || ::inotify_add_watch(s.inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        auto const error = errno;
+        s.close_all();
+        throw std::system_error(error, std::generic_category(), "ext::logging - can not watch: " + directory);
+    }
+    #endif // __linux__
+
+    s.reloads.store(0, std::memory_order_relaxed);
+    s.changed();
+    bool const applied = s.apply();
+
+    static bool const registered = (std::atexit(stop_at_exit) == 0);
+    (void) registered;
+
+    wake_fd.store(s.pipe[1], std::memory_order_release);
+    s.sighup = opts.sighup;
+    if (s.sighup) {
+        struct sigaction action {};
+        action.sa_handler = on_sighup;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        ::sigaction(SIGHUP, &action, &s.previous);
+    }
+
+    s.running.store(true, std::memory_order_release);
+    s.thread = std::thread([&s] { s.run(); });
+    return applied;
+}
+
+void watcher::stop() {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.control_mutex);
+    if (!s.running.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    if (s.sighup) {
+        ::sigaction(SIGHUP, &s.previous, nullptr);
+        s.sighup = false;
+    }
+    wake('q');
+    s.thread.join();
+    wake_fd.store(-1, std::memory_order_release);
+    s.close_all();
+}
+
+bool watcher::active() noexcept {
+    return state().running.load(std::memory_order_acquire);
+}
+
+void watcher::reload() noexcept {
+    wake('r');
+}
+
+std::uint64_t watcher::reloads() noexcept {
+    return state().reloads.load(std::memory_order_acquire);
+}
+#endif // _WIN32
+
+}} // namespace ext::logging
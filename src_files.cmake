@@ -1,3 +1,20 @@
 set(ext-logging-source
     "src/logging.cpp"
+    "src/async.cpp"
+    "src/binary.cpp"
+    "src/compressed_sink.cpp"
+    "src/context.cpp"
+    "src/emergency.cpp"
+    "src/encoders.cpp"
+    "src/format.cpp"
+    "src/ids.cpp"
+    "src/metrics.cpp"
+    "src/recorder.cpp"
+    "src/sidecar.cpp"
+    "src/sinks.cpp"
+    "src/timestamp.cpp"
+    "src/topics.cpp"
+    "src/watcher.cpp"
+    "src/rotating_sink.cpp"
+    "src/socket_sink.cpp"
 )
@@ -0,0 +1,151 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+#include <streambuf>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+
+// Counts every allocation of the test executable while `counting` is set.
+namespace {
+std::atomic<bool> counting{false};
+std::atomic<std::size_t> allocations{0};
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+// gcc reports the free in an inlined delete as mismatching the new expression
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+namespace {
+struct null_buffer : std::streambuf {
+    int_type overflow(int_type ch) override {
+        return traits_type::not_eof(ch);
+    }
+    std::streamsize xsputn(char const*, std::streamsize count) override {
+        return count;
+    }
+};
+
+struct point {
+    int x, y;
+};
+
+std::ostream& operator<<(std::ostream& out, point const& p) {
+    return out << "(" << p.x << ", " << p.y << ")";
+}
+
+struct AllocationTest : public ::testing::Test {
+    AllocationTest() : _null_stream(&_null) {
+        using namespace ext::logging;
+        configuration::stream = &_null_stream;
+        set_level_all(level::EXT_LOGGING_DEFAULT_LEVEL);
+    }
+
+    ~AllocationTest() {
+        counting = false;
+        ext::logging::async::stop();
+        ext::logging::configuration::stream = &std::cout;
+    }
+
+    void log_some(int count) {
+        std::string_view long_text = "0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz";
+        for (int i = 0; i < count; ++i) {
+            EXT_LOG("cafe", network, error) << "message " << i << " " << 3.1415 << " " << point{i, -i};
+            EXT_LOG("babe") << long_text << long_text << long_text << long_text << long_text << long_text
+                            << long_text << long_text << long_text;
+            EXT_LOG("dead", info) << "suppressed";
+        }
+    }
+
+    std::size_t count_allocations(int messages) {
+        allocations = 0;
+        counting = true;
+        log_some(messages);
+        counting = false;
+        return allocations.load();
+    }
+
+    null_buffer _null;
+    std::ostream _null_stream;
+};
+} // namespace
+
+TEST_F(AllocationTest, steady_state_sync) {
+    log_some(1); // warm up the thread local buffer
+    EXPECT_EQ(count_allocations(1000), 0);
+}
+
+TEST_F(AllocationTest, steady_state_async) {
+    ext::logging::async::start({16, 16, ext::logging::async::full_policy::block});
+    log_some(100); // warm up the thread local buffer and the queue slots
+    ext::logging::async::flush();
+    EXPECT_EQ(count_allocations(1000), 0);
+    ext::logging::async::flush();
+}
+
+TEST_F(AllocationTest, steady_state_thread_and_context) {
+    using namespace ext::logging;
+    configuration::threads = true;
+    configuration::timestamp = timestamp_precision::microseconds;
+    set_thread_name("allocation");
+    log_some(1);
+
+    allocations = 0;
+    counting = true;
+    for (int i = 0; i < 100; ++i) {
+        context request("request", i);
+        context user("user", "some name");
+        log_some(10);
+    }
+    counting = false;
+    EXPECT_EQ(allocations.load(), 0);
+
+    configuration::threads = false;
+    configuration::timestamp = timestamp_precision::none;
+}
+
+TEST_F(AllocationTest, steady_state_structured) {
+    using namespace ext::logging;
+    for (auto format : {output_format::json, output_format::logfmt}) {
+        configuration::format = format;
+        auto log_fields = [](int count) {
+            for (int i = 0; i < count; ++i) {
+                EXT_LOG("cafe", network, error).kv("user", i).kv("latency_us", 0.5 * i).kv("name", "a \"name\"")
+                    << "message\twith " << i << " escapes";
+            }
+        };
+        log_fields(1);
+        log_some(1);
+
+        allocations = 0;
+        counting = true;
+        log_fields(100);
+        log_some(100);
+        counting = false;
+        EXPECT_EQ(allocations.load(), 0);
+    }
+    configuration::format = output_format::text;
+}
@@ -0,0 +1,155 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+
+using namespace std::literals;
+namespace el = ext::logging;
+
+struct AsyncLoggingTest : public ::testing::Test {
+    AsyncLoggingTest() : _log{} {
+        using namespace ext::logging;
+        configuration::stream = &_log;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = true;
+        configuration::filename = false;
+        configuration::function = false;
+        set_level_all(level::EXT_LOGGING_DEFAULT_LEVEL);
+    };
+
+    ~AsyncLoggingTest() {
+        el::async::stop();
+        el::configuration::stream = &std::cout;
+    }
+
+    std::stringstream _log;
+};
+using AsyncLoggingDeathTest = AsyncLoggingTest;
+
+TEST_F(AsyncLoggingTest, flush_writes_everything) {
+    el::async::start();
+    ASSERT_TRUE(el::async::active());
+    for (int i = 0; i < 100; ++i) {
+        EXT_LOG("cafe") << i;
+    }
+    el::async::flush();
+
+    std::string expected;
+    for (int i = 0; i < 100; ++i) {
+        expected += "[cafe] warning: '" + std::to_string(i) + "'\n";
+    }
+    EXPECT_EQ(expected, _log.str());
+
+    auto stats = el::async::stats();
+    EXPECT_EQ(stats.enqueued, 100);
+    EXPECT_EQ(stats.written, 100);
+    EXPECT_EQ(stats.dropped, 0);
+    EXPECT_EQ(stats.dropped_oldest, 0);
+}
+
+TEST_F(AsyncLoggingTest, stop_drains_queue) {
+    el::async::start();
+    {
+        // keep the writer from making progress
+        std::lock_guard<std::mutex> lock(el::_detail::logmutex);
+        EXT_LOG("cafe") << "queued";
+    }
+    el::async::stop();
+    EXPECT_FALSE(el::async::active());
+    EXPECT_EQ("[cafe] warning: 'queued'\n", _log.str());
+
+    // synchronous again
+    EXT_LOG("babe") << "direct";
+    EXPECT_EQ("[cafe] warning: 'queued'\n[babe] warning: 'direct'\n", _log.str());
+}
+
+TEST_F(AsyncLoggingTest, full_queue_drop) {
+    el::async::start({4, 16, el::async::full_policy::drop});
+    {
+        std::lock_guard<std::mutex> lock(el::_detail::logmutex);
+        for (int i = 0; i < 10; ++i) {
+            EXT_LOG("cafe") << i;
+        }
+    }
+    el::async::flush();
+
+    EXPECT_EQ("[cafe] warning: '0'\n[cafe] warning: '1'\n[cafe] warning: '2'\n[cafe] warning: '3'\n", _log.str());
+    auto stats = el::async::stats();
+    EXPECT_EQ(stats.enqueued, 4);
+    EXPECT_EQ(stats.dropped, 6);
+    EXPECT_EQ(stats.dropped_oldest, 0);
+}
+
+TEST_F(AsyncLoggingTest, full_queue_drop_oldest) {
+    el::async::start({4, 16, el::async::full_policy::drop_oldest});
+    {
+        std::lock_guard<std::mutex> lock(el::_detail::logmutex);
+        for (int i = 0; i < 10; ++i) {
+            EXT_LOG("cafe") << i;
+        }
+    }
+    el::async::flush();
+
+    EXPECT_EQ("[cafe] warning: '6'\n[cafe] warning: '7'\n[cafe] warning: '8'\n[cafe] warning: '9'\n", _log.str());
+    auto stats = el::async::stats();
+    EXPECT_EQ(stats.enqueued, 10);
+    EXPECT_EQ(stats.written, 4);
+    EXPECT_EQ(stats.dropped, 0);
+    EXPECT_EQ(stats.dropped_oldest, 6);
+}
+
+TEST_F(AsyncLoggingTest, full_queue_block) {
+    el::async::start({4, 2, el::async::full_policy::block});
+    constexpr int threads = 4;
+    constexpr int messages = 500;
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([] {
+            for (int i = 0; i < messages; ++i) {
+                EXT_LOG("cafe") << "x";
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    el::async::flush();
+
+    auto stats = el::async::stats();
+    EXPECT_EQ(stats.enqueued, threads * messages);
+    EXPECT_EQ(stats.written, threads * messages);
+    EXPECT_EQ(stats.dropped, 0);
+
+    std::string line;
+    int count = 0;
+    while (std::getline(_log, line)) {
+        ASSERT_EQ("[cafe] warning: 'x'", line);
+        ++count;
+    }
+    EXPECT_EQ(count, threads * messages);
+}
+
+#ifndef EXT_COMPILER_VC
+TEST_F(AsyncLoggingDeathTest, fatal_drains_queue) {
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    ASSERT_DEATH_IF_SUPPORTED(
+        {
+            el::configuration::stream = &std::cerr;
+            el::async::start();
+            EXT_LOG("cafe", error) << "last words";
+            EXT_LOG("dead", fatal) << "bye";
+        },
+        "\\[cafe\\] error: 'last words'\n\\[dead\\] fatal: 'bye'");
+}
+#endif // EXT_COMPILER_VC
@@ -0,0 +1,207 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+#include <ext/logging/binary.hpp>
+
+using namespace std::literals;
+namespace el = ext::logging;
+
+struct string_sink : el::sink {
+    using el::sink::write;
+    void write(el::record const& rec) override {
+        data.append(rec.text.data(), rec.text.size());
+        ++records;
+    }
+    std::string data;
+    std::size_t records = 0;
+};
+
+struct BinaryLoggingTest : public ::testing::Test {
+    BinaryLoggingTest() {
+        using namespace ext::logging;
+        configuration::stream = &_text;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = true;
+        configuration::filename = true;
+        configuration::function = true;
+        set_level_all(level::info);
+    }
+
+    ~BinaryLoggingTest() {
+        el::binary::set_sink(nullptr);
+        el::configuration::stream = &std::cout;
+    }
+
+    std::string decode(el::binary::decode_options const& opts = {}) {
+        el::binary::flush();
+        std::stringstream in(_binary.data);
+        std::stringstream out;
+        EXPECT_TRUE(el::binary::decode(in, out, opts));
+        return out.str();
+    }
+
+    // logs the same data as text and binary - on one line so the locations match
+    void log_both(int i) {
+        // clang-format off
+        EXT_LOG("cafe", network, warn) << "value " << i << " " << 2.5 << " " << true << 'c' << -7L << 42u; EXT_LOG_BINARY("cafe", network, warn, "value ", i, " ", 2.5, " ", true, 'c', -7L, 42u);
+        // clang-format on
+    }
+
+    std::stringstream _text;
+    string_sink _binary;
+};
+
+TEST_F(BinaryLoggingTest, decodes_to_text_format) {
+    el::binary::set_sink(&_binary);
+    for (int i = 0; i < 3; ++i) {
+        log_both(i);
+    }
+    EXPECT_EQ(_text.str(), decode());
+}
+
+TEST_F(BinaryLoggingTest, site_is_written_once) {
+    el::binary::set_sink(&_binary);
+    for (int i = 0; i < 10; ++i) {
+        EXT_LOG_BINARY("babe", no_topic, warn, "same site");
+    }
+    el::binary::flush();
+
+    auto count = [this](std::string const& needle) {
+        std::size_t found = 0;
+        for (auto pos = _binary.data.find(needle); pos != std::string::npos; pos = _binary.data.find(needle, pos + 1)) {
+            ++found;
+        }
+        return found;
+    };
+    EXPECT_EQ(count("babe"), 1);
+    EXPECT_EQ(count("same site"), 10);
+}
+
+TEST_F(BinaryLoggingTest, new_sink_gets_known_sites) {
+    string_sink first;
+    el::binary::set_sink(&first);
+    for (int i = 0; i < 2; ++i) {
+        log_both(i);
+    }
+    el::binary::set_sink(&_binary);
+    _text.str("");
+    log_both(3);
+    EXPECT_EQ(_text.str(), decode());
+}
+
+TEST_F(BinaryLoggingTest, decode_options) {
+    el::binary::set_sink(&_binary);
+    EXT_LOG_BINARY("cafe", no_topic, error, "x = ", 1);
+    el::binary::decode_options opts;
+    opts.filename = false;
+    opts.function = false;
+    EXPECT_EQ("[cafe] error: 'x = 1'\n", decode(opts));
+
+    opts.timestamp = true;
+    auto line = decode(opts);
+    ASSERT_GT(line.size(), 30);
+    EXPECT_EQ(line[4], '-');
+    EXPECT_EQ(line[19], '.');
+    EXPECT_EQ(line.substr(30), "[cafe] error: 'x = 1'\n");
+}
+
+TEST_F(BinaryLoggingTest, disabled_level) {
+    el::binary::set_sink(&_binary);
+    auto const header = _binary.data.size();
+    EXT_LOG_BINARY("cafe", no_topic, trace, "not logged");
+    EXPECT_EQ(header, _binary.data.size());
+}
+
+TEST_F(BinaryLoggingTest, recorded_level_is_not_written) {
+    el::binary::set_sink(&_binary);
+    auto const header = _binary.data.size();
+    el::recorder::start({el::level::trace, 4096});
+    EXT_LOG_BINARY("cafe", network, debug, "recorded ", 1);
+    el::recorder::stop();
+    el::binary::flush();
+    EXPECT_EQ(header, _binary.data.size());
+    EXPECT_EQ(_text.str(), "");
+
+    EXPECT_EQ(el::recorder::dump(), 1);
+    EXPECT_NE(_text.str().find("'recorded 1'"), std::string::npos);
+}
+
+TEST_F(BinaryLoggingTest, batches_per_thread) {
+    el::binary::set_sink(&_binary);
+    std::size_t registered = 0;
+    for (int i = 0; i < 10; ++i) {
+        EXT_LOG_BINARY("babe", no_topic, warn, "batched ", i);
+        if (i == 0) {
+            registered = _binary.records; // the site is written at once
+        }
+    }
+    EXPECT_EQ(_binary.records, registered);
+    el::binary::flush();
+    EXPECT_EQ(_binary.records, registered + 1);
+
+    // urgent messages and exiting threads hand over their batch
+    EXT_LOG_BINARY("dead", no_topic, error, "urgent");
+    EXPECT_EQ(_binary.records, registered + 3);
+    std::thread([] { EXT_LOG_BINARY("f00d", no_topic, warn, "other thread"); }).join();
+    EXPECT_EQ(_binary.records, registered + 5);
+
+    auto const text = decode();
+    EXPECT_NE(text.find("'batched 9'"), std::string::npos);
+    EXPECT_NE(text.find("'urgent'"), std::string::npos);
+    EXPECT_NE(text.find("'other thread'"), std::string::npos);
+}
+
+TEST_F(BinaryLoggingTest, header_once_per_sink) {
+    el::binary::set_sink(&_binary);
+    EXT_LOG_BINARY("cafe", no_topic, warn, "x = ", 1);
+    el::binary::set_sink(&_binary);
+    EXPECT_EQ(_binary.data.find(el::binary::magic, 1), std::string::npos);
+
+    // streams appended to each other decode as well
+    el::binary::flush();
+    _binary.data += _binary.data;
+    auto const text = decode();
+    auto const first = text.find("'x = 1'");
+    ASSERT_NE(first, std::string::npos);
+    EXPECT_NE(text.find("'x = 1'", first + 1), std::string::npos);
+}
+
+TEST_F(BinaryLoggingTest, disabled_id) {
+    el::binary::set_sink(&_binary);
+    el::set_enabled("0ff0", false);
+    auto const header = _binary.data.size();
+    EXT_LOG_BINARY("0ff0", no_topic, error, "not logged");
+    el::set_enabled("0ff0", true);
+    el::binary::flush();
+    EXPECT_EQ(header, _binary.data.size());
+}
+
+TEST_F(BinaryLoggingTest, text_fallback) {
+    EXT_LOG("cafe", network, warn) << "value " << 1;
+    EXT_LOG_BINARY("cafe", network, warn, "value ", 1);
+    auto text = _text.str();
+    auto first_end = text.find('\n') + 1;
+    auto first = text.substr(0, first_end);
+    auto second = text.substr(first_end);
+    // only the line numbers differ
+    EXPECT_EQ(first.substr(0, 30), second.substr(0, 30));
+    EXPECT_EQ(first.substr(first.find(" in ")), second.substr(second.find(" in ")));
+}
+
+TEST_F(BinaryLoggingTest, corrupt_input) {
+    std::stringstream in("EXTLOGB1\x02garbage");
+    std::stringstream out;
+    EXPECT_FALSE(el::binary::decode(in, out));
+    std::stringstream wrong_magic("NOTALOG!");
+    EXPECT_FALSE(el::binary::decode(wrong_magic, out));
+}
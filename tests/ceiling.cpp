@@ -0,0 +1,81 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL trace
+#include <ext/logging.hpp>
+
+// a topic of its own so that the ceiling is the same in every translation unit
+namespace ext { namespace logging { namespace topic {
+_detail::logtopic chatty{1000, "chatty", level::trace};
+}}} // namespace ext::logging::topic
+
+EXT_LOGGING_TOPIC_CEILING(chatty, warn);
+
+namespace el = ext::logging;
+
+static_assert(el::topic_ceiling<el::topic::chatty> == el::level::warn);
+static_assert(el::topic_ceiling<el::topic::network> == el::level::trace);
+static_assert(el::_detail::constexpr_level_is_active<el::topic::chatty>(el::level::warn));
+static_assert(!el::_detail::constexpr_level_is_active<el::topic::chatty>(el::level::info));
+static_assert(el::_detail::constexpr_level_is_active<el::topic::network>(el::level::trace));
+
+struct CeilingTest : public ::testing::Test {
+    CeilingTest() {
+        using namespace ext::logging;
+        configuration::stream = &_log;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = true;
+        configuration::filename = false;
+        configuration::function = false;
+        set_level_all(level::trace);
+    }
+
+    ~CeilingTest() {
+        using namespace ext::logging;
+        configuration::stream = &std::cout;
+        configuration::filename = true;
+        configuration::function = true;
+        set_level_all(level::warn);
+    }
+
+    std::stringstream _log;
+};
+
+TEST_F(CeilingTest, const_statement_above_ceiling_is_discarded) {
+    int evaluated = 0;
+    EXT_LOG_CONST("7a1e", chatty, trace) << "ceiling-literal-must-vanish" << ++evaluated;
+    EXT_LOG_CONST("7a1e", chatty, warn) << "kept " << ++evaluated;
+    EXPECT_EQ(evaluated, 1);
+    EXPECT_EQ(_log.str(), "[7a1e] warning (chatty): 'kept 1'\n");
+}
+
+TEST_F(CeilingTest, variable_statement_above_ceiling_is_inactive) {
+    int evaluated = 0;
+    EXT_LOG("7a1e", chatty, debug) << ++evaluated;
+    EXT_LOG("7a1e", chatty, error) << ++evaluated;
+    EXPECT_EQ(evaluated, 1);
+    EXPECT_EQ(_log.str(), "[7a1e] error (chatty): '1'\n");
+}
+
+#ifdef __linux__
+TEST_F(CeilingTest, discarded_literal_is_not_in_binary) {
+    // spelled backwards so that the needle itself is no match
+    std::string needle = "hsinav-tsum-laretil-gnilies";
+    std::reverse(needle.begin(), needle.end());
+    std::ifstream exe("/proc/self/exe", std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(exe)), std::istreambuf_iterator<char>());
+    ASSERT_FALSE(content.empty());
+    EXPECT_NE(content.find("kept "), std::string::npos);
+    EXPECT_EQ(content.find(needle), std::string::npos);
+}
+#endif // __linux__
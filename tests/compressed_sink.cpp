@@ -0,0 +1,197 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+#include <ext/logging/compressed_sink.hpp>
+
+namespace el = ext::logging;
+namespace ec = ext::logging::compressed;
+namespace fs = std::filesystem;
+
+namespace {
+std::string line(int i) {
+    return "[cafe] info (network): 'request " + std::to_string(i) + " from 10.0.0." + std::to_string(i % 7) +
+           " took " + std::to_string(i * 37 % 1000) + "ms'\n";
+}
+
+bool lz_round_trip(std::string const& raw) {
+    std::string packed;
+    ec::_detail::lz_compress(raw.data(), raw.size(), packed);
+    std::string unpacked(raw.size(), '\0');
+    return ec::_detail::lz_decompress(packed.data(), packed.size(), &unpacked[0], raw.size()) && unpacked == raw;
+}
+} // namespace
+
+struct CompressedSinkTest : public ::testing::TestWithParam<ec::codec> {
+    CompressedSinkTest() {
+        _path = fs::temp_directory_path() / ("ext-logging-compressed-" + std::to_string(std::random_device{}()));
+    }
+
+    ~CompressedSinkTest() {
+        std::error_code error;
+        fs::remove(_path, error);
+    }
+
+    el::compressed_file_sink::options options(std::size_t block_size) {
+        el::compressed_file_sink::options opts;
+        opts.path = _path.string();
+        opts.block_size = block_size;
+        opts.method = GetParam();
+        return opts;
+    }
+
+    // writes `count` lines and returns their text
+    std::string write(std::size_t block_size, int count) {
+        std::string expected;
+        el::compressed_file_sink sink(options(block_size));
+        for (int i = 0; i < count; ++i) {
+            auto const text = line(i);
+            expected += text;
+            sink.write({el::level::info, text});
+        }
+        return expected;
+    }
+
+    std::string decode(ec::decode_options const& opts = ec::decode_options{}) {
+        std::ifstream in(_path, std::ios::binary);
+        std::ostringstream out;
+        EXPECT_TRUE(ec::decode(in, out, opts));
+        return out.str();
+    }
+
+    std::vector<ec::block_info> blocks() {
+        std::ifstream in(_path, std::ios::binary);
+        std::vector<ec::block_info> result;
+        EXPECT_TRUE(ec::read_index(in, result));
+        return result;
+    }
+
+    fs::path _path;
+};
+
+TEST(CompressedSink, lz_codec) {
+    EXPECT_TRUE(lz_round_trip(""));
+    EXPECT_TRUE(lz_round_trip("a"));
+    EXPECT_TRUE(lz_round_trip("abcabcabcabcabcabcabcabcabcabcabcabcabcabc"));
+    EXPECT_TRUE(lz_round_trip(std::string(100000, 'x')));
+
+    std::string lines;
+    for (int i = 0; i < 2000; ++i) {
+        lines += line(i);
+    }
+    std::string packed;
+    ec::_detail::lz_compress(lines.data(), lines.size(), packed);
+    EXPECT_LT(packed.size(), lines.size() / 2);
+    EXPECT_TRUE(lz_round_trip(lines));
+
+    std::mt19937 random(42);
+    std::string noise(70000, '\0');
+    for (auto& c : noise) {
+        c = static_cast<char>(random());
+    }
+    EXPECT_TRUE(lz_round_trip(noise));
+
+    // corrupt input is rejected
+    std::string out(lines.size(), '\0');
+    EXPECT_FALSE(ec::_detail::lz_decompress(packed.data(), packed.size() / 2, &out[0], out.size()));
+    EXPECT_FALSE(ec::_detail::lz_decompress(packed.data(), packed.size(), &out[0], out.size() - 1));
+    packed[1] = static_cast<char>(0xff);
+    packed[2] = static_cast<char>(0xff);
+    EXPECT_FALSE(ec::_detail::lz_decompress(packed.data(), packed.size(), &out[0], out.size()) && out == lines);
+}
+
+TEST_P(CompressedSinkTest, round_trip) {
+    auto const expected = write(16 * 1024, 5000);
+    EXPECT_EQ(decode(), expected);
+
+    auto const all = blocks();
+    ASSERT_GT(all.size(), 5);
+    std::uint64_t records = 0, stored = 0;
+    for (auto const& block : all) {
+        EXPECT_LE(block.raw_size, 16 * 1024); // records are not split
+        EXPECT_LE(block.first, block.last);
+        records += block.records;
+        stored += block.stored_size;
+    }
+    EXPECT_EQ(records, 5000);
+    if (GetParam() != ec::codec::stored) {
+        EXPECT_LT(stored, expected.size() / 2);
+    }
+}
+
+TEST_P(CompressedSinkTest, readable_without_index) {
+    auto const expected = write(4096, 1000);
+    auto const indexed = blocks();
+
+    // cut the index and half of the last block
+    auto const& last = indexed.back();
+    fs::resize_file(_path, last.offset + ec::block_header_size + last.stored_size / 2);
+    auto const walked = blocks();
+    ASSERT_EQ(walked.size(), indexed.size() - 1);
+    for (std::size_t i = 0; i < walked.size(); ++i) {
+        EXPECT_EQ(walked[i].offset, indexed[i].offset);
+        EXPECT_EQ(walked[i].records, indexed[i].records);
+    }
+
+    std::ifstream in(_path, std::ios::binary);
+    std::string text;
+    ASSERT_TRUE(ec::read_block(in, walked.back(), text));
+    EXPECT_EQ(text.back(), '\n');
+    EXPECT_NE(expected.find(text), std::string::npos);
+}
+
+TEST_P(CompressedSinkTest, time_range) {
+    std::vector<std::string> parts;
+    {
+        el::compressed_file_sink sink(options(1024 * 1024));
+        for (int part = 0; part < 3; ++part) {
+            std::string text;
+            for (int i = 0; i < 10; ++i) {
+                text += line(part * 100 + i);
+                sink.write({el::level::info, line(part * 100 + i)});
+            }
+            sink.flush(); // ends the block
+            parts.push_back(text);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+
+    auto const all = blocks();
+    ASSERT_EQ(all.size(), 3);
+    ec::decode_options opts;
+    opts.from = all[1].first;
+    opts.to = all[1].last;
+    EXPECT_EQ(decode(opts), parts[1]);
+    opts.to = all[2].first;
+    EXPECT_EQ(decode(opts), parts[1] + parts[2]);
+    opts.from = all[2].last + 1;
+    opts.to = opts.from + 1000;
+    EXPECT_EQ(decode(opts), "");
+}
+
+TEST_P(CompressedSinkTest, as_configured_sink) {
+    {
+        el::compressed_file_sink sink(options(64));
+        el::configuration::sink = &sink;
+        el::configuration::filename = false;
+        el::configuration::function = false;
+        EXT_LOG("b10c", network, warn) << "compressed";
+        EXT_LOG("b10d", network, error) << "compressed again";
+        el::configuration::sink = nullptr;
+        el::configuration::filename = true;
+        el::configuration::function = true;
+    }
+    EXPECT_EQ(decode(),
+              "[b10c] warning (network): 'compressed'\n"
+              "[b10d] error (network): 'compressed again'\n");
+}
+
+INSTANTIATE_TEST_SUITE_P(Codecs, CompressedSinkTest, ::testing::Values(ec::codec::stored, ec::codec::lz, ec::default_codec()));
@@ -0,0 +1,94 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+
+namespace el = ext::logging;
+
+struct ContextTest : public ::testing::Test {
+    ContextTest() {
+        using namespace ext::logging;
+        configuration::stream = &_log;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = true;
+        configuration::filename = false;
+        configuration::function = false;
+    }
+
+    ~ContextTest() {
+        using namespace ext::logging;
+        configuration::threads = false;
+        configuration::stream = &std::cout;
+        configuration::filename = true;
+        configuration::function = true;
+    }
+
+    std::stringstream _log;
+};
+
+TEST_F(ContextTest, thread_field) {
+    el::configuration::threads = true;
+    std::string unnamed_tid, named_tid;
+    std::thread([&unnamed_tid] {
+        unnamed_tid = std::to_string(el::thread_id());
+        EXT_LOG("cafe") << "unnamed";
+    }).join();
+    std::thread([&named_tid] {
+        el::set_thread_name("a-very-long-worker-name");
+        EXPECT_EQ(el::thread_name(), "a-very-long-wor");
+        named_tid = std::to_string(el::thread_id());
+        EXT_LOG("babe") << "named";
+    }).join();
+
+    EXPECT_EQ(_log.str(),
+              "{" + unnamed_tid + "} [cafe] warning: 'unnamed'\n"
+              "{" + named_tid + " a-very-long-wor} [babe] warning: 'named'\n");
+}
+
+TEST_F(ContextTest, context_stack) {
+    {
+        el::context request("request", 42);
+        EXT_LOG("cafe") << "one";
+        {
+            el::context user("user", "jane doe");
+            el::context empty("empty", "");
+            EXT_LOG("cafe") << "two";
+        }
+        EXT_LOG("cafe") << "three";
+    }
+    EXT_LOG("cafe") << "four";
+
+    EXPECT_EQ(_log.str(),
+              "[cafe] warning: 'one' request=42\n"
+              "[cafe] warning: 'two' request=42 user=\"jane doe\" empty=\"\"\n"
+              "[cafe] warning: 'three' request=42\n"
+              "[cafe] warning: 'four'\n");
+}
+
+TEST_F(ContextTest, context_is_per_thread) {
+    el::context request("request", 1);
+    std::thread([] { EXT_LOG("babe") << "other thread"; }).join();
+    EXPECT_EQ(_log.str(), "[babe] warning: 'other thread'\n");
+}
+
+TEST_F(ContextTest, context_overflow_is_left_out) {
+    std::string const big(el::context::capacity, 'x');
+    el::context fits("a", 1);
+    {
+        el::context too_big("big", big);
+        el::context after("b", 2);
+        EXT_LOG("cafe") << "overflow";
+    }
+    EXT_LOG("cafe") << "after";
+    EXPECT_EQ(_log.str(), "[cafe] warning: 'overflow' a=1 b=2\n[cafe] warning: 'after' a=1\n");
+}
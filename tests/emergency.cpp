@@ -0,0 +1,241 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#ifndef _WIN32
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+#include <ext/logging/rotating_sink.hpp>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std::literals;
+namespace el = ext::logging;
+
+struct EmergencyTest : public ::testing::Test {
+    EmergencyTest() {
+        using namespace ext::logging;
+        configuration::stream = &_log;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = true;
+        configuration::filename = false;
+        configuration::function = false;
+        set_level(topic::network, level::warn);
+
+        EXPECT_EQ(::pipe2(_pipe, O_NONBLOCK | O_CLOEXEC), 0);
+        emergency::set_fd(_pipe[1]);
+    }
+
+    ~EmergencyTest() {
+        using namespace ext::logging;
+        emergency::set_fd(STDERR_FILENO);
+        ::close(_pipe[0]);
+        ::close(_pipe[1]);
+        async::stop();
+        configuration::sink = nullptr;
+        configuration::stream = &std::cout;
+        configuration::filename = true;
+        configuration::function = true;
+    }
+
+    // everything written to the emergency fd so far
+    std::string take() {
+        std::string result;
+        char buffer[4096];
+        for (auto size = ::read(_pipe[0], buffer, sizeof(buffer)); size > 0;
+             size = ::read(_pipe[0], buffer, sizeof(buffer))) {
+            result.append(buffer, static_cast<std::size_t>(size));
+        }
+        return result;
+    }
+
+    // runs `child` in a forked process - false if it fails or hangs
+    template<typename Function>
+    static bool in_child(Function child) {
+        auto const pid = ::fork();
+        if (pid == 0) {
+            ::alarm(10); // a deadlock kills the child
+            ::_exit(child() ? 0 : 1);
+        }
+        int status = 0;
+        return pid > 0 && ::waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    static std::string read_file(std::string const& path) {
+        std::ifstream in(path);
+        std::stringstream content;
+        content << in.rdbuf();
+        return content.str();
+    }
+
+    int _pipe[2] = {-1, -1};
+    std::stringstream _log;
+};
+
+TEST_F(EmergencyTest, writes_a_line_to_the_fd) {
+    int const* pointer = nullptr;
+    EXT_LOG_SIGNAL("dead", network, error) << "signal " << 11 << ' ' << -3 << ' ' << 2u << ' ' << true << ' ' << 1.5
+                                           << ' ' << pointer << ' ' << "text"s;
+    EXT_LOG_SIGNAL("beef", network, info) << "level not active";
+    EXT_LOG_SIGNAL("cafe", warn) << static_cast<char const*>(nullptr);
+
+    EXPECT_EQ(take(), "[dead] error (network): 'signal 11 -3 2 true 1.5 0x0 text'\n[cafe] warning: '(null)'\n");
+    EXPECT_EQ(_log.str(), "");
+}
+
+TEST_F(EmergencyTest, ignores_the_recorder) {
+    el::recorder::start({el::level::trace, 4096});
+    EXT_LOG_SIGNAL("beef", network, debug) << "only recorded by EXT_LOG";
+    el::recorder::stop();
+    EXPECT_EQ(take(), "");
+}
+
+TEST_F(EmergencyTest, cuts_long_messages) {
+    EXT_LOG_SIGNAL("dead", error) << std::string(2 * el::emergency::line::capacity, 'x');
+
+    auto const line = take();
+    ASSERT_EQ(line.size(), el::emergency::line::capacity);
+    EXPECT_EQ(line.substr(0, 18), "[dead] error: 'xxx");
+    EXPECT_EQ(line.substr(line.size() - 6), "x...'\n");
+}
+
+namespace {
+std::atomic<int> handled{0};
+
+void on_signal(int signal_number) {
+    EXT_LOG_SIGNAL("5167", error) << "caught signal " << signal_number;
+    handled.fetch_add(1);
+}
+} // namespace
+
+TEST_F(EmergencyTest, logs_in_signal_handler) {
+    auto const previous = std::signal(SIGUSR1, on_signal);
+    ASSERT_NE(previous, SIG_ERR);
+    auto const before = handled.load();
+    errno = EAGAIN;
+    std::raise(SIGUSR1);
+    EXPECT_EQ(errno, EAGAIN); // kept for the interrupted code
+    std::signal(SIGUSR1, previous);
+
+    EXPECT_EQ(handled.load(), before + 1);
+    EXPECT_EQ(take(), "[5167] error: 'caught signal " + std::to_string(SIGUSR1) + "'\n");
+}
+
+TEST_F(EmergencyTest, fork_while_logging) {
+    std::atomic<bool> stop{false};
+    std::thread logging([&stop] {
+        while (!stop.load()) {
+            EXT_LOG("f0cc", network, warn) << "busy";
+        }
+    });
+
+    // without the fork handlers the child deadlocks when it inherits a locked `logmutex`
+    bool children_logged = true;
+    for (int i = 0; i < 50 && children_logged; ++i) {
+        children_logged = in_child([] {
+            std::stringstream out;
+            el::configuration::stream = &out;
+            EXT_LOG("c41d", network, warn) << "child";
+            return out.str() == "[c41d] warning (network): 'child'\n";
+        });
+    }
+    stop.store(true);
+    logging.join();
+    EXPECT_TRUE(children_logged);
+}
+
+TEST_F(EmergencyTest, fork_flushes_the_sink) {
+    char path[] = "/tmp/ext-logging-fork-XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+
+    {
+        el::file_sink target(path, 1024);
+        el::configuration::sink = &target;
+        EXT_LOG("cafe", network, warn) << "before fork";
+        EXPECT_EQ(read_file(path), "");
+
+        // the child flushes its copy of the buffer - it must not contain the parent's line
+        EXPECT_TRUE(in_child([&target] {
+            target.flush();
+            return el::configuration::sink == nullptr;
+        }));
+        el::configuration::sink = nullptr;
+    }
+    EXPECT_EQ(read_file(path), "[cafe] warning (network): 'before fork'\n");
+    std::remove(path);
+}
+
+TEST_F(EmergencyTest, child_drops_the_rotating_sink) {
+    auto const dir = std::filesystem::temp_directory_path() / ("ext-logging-fork-" + std::to_string(::getpid()));
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    {
+        el::rotating_file_sink::options opts;
+        opts.directory = dir.string();
+        opts.base_name = "fork";
+        opts.segment_size = 4096;
+        el::rotating_file_sink target(opts);
+        el::configuration::sink = &target;
+        EXT_LOG("cafe", network, warn) << "before fork";
+
+        // the segment is mapped shared - a child writing to it overwrites the parent
+        EXPECT_TRUE(in_child([] {
+            std::stringstream out;
+            el::configuration::stream = &out;
+            EXT_LOG("c41d", network, warn) << "child";
+            return el::configuration::sink == nullptr && out.str() == "[c41d] warning (network): 'child'\n";
+        }));
+        EXT_LOG("beef", network, warn) << "after fork";
+        el::configuration::sink = nullptr;
+    }
+    EXPECT_EQ(read_file((dir / "fork.00000000.log").string()),
+              "[cafe] warning (network): 'before fork'\n[beef] warning (network): 'after fork'\n");
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(EmergencyTest, child_logs_without_async_writer) {
+    el::async::start();
+    EXT_LOG("cafe", network, warn) << "parent";
+    EXPECT_TRUE(in_child([] {
+        std::stringstream out;
+        el::configuration::stream = &out;
+        EXT_LOG("c41d", network, warn) << "child";
+        return !el::async::active() && out.str() == "[c41d] warning (network): 'child'\n";
+    }));
+    EXPECT_TRUE(el::async::active());
+    el::async::stop();
+    EXPECT_EQ(_log.str(), "[cafe] warning (network): 'parent'\n");
+}
+
+TEST_F(EmergencyTest, child_forgets_thread_and_recorder) {
+    el::recorder::start({el::level::trace, 4096});
+    EXT_LOG("cafe", network, debug) << "recorded by the parent";
+    auto const parent = el::thread_id();
+    EXPECT_TRUE(in_child([parent] {
+        std::stringstream out;
+        el::configuration::stream = &out;
+        return el::thread_id() != parent && el::recorder::dump() == 0 && out.str().empty();
+    }));
+    el::recorder::stop();
+    EXPECT_EQ(el::recorder::dump(), 1);
+    EXPECT_EQ(_log.str(), "[cafe] debug (network): 'recorded by the parent'\n");
+}
+#endif // _WIN32
@@ -0,0 +1,179 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+
+namespace el = ext::logging;
+
+namespace {
+struct point {
+    int x, y;
+};
+
+struct streamed {
+    int value;
+};
+std::ostream& operator<<(std::ostream& out, streamed const& s) {
+    return out << "streamed " << s.value;
+}
+
+struct neither {};
+
+// whether `check_format` is a constant expression for the format `F::value`
+template<typename F, typename List, bool = el::_detail::check_format(List{}, F::value)>
+constexpr bool compiles(int) {
+    return true;
+}
+template<typename F, typename List>
+constexpr bool compiles(...) {
+    return false;
+}
+
+template<typename... Args>
+using types = el::_detail::type_list<char const*, Args...>;
+
+#define FORMAT(name_, text_)                               \
+    struct name_ {                                         \
+        static constexpr std::string_view value = text_;   \
+    }
+FORMAT(two, "x={} y={}");
+FORMAT(braces, "{{literal}} {}");
+FORMAT(unmatched_open, "x={");
+FORMAT(unmatched_close, "x=}");
+FORMAT(positional, "{0}");
+FORMAT(fixed, "{:.3f}");
+FORMAT(hex, "{:#010x}");
+FORMAT(bad_spec, "{:q}");
+} // namespace
+
+template<>
+struct ext::logging::formatter<point> {
+    static void format(format_output& out, point const& p, format_spec const& spec) {
+        out.append(spec.type == 'x' ? "point(" : "(");
+        out.write(p.x);
+        out.append(", ");
+        out.write(p.y);
+        out.append(')');
+    }
+};
+
+// the checks run at compile time
+static_assert(compiles<two, types<int, double>>(0));
+static_assert(compiles<braces, types<char const*>>(0));
+static_assert(compiles<fixed, types<double>>(0));
+static_assert(compiles<hex, types<unsigned>>(0));
+static_assert(compiles<two, types<point, streamed>>(0));
+static_assert(!compiles<two, types<int>>(0), "too few arguments");
+static_assert(!compiles<two, types<int, int, int>>(0), "too many arguments");
+static_assert(!compiles<unmatched_open, types<int>>(0));
+static_assert(!compiles<unmatched_close, types<>>(0));
+static_assert(!compiles<positional, types<int>>(0));
+static_assert(!compiles<fixed, types<int>>(0), "precision on an integer");
+static_assert(!compiles<hex, types<std::string>>(0), "integer type on a string");
+static_assert(!compiles<bad_spec, types<int>>(0));
+static_assert(!compiles<two, types<int, neither>>(0), "neither formatter nor operator<<");
+
+struct FormatTest : public ::testing::Test {
+    FormatTest() {
+        using namespace ext::logging;
+        configuration::stream = &_log;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = false;
+        configuration::filename = false;
+        configuration::function = false;
+    }
+
+    ~FormatTest() {
+        using namespace ext::logging;
+        configuration::stream = &std::cout;
+        configuration::append_newline = true;
+        configuration::filename = true;
+        configuration::function = true;
+    }
+
+    std::string take() {
+        auto result = _log.str();
+        _log.str("");
+        // strip `[cafe] warning: '` and the closing `'`
+        auto const begin = result.find('\'');
+        return result.substr(begin + 1, result.size() - begin - 2);
+    }
+
+    std::stringstream _log;
+};
+
+TEST_F(FormatTest, integers) {
+    EXT_LOGF("cafe", no_topic, warn, "{} {} {} {}", 0, -42, std::numeric_limits<std::int64_t>::min(), 42u);
+    EXPECT_EQ(take(), "0 -42 -9223372036854775808 42");
+    EXT_LOGF("cafe", no_topic, warn, "{:x} {:#X} {:#b} {:o} {:#o} {:+d} {: d}", 255, 255, 5, 8, 8, 7, 7);
+    EXPECT_EQ(take(), "ff 0XFF 0b101 10 010 +7  7");
+    EXT_LOGF("cafe", no_topic, warn, "[{:5}] [{:<5}] [{:^6}] [{:*>5}] [{:05}] [{:#010x}]", 42, 42, 42, 42, -42, 255);
+    EXPECT_EQ(take(), "[   42] [42   ] [  42  ] [***42] [-0042] [0x000000ff]");
+    EXT_LOGF("cafe", no_topic, warn, "{:c}{:c}", 104, 'i');
+    EXPECT_EQ(take(), "hi");
+}
+
+TEST_F(FormatTest, floats) {
+    EXT_LOGF("cafe", no_topic, warn, "{} {} {} {}", 0.1, 1.5, -2.0, 1e300);
+    EXPECT_EQ(take(), "0.1 1.5 -2 1e+300");
+    EXT_LOGF("cafe", no_topic, warn, "{:.3f} {:f} {:.2e} {:E} {:g} {:.3G}", 3.14159, 2.5, 12345.678, 0.5, 1e-5, 1e10);
+    EXPECT_EQ(take(), "3.142 2.500000 1.23e+04 5.000000E-01 1e-05 1E+10");
+    EXT_LOGF("cafe", no_topic, warn, "{} {} {:.2f}", 1.0f / 3, 1.0 / 3, 1.0L / 3);
+    EXPECT_EQ(take(), "0.33333334 0.3333333333333333 0.33");
+    EXT_LOGF("cafe", no_topic, warn, "[{:8.2f}] [{:<8.2f}] [{:+08.2f}] [{:#.0f}]", 3.14159, 3.14159, 3.14159, 3.0);
+    EXPECT_EQ(take(), "[    3.14] [3.14    ] [+0003.14] [3.]");
+    EXT_LOGF("cafe", no_topic, warn, "{} {} {:F} {:08}", std::nan(""), -HUGE_VAL, HUGE_VAL, HUGE_VAL);
+    EXPECT_EQ(take(), "nan -inf INF      inf"); // never zero padded
+}
+
+TEST_F(FormatTest, strings_bools_pointers) {
+    std::string const text = "text";
+    std::string_view const view = "view";
+    char const* const null = nullptr;
+    EXT_LOGF("cafe", no_topic, warn, "{} {} {} {} {}", "literal", text, view, null, 'c');
+    EXPECT_EQ(take(), "literal text view (null) c");
+    EXT_LOGF("cafe", no_topic, warn, "[{:.2}] [{:>6}] [{:-^8}]", text, view, "mid");
+    EXPECT_EQ(take(), "[te] [  view] [--mid---]");
+    EXT_LOGF("cafe", no_topic, warn, "{} {:s} {:d} {:5}", true, false, true, false);
+    EXPECT_EQ(take(), "true false 1 false");
+    EXT_LOGF("cafe", no_topic, warn, "{} {}", static_cast<void*>(nullptr), reinterpret_cast<void*>(0x1234));
+    EXPECT_EQ(take(), "0x0 0x1234");
+}
+
+TEST_F(FormatTest, user_types_and_escapes) {
+    EXT_LOGF("cafe", no_topic, warn, "{{{}}} {:x} [{:>10}] {}", point{1, 2}, point{3, 4}, point{5, 6}, streamed{7});
+    EXPECT_EQ(take(), "{(1, 2)} point(3, 4) [    (5, 6)] streamed 7");
+    EXT_LOGF("cafe", no_topic, warn, "no placeholders");
+    EXPECT_EQ(take(), "no placeholders");
+}
+
+TEST_F(FormatTest, same_checks_as_ext_log) {
+    int evaluated = 0;
+    auto count = [&evaluated] {
+        return ++evaluated;
+    };
+    EXT_LOGF("cafe", network, debug, "{}", count());
+    el::set_enabled("dead", false);
+    EXT_LOGF("dead", no_topic, error, "{}", count());
+    el::set_enabled("dead", true);
+    EXPECT_EQ(evaluated, 0);
+    EXPECT_EQ(_log.str(), "");
+
+    EXT_LOGF("cafe", network, error, "{}", count());
+    EXPECT_EQ(evaluated, 1);
+    el::configuration::append_newline = true;
+    EXT_LOGF("babe", network, error, "x={:3}", 7).kv("key", "value");
+    EXPECT_EQ(_log.str(), "[cafe] error (network): '1'[babe] error (network): 'x=  7' key=value\n");
+}
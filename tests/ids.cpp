@@ -0,0 +1,136 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+
+namespace el = ext::logging;
+
+// FNV-1a test vectors
+static_assert(el::id_hash("") == 14695981039346656037ull);
+static_assert(el::id_hash("a") == 0xaf63dc4c8601ec8cull);
+static_assert(el::id_hash("foobar") == 0x85944171f73967e8ull);
+static_assert(el::id_hash("foobar") == el::id_hash(std::string_view("foobar")));
+
+struct IdsTest : public ::testing::Test {
+    IdsTest() {
+        using namespace ext::logging;
+        configuration::stream = &_log;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = true;
+        configuration::filename = false;
+        configuration::function = false;
+        set_level(topic::network, level::warn);
+    }
+
+    ~IdsTest() {
+        using namespace ext::logging;
+        clear_allowed_ids();
+        configuration::stream = &std::cout;
+        configuration::filename = true;
+        configuration::function = true;
+    }
+
+    std::string take() {
+        auto result = _log.str();
+        _log.str("");
+        return result;
+    }
+
+    std::stringstream _log;
+};
+
+TEST_F(IdsTest, id_set) {
+    el::_detail::id_set set;
+    EXPECT_FALSE(set.contains(42));
+    set.erase(42);
+
+    // the low bits collide - long probe sequences that wrap around
+    std::set<std::uint64_t> expected;
+    for (std::uint64_t i = 1; i <= 200; ++i) {
+        auto const value = i % 3 ? (i << 40) : i * 0x9e3779b97f4a7c15ull;
+        set.insert(value);
+        set.insert(value);
+        expected.insert(value);
+    }
+    EXPECT_EQ(set.size(), expected.size());
+
+    std::size_t step = 0;
+    for (auto it = expected.begin(); it != expected.end();) {
+        if (++step % 3 == 0) {
+            set.erase(*it);
+            it = expected.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    EXPECT_EQ(set.size(), expected.size());
+    for (std::uint64_t i = 1; i <= 200; ++i) {
+        auto const value = i % 3 ? (i << 40) : i * 0x9e3779b97f4a7c15ull;
+        EXPECT_EQ(set.contains(value), expected.count(value) == 1) << i;
+    }
+
+    set.clear();
+    EXPECT_EQ(set.size(), 0);
+    EXPECT_FALSE(set.contains(1ull << 40));
+}
+
+TEST_F(IdsTest, sites_carry_the_hash) {
+    static el::_detail::call_site site{"c0de", &el::topic::network, el::level::warn, __FILE__, __LINE__, __FUNCTION__};
+    EXPECT_EQ(site.hash, el::id_hash("c0de"));
+}
+
+TEST_F(IdsTest, allow_and_deny) {
+    auto log = [] {
+        EXT_LOG("a11a", network, warn) << "allowed";
+        EXT_LOG("d0d0", network, warn) << "other";
+    };
+
+    log();
+    EXPECT_EQ(take(), "[a11a] warning (network): 'allowed'\n[d0d0] warning (network): 'other'\n");
+
+    el::set_allowed_ids({"a11a", "cafe"});
+    EXPECT_TRUE(el::is_enabled("a11a"));
+    EXPECT_FALSE(el::is_enabled("d0d0"));
+    log();
+    EXPECT_EQ(take(), "[a11a] warning (network): 'allowed'\n");
+
+    // denied wins over allowed
+    el::set_enabled("a11a", false);
+    log();
+    EXPECT_EQ(take(), "");
+    el::set_enabled("a11a", true);
+
+    el::clear_allowed_ids();
+    log();
+    EXPECT_EQ(take(), "[a11a] warning (network): 'allowed'\n[d0d0] warning (network): 'other'\n");
+}
+
+TEST_F(IdsTest, duplicate_ids) {
+    EXT_LOG("d0b1", network, warn) << "first";
+    EXT_LOG("d0b1", network, warn) << "second";
+    take();
+
+    auto const duplicates = el::duplicate_ids();
+    auto found = std::find_if(duplicates.begin(), duplicates.end(), [](el::duplicate_id const& duplicate) {
+        return duplicate.hash == el::id_hash("d0b1");
+    });
+    ASSERT_NE(found, duplicates.end());
+    ASSERT_EQ(found->sites.size(), 2);
+    EXPECT_STREQ(found->sites[0].id, "d0b1");
+    EXPECT_NE(found->sites[0].line, found->sites[1].line);
+
+    EXPECT_TRUE(std::none_of(duplicates.begin(), duplicates.end(), [](el::duplicate_id const& duplicate) {
+        return duplicate.hash == el::id_hash("a11a");
+    }));
+}
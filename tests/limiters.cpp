@@ -0,0 +1,119 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+
+namespace el = ext::logging;
+
+struct LimitersTest : public ::testing::Test {
+    LimitersTest() {
+        using namespace ext::logging;
+        configuration::stream = &_log;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = true;
+        configuration::filename = false;
+        configuration::function = false;
+        set_level_all(level::warn);
+    }
+
+    ~LimitersTest() {
+        using namespace ext::logging;
+        configuration::stream = &std::cout;
+        configuration::filename = true;
+        configuration::function = true;
+    }
+
+    std::size_t lines() const {
+        auto text = _log.str();
+        return static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n'));
+    }
+
+    std::stringstream _log;
+};
+
+TEST_F(LimitersTest, every_n) {
+    int evaluated = 0;
+    for (int i = 0; i < 10; ++i) {
+        EXT_LOG_EVERY_N(4, "e001", network, warn) << i << (++evaluated, "");
+    }
+    EXPECT_EQ(evaluated, 3);
+    EXPECT_EQ(_log.str(),
+              "[e001] warning (network): '0'\n"
+              "[e001] warning (network): '4' (3 suppressed)\n"
+              "[e001] warning (network): '8' (3 suppressed)\n");
+}
+
+TEST_F(LimitersTest, first_n) {
+    for (int i = 0; i < 10; ++i) {
+        EXT_LOG_FIRST_N(2, "f001") << i;
+    }
+    EXPECT_EQ(_log.str(), "[f001] warning: '0'\n[f001] warning: '1'\n");
+}
+
+TEST_F(LimitersTest, level_is_checked_first) {
+    for (int i = 0; i < 10; ++i) {
+        EXT_LOG_EVERY_N(2, "e002", network, trace) << i;
+    }
+    EXPECT_EQ(_log.str(), "");
+}
+
+TEST_F(LimitersTest, rate) {
+    using namespace std::chrono;
+    auto log = [] {
+        EXT_LOG_RATE(5, milliseconds(200), "r001", error) << "limited";
+    };
+
+    for (int i = 0; i < 100; ++i) {
+        log();
+    }
+    EXPECT_EQ(lines(), 5);
+
+    std::this_thread::sleep_for(milliseconds(250));
+    log();
+    EXPECT_EQ(lines(), 6);
+    EXPECT_NE(_log.str().find("'limited' (95 suppressed)"), std::string::npos);
+}
+
+TEST_F(LimitersTest, rate_from_many_threads) {
+    using namespace std::chrono;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([] {
+            for (int i = 0; i < 1000; ++i) {
+                EXT_LOG_RATE(10, seconds(60), "r002", error) << i;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(lines(), 10);
+}
+
+TEST_F(LimitersTest, sample) {
+    for (int i = 0; i < 10000; ++i) {
+        EXT_LOG_SAMPLE(0.1, "s001", error) << i;
+    }
+    EXPECT_GT(lines(), 700);
+    EXPECT_LT(lines(), 1300);
+
+    _log.str("");
+    for (int i = 0; i < 100; ++i) {
+        EXT_LOG_SAMPLE(0.0, "s002", error) << i;
+        EXT_LOG_SAMPLE(1.0, "s003", error) << i;
+    }
+    EXPECT_EQ(lines(), 100);
+}
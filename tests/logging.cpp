@@ -1,7 +1,11 @@
 // Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
 // Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <atomic>
 #include <cstring>
 #include <sstream>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -134,7 +138,7 @@ TEST_F(LoggingTest, logging_level_too_low_1) {
 }
 
 TEST_F(LoggingTest, logging_level_too_low_2) {
-    ext::logging::topic::network.activation_level = ext::logging::level::error;
+    ext::logging::set_level(ext::logging::topic::network, ext::logging::level::error);
     _line = __LINE__ + 1;
     ASSERT_NO_THROW(EXT_LOG("music", network, warn) << "will not be logged");
     compare("");
@@ -210,17 +214,199 @@ TEST_F(LoggingTest, change_all_levels) {
 TEST_F(LoggingTest, change_single_level) {
     using namespace ext::logging;
     EXPECT_FALSE(_detail::variable_level_is_active(level::info, topic::network));
-    topic::network.activation_level = level::info;
+    set_level(topic::network, level::info);
     EXPECT_TRUE(_detail::variable_level_is_active(level::info, topic::network));
 }
 
 TEST_F(LoggingTest, levels_to_string) {
     using namespace ext::logging;
-    EXPECT_STREQ(_detail::level_to_str(level::fatal).c_str(), "fatal");
-    EXPECT_STREQ(_detail::level_to_str(level::error).c_str(), "error");
-    EXPECT_STREQ(_detail::level_to_str(level::warn).c_str(), "warning");
-    EXPECT_STREQ(_detail::level_to_str(level::info).c_str(), "info");
-    EXPECT_STREQ(_detail::level_to_str(level::debug).c_str(), "debug");
-    EXPECT_STREQ(_detail::level_to_str(level::trace).c_str(), "trace");
-    EXPECT_STREQ(_detail::level_to_str(static_cast<level>(1337)).c_str(), "unknown");
+    static_assert(_detail::level_to_str(level::fatal) == "fatal"sv);
+    EXPECT_EQ(_detail::level_to_str(level::fatal), "fatal"sv);
+    EXPECT_EQ(_detail::level_to_str(level::error), "error"sv);
+    EXPECT_EQ(_detail::level_to_str(level::warn), "warning"sv);
+    EXPECT_EQ(_detail::level_to_str(level::info), "info"sv);
+    EXPECT_EQ(_detail::level_to_str(level::debug), "debug"sv);
+    EXPECT_EQ(_detail::level_to_str(level::trace), "trace"sv);
+    EXPECT_EQ(_detail::level_to_str(static_cast<level>(1337)), "unknown"sv);
+}
+
+struct point {
+    int x, y;
+};
+
+std::ostream& operator<<(std::ostream& out, point const& p) {
+    return out << "(" << p.x << ", " << p.y << ")";
+}
+
+TEST_F(LoggingTest, logging_user_type) {
+    ext::logging::configuration::filename = false;
+    ext::logging::configuration::function = false;
+    EXT_LOG("babe") << point{1, 2};
+    compare("[babe] warning: '(1, 2)'\n");
+}
+
+TEST_F(LoggingTest, logging_stream_state_is_reset) {
+    ext::logging::configuration::filename = false;
+    ext::logging::configuration::function = false;
+    EXT_LOG("babe") << std::hex << 255;
+    EXT_LOG("babe") << 255;
+    compare("[babe] warning: 'ff'\n[babe] warning: '255'\n");
+}
+
+TEST_F(LoggingTest, logging_long_message) {
+    ext::logging::configuration::filename = false;
+    ext::logging::configuration::function = false;
+    std::string long_message(5000, 'x');
+    EXT_LOG("babe") << long_message;
+    compare("[babe] warning: '" + long_message + "'\n");
+}
+
+struct nested {};
+
+std::ostream& operator<<(std::ostream& out, nested const&) {
+    EXT_LOG("inner") << "inner";
+    return out << "outer";
+}
+
+TEST_F(LoggingTest, logging_nested) {
+    ext::logging::configuration::filename = false;
+    ext::logging::configuration::function = false;
+    EXT_LOG("outer") << nested{};
+    compare("[inner] warning: 'inner'\n[outer] warning: 'outer'\n");
+}
+
+TEST_F(LoggingTest, call_site_prefix_follows_configuration) {
+    using namespace ext::logging;
+    _line = __LINE__ + 4;
+    for (int i = 0; i < 4; ++i) {
+        configuration::filename = i % 2;
+        configuration::function = false;
+        EXT_LOG("cafe") << i;
+    }
+    compare("[cafe] warning: '0'\n[cafe] warning logging.cpp:" + line() + ": '1'\n" +
+            "[cafe] warning: '2'\n[cafe] warning logging.cpp:" + line() + ": '3'\n");
+}
+
+TEST_F(LoggingTest, call_site_prefix_reclaims_replaced) {
+    using namespace ext::logging;
+    configuration::function = false;
+    for (int i = 0; i < 100; ++i) {
+        configuration::filename = i % 2;
+        EXT_LOG("cafe") << i;
+    }
+    // only prefixes another thread may still read are kept
+    EXPECT_LE(_detail::retired_prefixes(), 1u);
+}
+
+namespace {
+// logs when its thread exits - after the thread handed back its hazard slot
+struct logs_at_exit {
+    ~logs_at_exit() {
+        EXT_LOG("e417") << "exit";
+    }
+};
+} // namespace
+
+TEST_F(LoggingTest, call_site_prefix_at_thread_exit) {
+    using namespace ext::logging;
+    configuration::filename = false;
+    configuration::function = false;
+    std::thread([] {
+        thread_local logs_at_exit last;
+        (void) last;
+        EXT_LOG("e417") << "running";
+    }).join();
+    std::thread([] { EXT_LOG("e417") << "next"; }).join();
+    compare("[e417] warning: 'running'\n[e417] warning: 'exit'\n[e417] warning: 'next'\n");
+}
+
+TEST_F(LoggingTest, call_site_enable_by_id) {
+    using namespace ext::logging;
+    configuration::filename = false;
+    configuration::function = false;
+
+    auto log = [](int i) {
+        EXT_LOG("on-off") << i;
+        EXT_LOG("always") << i;
+    };
+
+    log(0);
+    set_enabled("on-off", false);
+    EXPECT_FALSE(is_enabled("on-off"));
+    log(1);
+    set_enabled("on-off", true);
+    EXPECT_TRUE(is_enabled("on-off"));
+    log(2);
+
+    compare("[on-off] warning: '0'\n[always] warning: '0'\n"
+            "[always] warning: '1'\n"
+            "[on-off] warning: '2'\n[always] warning: '2'\n");
+}
+
+TEST_F(LoggingTest, call_site_disabled_before_first_use) {
+    using namespace ext::logging;
+    set_enabled("never-seen", false);
+    EXT_LOG("never-seen") << "will not be logged";
+    set_enabled("never-seen", true);
+    compare("");
+}
+
+// a disabled log statement is a relaxed load and a compare: the topic is taken
+// by reference, the checked level is a lock-free atomic that includes the
+// level of the flight recorder and nothing else is evaluated
+static_assert(std::atomic<ext::logging::level>::is_always_lock_free);
+static_assert(std::is_same_v<decltype(&ext::logging::_detail::variable_level_is_active),
+                             bool (*)(ext::logging::level, ext::logging::_detail::logtopic const&) noexcept>);
+
+TEST_F(LoggingTest, disabled_level_evaluates_nothing) {
+    using namespace ext::logging;
+    int evaluated = 0;
+    auto side_effect = [&evaluated]() { return ++evaluated; };
+
+    set_level(topic::network, level::error);
+    EXT_LOG("quiet", network, warn) << side_effect();
+    EXPECT_EQ(evaluated, 0);
+    compare("");
+
+    set_level(topic::network, level::warn);
+    EXPECT_EQ(get_level(topic::network), level::warn);
+    configuration::filename = false;
+    configuration::function = false;
+    EXT_LOG("quiet", network, warn) << side_effect();
+    EXPECT_EQ(evaluated, 1);
+    compare("[quiet] warning (network): '1'\n");
+}
+
+TEST_F(LoggingTest, change_level_while_logging) {
+    using namespace ext::logging;
+    std::atomic<bool> done{false};
+    std::atomic<int> logged{0};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            while (!done.load()) {
+                EXT_LOG("race", network, info) << "racing";
+                if (variable_level_is_active(level::info, topic::network)) {
+                    ++logged;
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        set_level(topic::network, i % 2 ? level::info : level::error);
+        if (i % 100 == 0) {
+            set_level_all(level::warn);
+        }
+    }
+    set_level(topic::network, level::info);
+    while (logged.load() == 0) {
+        std::this_thread::yield();
+    }
+    done = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_NE(_log.str().find("racing"), std::string::npos);
 }
@@ -0,0 +1,126 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+
+namespace el = ext::logging;
+using el::metrics::counter;
+
+struct MetricsTest : public ::testing::Test {
+    MetricsTest() {
+        using namespace ext::logging;
+        configuration::stream = &_log;
+        configuration::filename = false;
+        configuration::function = false;
+        set_level_all(level::warn);
+        metrics::reset();
+    }
+
+    ~MetricsTest() {
+        using namespace ext::logging;
+        configuration::stream = &std::cout;
+        configuration::filename = true;
+        configuration::function = true;
+    }
+
+    std::stringstream _log;
+};
+
+TEST_F(MetricsTest, counts_emitted_and_suppressed) {
+    if (!el::metrics::enabled) {
+        EXPECT_EQ(el::metrics::collect().total(counter::emitted), 0);
+        GTEST_SKIP() << "compiled without EXT_LOGGING_METRICS";
+    }
+
+    for (int i = 0; i < 5; ++i) {
+        EXT_LOG("m001", network, error) << "counted";
+        EXT_LOG("m002", network, debug) << "suppressed";
+    }
+    EXT_LOG("m003", engine, warn) << "other topic";
+
+    auto snap = el::metrics::collect();
+    EXPECT_EQ(snap.get(el::topic::network, el::level::error, counter::emitted), 5);
+    EXPECT_EQ(snap.get(el::topic::network, el::level::debug, counter::suppressed), 5);
+    EXPECT_EQ(snap.get(el::topic::network, el::level::debug, counter::emitted), 0);
+    EXPECT_EQ(snap.total(el::topic::engine, counter::emitted), 1);
+    EXPECT_EQ(snap.total(counter::bytes), _log.str().size());
+}
+
+TEST_F(MetricsTest, large_topic_ids_do_not_share_the_last_slot) {
+    if (!el::metrics::enabled) {
+        GTEST_SKIP() << "compiled without EXT_LOGGING_METRICS";
+    }
+
+    auto const last = static_cast<int>(el::metrics::max_topics) - 1;
+    el::_detail::count(last, el::level::warn, counter::emitted);
+    el::_detail::count(last + 1, el::level::warn, counter::emitted, 2);
+    el::_detail::count(last + 100, el::level::warn, counter::emitted, 3);
+
+    auto snap = el::metrics::collect();
+    EXPECT_EQ(snap.get(last, el::level::warn, counter::emitted), 1);
+    EXPECT_EQ(snap.get(last + 1, el::level::warn, counter::emitted), 5); // all larger ids
+    EXPECT_EQ(snap.total(counter::emitted), 6);
+}
+
+TEST_F(MetricsTest, sums_exited_threads) {
+    if (!el::metrics::enabled) {
+        GTEST_SKIP() << "compiled without EXT_LOGGING_METRICS";
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([] {
+            for (int i = 0; i < 100; ++i) {
+                EXT_LOG("m004", engine, error) << i;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(el::metrics::collect().get(el::topic::engine, el::level::error, counter::emitted), 400);
+
+    el::metrics::reset();
+    EXPECT_EQ(el::metrics::collect().total(counter::emitted), 0);
+}
+
+TEST_F(MetricsTest, counts_drops) {
+    if (!el::metrics::enabled) {
+        GTEST_SKIP() << "compiled without EXT_LOGGING_METRICS";
+    }
+
+    el::null_sink discard;
+    el::configuration::sink = &discard;
+    el::async::start({4, 4, el::async::full_policy::drop});
+    for (int i = 0; i < 1000; ++i) {
+        EXT_LOG("m005", network, error) << i;
+    }
+    el::async::stop();
+    el::configuration::sink = nullptr;
+
+    auto snap = el::metrics::collect();
+    EXPECT_EQ(snap.total(counter::dropped), el::async::stats().dropped);
+    EXPECT_EQ(snap.total(counter::emitted), 1000);
+}
+
+TEST_F(MetricsTest, top_sites) {
+    if (!el::metrics::enabled) {
+        EXPECT_TRUE(el::metrics::top_sites(3).empty());
+        GTEST_SKIP() << "compiled without EXT_LOGGING_METRICS";
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        EXT_LOG("flood", network, error) << i;
+    }
+    auto top = el::metrics::top_sites(3);
+    ASSERT_FALSE(top.empty());
+    EXPECT_STREQ(top.front().id, "flood");
+    EXPECT_GE(top.front().emitted, 1000);
+    EXPECT_LE(top.size(), 3);
+}
@@ -0,0 +1,136 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+
+namespace el = ext::logging;
+
+struct RecorderTest : public ::testing::Test {
+    RecorderTest() {
+        using namespace ext::logging;
+        configuration::stream = &_log;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = true;
+        configuration::filename = false;
+        configuration::function = false;
+        set_level(topic::network, level::warn);
+    }
+
+    ~RecorderTest() {
+        using namespace ext::logging;
+        recorder::stop();
+        configuration::stream = &std::cout;
+        configuration::filename = true;
+        configuration::function = true;
+    }
+
+    std::string take() {
+        auto result = _log.str();
+        _log.str("");
+        return result;
+    }
+
+    std::stringstream _log;
+};
+
+using RecorderDeathTest = RecorderTest;
+
+TEST_F(RecorderTest, keeps_inactive_levels_in_memory) {
+    el::recorder::start({el::level::debug, 4096});
+    EXPECT_TRUE(el::recorder::active());
+
+    EXT_LOG("cafe", network, debug) << "recorded " << 1;
+    EXT_LOG("babe", network, trace) << "above the record level";
+    EXT_LOG("beef", network, warn) << "written";
+    EXPECT_EQ(take(), "[beef] warning (network): 'written'\n");
+
+    EXPECT_EQ(el::recorder::dump(), 1);
+    EXPECT_EQ(take(), "[cafe] debug (network): 'recorded 1'\n");
+    EXPECT_EQ(el::recorder::dump(), 0); // every message is dumped once
+
+    el::recorder::stop();
+    EXPECT_FALSE(el::recorder::active());
+    EXT_LOG("cafe", network, debug) << "not recorded";
+    EXPECT_EQ(el::recorder::dump(), 0);
+    EXPECT_EQ(take(), "");
+}
+
+TEST_F(RecorderTest, merges_threads_by_time) {
+    el::recorder::start({el::level::trace, 4096});
+    auto log = [](int first) {
+        for (int i = first; i < 6; i += 2) {
+            EXT_LOG("cafe", network, trace) << i;
+        }
+    };
+    // the threads take turns - the second one has exited before the dump
+    std::thread even(log, 0);
+    even.join();
+    std::thread([] { EXT_LOG("babe", network, trace) << "between"; }).join();
+    log(1);
+
+    EXPECT_EQ(el::recorder::dump(), 7);
+    EXPECT_EQ(take(),
+              "[cafe] trace (network): '0'\n"
+              "[cafe] trace (network): '2'\n"
+              "[cafe] trace (network): '4'\n"
+              "[babe] trace (network): 'between'\n"
+              "[cafe] trace (network): '1'\n"
+              "[cafe] trace (network): '3'\n"
+              "[cafe] trace (network): '5'\n");
+}
+
+TEST_F(RecorderTest, memory_is_bounded) {
+    std::size_t const bytes = 512;
+    el::recorder::start({el::level::trace, bytes});
+    for (int i = 0; i < 1000; ++i) {
+        EXT_LOG("cafe", network, debug) << "message " << i;
+    }
+    std::string const long_text(2 * bytes, 'x');
+    EXT_LOG("babe", network, debug) << "short";
+
+    auto const count = el::recorder::dump();
+    auto const dumped = take();
+    EXPECT_GT(count, 5);
+    EXPECT_LT(dumped.size(), bytes);
+    // the newest messages are kept
+    EXPECT_NE(dumped.find("'message 999'\n[babe] debug (network): 'short'\n"), std::string::npos) << dumped;
+    EXPECT_EQ(dumped.find("'message 0'"), std::string::npos);
+
+    EXT_LOG("babe", network, debug) << long_text; // truncated to the buffer
+    EXPECT_EQ(el::recorder::dump(), 1);
+    EXPECT_LT(take().size(), bytes);
+}
+
+TEST_F(RecorderTest, restart_forgets_old_messages) {
+    el::recorder::start();
+    EXT_LOG("cafe", network, debug) << "old";
+    el::recorder::start();
+    EXT_LOG("babe", network, debug) << "new";
+    EXPECT_EQ(el::recorder::dump(), 1);
+    EXPECT_EQ(take(), "[babe] debug (network): 'new'\n");
+}
+
+#ifndef EXT_COMPILER_VC
+TEST_F(RecorderDeathTest, fatal_dumps_the_recorder) {
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    ASSERT_DEATH_IF_SUPPORTED(
+        {
+            el::configuration::stream = &std::cerr;
+            el::recorder::start();
+            EXT_LOG("cafe", network, debug) << "what happened before";
+            EXT_LOG("dead", network, fatal) << "bye";
+        },
+        "\\[cafe\\] debug \\(network\\): 'what happened before'\n\\[dead\\] fatal \\(network\\): 'bye'");
+}
+#endif // EXT_COMPILER_VC
@@ -0,0 +1,208 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#ifndef _WIN32
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+#include <ext/logging/rotating_sink.hpp>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace el = ext::logging;
+namespace fs = std::filesystem;
+
+struct RotatingSinkTest : public ::testing::Test {
+    RotatingSinkTest() {
+        _dir = fs::temp_directory_path() / ("ext-logging-rotating-" + std::to_string(::getpid()));
+        fs::remove_all(_dir);
+        fs::create_directories(_dir);
+    }
+
+    ~RotatingSinkTest() {
+        fs::remove_all(_dir);
+    }
+
+    el::rotating_file_sink::options options(std::size_t segment_size) {
+        el::rotating_file_sink::options opts;
+        opts.directory = _dir.string();
+        opts.base_name = "test";
+        opts.segment_size = segment_size;
+        return opts;
+    }
+
+    std::vector<fs::path> files() {
+        std::vector<fs::path> result;
+        for (auto const& entry : fs::directory_iterator(_dir)) {
+            result.push_back(entry.path());
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    static std::string read_file(fs::path const& path) {
+        std::ifstream in(path);
+        std::stringstream content;
+        content << in.rdbuf();
+        return content.str();
+    }
+
+    static std::string line(int i) {
+        return "line " + std::to_string(i + 1000) + "\n"; // 10 bytes
+    }
+
+    fs::path _dir;
+};
+
+TEST_F(RotatingSinkTest, rotates_on_size) {
+    {
+        el::rotating_file_sink target(options(100));
+        for (int i = 0; i < 35; ++i) {
+            auto text = line(i);
+            target.write({el::level::info, text});
+        }
+    }
+
+    auto all = files();
+    ASSERT_EQ(all.size(), 4);
+    EXPECT_EQ(all[0].filename(), "test.00000000.log");
+
+    std::string content;
+    for (auto const& file : all) {
+        auto part = read_file(file);
+        EXPECT_LE(part.size(), 100);
+        EXPECT_EQ(part.back(), '\n'); // records are not split
+        content += part;
+    }
+
+    std::string expected;
+    for (int i = 0; i < 35; ++i) {
+        expected += line(i);
+    }
+    EXPECT_EQ(expected, content);
+}
+
+TEST_F(RotatingSinkTest, continues_sequence) {
+    {
+        el::rotating_file_sink target(options(100));
+        target.write({el::level::info, "first\n"});
+    }
+    {
+        el::rotating_file_sink target(options(100));
+        EXPECT_EQ(fs::path(target.current_file()).filename(), "test.00000001.log");
+        target.write({el::level::info, "second\n"});
+    }
+    auto all = files();
+    ASSERT_EQ(all.size(), 2);
+    EXPECT_EQ(read_file(all[0]), "first\n");
+    EXPECT_EQ(read_file(all[1]), "second\n");
+}
+
+TEST_F(RotatingSinkTest, ignores_foreign_files) {
+    std::ofstream(_dir / "test.123456789012345678901234567890.log") << "not a segment";
+    std::ofstream(_dir / "test.12a.log") << "not a segment";
+    el::rotating_file_sink target(options(100));
+    EXPECT_EQ(fs::path(target.current_file()).filename(), "test.00000000.log");
+}
+
+TEST_F(RotatingSinkTest, segments_are_allocated) {
+    el::rotating_file_sink target(options(64 * 1024));
+    struct stat info {};
+    ASSERT_EQ(::stat(target.current_file().c_str(), &info), 0);
+    EXPECT_EQ(info.st_size, 64 * 1024);
+    EXPECT_GE(info.st_blocks * 512, 64 * 1024); // not sparse
+}
+
+TEST_F(RotatingSinkTest, retention_file_count) {
+    auto opts = options(100);
+    opts.max_files = 3;
+    {
+        el::rotating_file_sink target(opts);
+        for (int i = 0; i < 100; ++i) {
+            auto text = line(i);
+            target.write({el::level::info, text});
+        }
+    }
+
+    auto all = files();
+    ASSERT_EQ(all.size(), 3);
+    std::string content;
+    for (auto const& file : all) {
+        content += read_file(file);
+    }
+    // the newest records survive
+    EXPECT_EQ(content.substr(content.size() - 10), line(99));
+}
+
+TEST_F(RotatingSinkTest, retention_total_bytes) {
+    auto opts = options(100);
+    opts.max_total_bytes = 250;
+    {
+        el::rotating_file_sink target(opts);
+        for (int i = 0; i < 100; ++i) {
+            auto text = line(i);
+            target.write({el::level::info, text});
+        }
+    }
+
+    std::uint64_t total = 0;
+    for (auto const& file : files()) {
+        total += fs::file_size(file);
+    }
+    EXPECT_LE(total, 250);
+    EXPECT_GT(total, 0);
+}
+
+TEST_F(RotatingSinkTest, oversized_record) {
+    std::string big(250, 'x');
+    {
+        el::rotating_file_sink target(options(100));
+        target.write({el::level::info, big});
+    }
+    std::string content;
+    for (auto const& file : files()) {
+        content += read_file(file);
+    }
+    EXPECT_EQ(big, content);
+}
+
+TEST_F(RotatingSinkTest, rotates_on_time) {
+    auto opts = options(1024);
+    opts.interval = std::chrono::seconds(1);
+    {
+        el::rotating_file_sink target(opts);
+        target.write({el::level::info, "before\n"});
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        target.write({el::level::info, "after\n"});
+    }
+    auto all = files();
+    ASSERT_EQ(all.size(), 2);
+    EXPECT_EQ(read_file(all[0]), "before\n");
+    EXPECT_EQ(read_file(all[1]), "after\n");
+}
+
+TEST_F(RotatingSinkTest, as_logging_sink) {
+    using namespace ext::logging;
+    configuration::filename = false;
+    configuration::function = false;
+    {
+        rotating_file_sink target(options(4096));
+        configuration::sink = &target;
+        EXT_LOG("cafe") << "mapped";
+        configuration::sink = nullptr;
+    }
+    configuration::filename = true;
+    configuration::function = true;
+
+    auto all = files();
+    ASSERT_EQ(all.size(), 1);
+    EXPECT_EQ(read_file(all[0]), "[cafe] warning: 'mapped'\n");
+}
+#endif // _WIN32
@@ -0,0 +1,154 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#ifndef _WIN32
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+#include <ext/logging/sidecar.hpp>
+
+#include <unistd.h>
+
+namespace el = ext::logging;
+namespace es = ext::logging::sidecar;
+namespace fs = std::filesystem;
+
+struct SidecarTest : public ::testing::Test {
+    SidecarTest() {
+        _path = fs::temp_directory_path() / ("ext-logging-sidecar-" + std::to_string(::getpid()) + ".log");
+        fs::remove(_path);
+        fs::remove(index_path());
+    }
+
+    ~SidecarTest() {
+        fs::remove(_path);
+        fs::remove(index_path());
+    }
+
+    std::string index_path() const {
+        return _path.string() + ".idx";
+    }
+
+    std::vector<es::block_entry> entries() {
+        std::vector<es::block_entry> result;
+        EXPECT_TRUE(es::read(index_path(), result));
+        return result;
+    }
+
+    static es::query query(std::vector<std::string_view> ids,
+                           std::vector<std::string_view> topics = {},
+                           el::level max_level = el::level::trace) {
+        es::query q;
+        for (auto id : ids) {
+            q.ids.push_back(el::id_hash(id));
+        }
+        for (auto topic : topics) {
+            q.topics.push_back(el::id_hash(topic));
+        }
+        q.max_level = max_level;
+        return q;
+    }
+
+    fs::path _path;
+};
+
+TEST_F(SidecarTest, parse_line) {
+    es::line_fields fields;
+    ASSERT_TRUE(es::parse_line("[cafe] warning (network) main.cpp:12: 'text'\n", fields));
+    EXPECT_EQ(fields.id, "cafe");
+    EXPECT_EQ(fields.topic, "network");
+    EXPECT_EQ(fields.level_, el::level::warn);
+
+    // behind time and thread
+    ASSERT_TRUE(es::parse_line("2026-10-18 12:00:00.123 {42 worker} [beef] error: 'text'", fields));
+    EXPECT_EQ(fields.id, "beef");
+    EXPECT_EQ(fields.topic, "");
+    EXPECT_EQ(fields.level_, el::level::error);
+
+    EXPECT_TRUE(es::parse_line("{7 [x] y} [babe] trace", fields));
+    EXPECT_EQ(fields.id, "babe");
+    EXPECT_FALSE(es::parse_line("  continued message [with] brackets'\n", fields));
+    EXPECT_FALSE(es::parse_line("", fields));
+}
+
+TEST_F(SidecarTest, blocks_of_records) {
+    {
+        el::file_sink sink(_path.string(), 256, el::level::error, 10);
+        el::configuration::sink = &sink;
+        el::configuration::filename = false;
+        el::configuration::function = false;
+        for (int i = 0; i < 25; ++i) {
+            EXT_LOG("a1a1", network, warn) << "first " << i;
+            EXT_LOG("b2b2", engine, error) << "second " << i;
+        }
+        // without call site - indexed by the text
+        sink.write({el::level::info, "[c3c3] info (network): 'raw'\n"});
+        el::configuration::sink = nullptr;
+        el::configuration::filename = true;
+        el::configuration::function = true;
+    }
+
+    auto const all = entries();
+    ASSERT_EQ(all.size(), 6); // 51 records
+    std::uint64_t end = 0, records = 0;
+    for (auto const& entry : all) {
+        EXPECT_EQ(entry.offset, end);
+        EXPECT_LE(entry.first, entry.last);
+        EXPECT_EQ(entry.levels & es::unindexed, 0);
+        end += entry.size;
+        records += entry.records;
+    }
+    EXPECT_EQ(end, fs::file_size(_path));
+    EXPECT_EQ(records, 51);
+
+    EXPECT_TRUE(es::may_match(all[0], query({"a1a1"})));
+    EXPECT_TRUE(es::may_match(all[0], query({"zzzz", "b2b2"})));
+    EXPECT_FALSE(es::may_match(all[0], query({"c3c3"})));
+    EXPECT_TRUE(es::may_match(all[5], query({"c3c3"}, {"network"}, el::level::info)));
+    EXPECT_FALSE(es::may_match(all[5], query({"c3c3"}, {"network"}, el::level::warn)));
+    EXPECT_FALSE(es::may_match(all[0], query({}, {"nothing"})));
+    EXPECT_TRUE(es::may_match(all[0], query({}, {"engine"}, el::level::error)));
+    EXPECT_FALSE(es::may_match(all[0], query({}, {}, el::level::fatal)));
+
+    // each block starts with a record
+    std::ifstream in(_path, std::ios::binary);
+    std::stringstream content;
+    content << in.rdbuf();
+    for (auto const& entry : all) {
+        es::line_fields fields;
+        auto const line = content.str().substr(entry.offset, entry.size);
+        ASSERT_TRUE(es::parse_line(line.substr(0, line.find('\n')), fields));
+        EXPECT_TRUE(es::matches(fields, query({fields.id})));
+        EXPECT_FALSE(es::matches(fields, query({"zzzz"})));
+    }
+}
+
+TEST_F(SidecarTest, appends_and_marks_unknown_records) {
+    {
+        el::file_sink sink(_path.string(), 64, el::level::error, 2);
+        sink.write({el::level::info, "[d4d4] info: 'one'\n"});
+        sink.write({el::level::info, "no fixed fields\n"});
+    }
+    {
+        // continues behind the existing content
+        el::file_sink sink(_path.string(), 64, el::level::error, 2);
+        sink.write({el::level::debug, "[e5e5] debug: 'two'\n"});
+    }
+
+    auto const all = entries();
+    ASSERT_EQ(all.size(), 2);
+    EXPECT_NE(all[0].levels & es::unindexed, 0);
+    EXPECT_TRUE(es::may_match(all[0], query({"e5e5"}))); // can not be excluded
+    EXPECT_EQ(all[1].offset, all[0].size);
+    EXPECT_EQ(all[1].offset + all[1].size, fs::file_size(_path));
+    EXPECT_FALSE(es::may_match(all[1], query({"d4d4"})));
+
+    es::query timed;
+    timed.to = all[1].first - 1;
+    EXPECT_FALSE(es::may_match(all[1], timed));
+}
+#endif // _WIN32
@@ -0,0 +1,288 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+
+#ifndef _WIN32
+    #include <unistd.h>
+#endif // _WIN32
+
+using namespace std::literals;
+namespace el = ext::logging;
+
+struct SinkTest : public ::testing::Test {
+    SinkTest() {
+        using namespace ext::logging;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = true;
+        configuration::filename = false;
+        configuration::function = false;
+        set_level_all(level::trace);
+    };
+
+    ~SinkTest() {
+        el::async::stop();
+        el::configuration::sink = nullptr;
+        el::configuration::stream = &std::cout;
+    }
+
+    static std::string read_file(std::string const& path) {
+        std::ifstream in(path);
+        std::stringstream content;
+        content << in.rdbuf();
+        return content.str();
+    }
+};
+
+// remembers the text pointers to check that all sinks get the same buffer
+struct recording_sink : el::sink {
+    using el::sink::write;
+    void write(el::record const& rec) override {
+        texts.push_back(rec.text.data());
+        payloads.emplace_back(rec.text.substr(rec.payload));
+        out << rec.text;
+        records.fetch_add(1);
+    }
+    void flush() override {
+        ++flushes;
+    }
+
+    std::vector<char const*> texts;
+    std::vector<std::string> payloads;
+    std::stringstream out;
+    int flushes = 0;
+    std::atomic<int> records{0}; // written last - the timer of `coalescing_sink` writes too
+};
+
+TEST_F(SinkTest, ostream_sink) {
+    std::stringstream out;
+    el::ostream_sink target(out);
+    el::configuration::sink = &target;
+    EXT_LOG("cafe") << "to the sink";
+    EXPECT_EQ("[cafe] warning: 'to the sink'\n", out.str());
+}
+
+TEST_F(SinkTest, fanout_level_filter) {
+    auto errors = std::make_shared<recording_sink>();
+    auto all = std::make_shared<recording_sink>();
+    el::fanout_sink fanout;
+    fanout.add(errors, el::level::error);
+    fanout.add(all);
+    el::configuration::sink = &fanout;
+
+    EXT_LOG("cafe", error) << "broken";
+    EXT_LOG("babe", info) << "fine";
+
+    EXPECT_EQ("[cafe] error: 'broken'\n", errors->out.str());
+    EXPECT_EQ("[cafe] error: 'broken'\n[babe] info: 'fine'\n", all->out.str());
+
+    // formatted once - both children got the same text
+    ASSERT_EQ(errors->texts.size(), 1);
+    ASSERT_EQ(all->texts.size(), 2);
+    EXPECT_EQ(errors->texts[0], all->texts[0]);
+}
+
+TEST_F(SinkTest, fanout_async_batches) {
+    auto errors = std::make_shared<recording_sink>();
+    auto all = std::make_shared<recording_sink>();
+    el::fanout_sink fanout;
+    fanout.add(errors, el::level::error);
+    fanout.add(all);
+    el::configuration::sink = &fanout;
+
+    el::async::start();
+    for (int i = 0; i < 200; ++i) {
+        if (i % 2) {
+            EXT_LOG("cafe", info) << i;
+        } else {
+            EXT_LOG("cafe", error) << i;
+        }
+    }
+    el::async::flush();
+
+    std::string expected_errors, expected_all;
+    for (int i = 0; i < 200; ++i) {
+        auto line = (i % 2 ? "[cafe] info: '"s : "[cafe] error: '"s) + std::to_string(i) + "'\n";
+        expected_all += line;
+        if (i % 2 == 0) {
+            expected_errors += line;
+        }
+    }
+    EXPECT_EQ(expected_errors, errors->out.str());
+    EXPECT_EQ(expected_all, all->out.str());
+    EXPECT_GT(all->flushes, 0);
+}
+
+#ifndef _WIN32
+TEST_F(SinkTest, fd_sink) {
+    char path[] = "/tmp/ext-logging-fd-XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+
+    {
+        el::fd_sink target(path);
+        el::configuration::sink = &target;
+        EXT_LOG("cafe") << "first";
+
+        // writev path
+        el::async::start();
+        for (int i = 0; i < 100; ++i) {
+            EXT_LOG("babe") << i;
+        }
+        el::async::stop();
+        el::configuration::sink = nullptr;
+    }
+
+    std::string expected = "[cafe] warning: 'first'\n";
+    for (int i = 0; i < 100; ++i) {
+        expected += "[babe] warning: '" + std::to_string(i) + "'\n";
+    }
+    EXPECT_EQ(expected, read_file(path));
+    std::remove(path);
+}
+
+TEST_F(SinkTest, file_sink_buffers) {
+    char path[] = "/tmp/ext-logging-file-XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+
+    std::string expected;
+    {
+        el::file_sink target(path, 1024);
+        el::configuration::sink = &target;
+        EXT_LOG("cafe") << "buffered";
+        EXPECT_EQ("", read_file(path));
+
+        EXT_LOG("babe", error) << "flushes";
+        expected = "[cafe] warning: 'buffered'\n[babe] error: 'flushes'\n"s;
+        EXPECT_EQ(expected, read_file(path));
+
+        // larger than the buffer - written directly
+        EXT_LOG("dead") << std::string(2000, 'x');
+        expected += "[dead] warning: '" + std::string(2000, 'x') + "'\n";
+        EXPECT_EQ(expected, read_file(path));
+
+        EXT_LOG("beef") << "on destruction";
+        el::configuration::sink = nullptr;
+    }
+    EXPECT_EQ(expected + "[beef] warning: 'on destruction'\n", read_file(path));
+    std::remove(path);
+}
+#endif // _WIN32
+
+TEST_F(SinkTest, coalescing_same_message) {
+    auto out = std::make_shared<recording_sink>();
+    {
+        el::coalescing_sink target(out, std::chrono::seconds(60));
+        el::configuration::sink = &target;
+        for (int i = 0; i < 5; ++i) {
+            EXT_LOG("cafe", error) << "reconnect failed";
+        }
+        EXT_LOG("babe", error) << "other";
+        for (int i = 0; i < 3; ++i) {
+            EXT_LOG("cafe", error) << "value " << i;
+        }
+        el::configuration::sink = nullptr;
+    }
+    EXPECT_EQ(out->out.str(),
+              "[cafe] error: 'reconnect failed'\n"
+              "[cafe] error: 'last message repeated 4 times'\n"
+              "[babe] error: 'other'\n"
+              "[cafe] error: 'value 0'\n"
+              "[cafe] error: 'value 1'\n"
+              "[cafe] error: 'value 2'\n");
+}
+
+TEST_F(SinkTest, coalescing_same_site) {
+    auto out = std::make_shared<recording_sink>();
+    {
+        el::coalescing_sink target(out, std::chrono::seconds(60), el::coalescing_sink::match::site);
+        el::configuration::sink = &target;
+        for (int i = 0; i < 3; ++i) {
+            EXT_LOG("cafe", error) << "value " << i;
+        }
+        el::configuration::sink = nullptr;
+    }
+    EXPECT_EQ(out->out.str(), "[cafe] error: 'value 0'\n[cafe] error: 'last message repeated 2 times'\n");
+}
+
+TEST_F(SinkTest, coalescing_window) {
+    auto out = std::make_shared<recording_sink>();
+    el::coalescing_sink target(out, std::chrono::milliseconds(50));
+    el::configuration::sink = &target;
+    auto log = [] { EXT_LOG("cafe", error) << "burst"; };
+
+    log();
+    log();
+    target.flush(); // within the window - summary is kept back
+    EXPECT_EQ(out->out.str(), "[cafe] error: 'burst'\n");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    target.flush();
+    log(); // starts a new burst
+    el::configuration::sink = nullptr;
+    EXPECT_EQ(out->out.str(),
+              "[cafe] error: 'burst'\n"
+              "[cafe] error: 'last message repeated 1 times'\n"
+              "[cafe] error: 'burst'\n");
+}
+
+TEST_F(SinkTest, coalescing_timer_writes_summary) {
+    auto out = std::make_shared<recording_sink>();
+    el::coalescing_sink target(out, std::chrono::milliseconds(20));
+    el::configuration::sink = &target;
+    for (int i = 0; i < 3; ++i) {
+        EXT_LOG("cafe", error) << "burst";
+    }
+    el::configuration::sink = nullptr;
+
+    // no record follows the burst
+    for (int i = 0; i < 200 && out->records.load() < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(out->records.load(), 2);
+    EXPECT_EQ(out->payloads.back(), "last message repeated 2 times'\n");
+}
+
+TEST_F(SinkTest, coalescing_async_batches) {
+    auto out = std::make_shared<recording_sink>();
+    {
+        el::coalescing_sink target(out, std::chrono::seconds(60));
+        el::configuration::sink = &target;
+        el::async::start();
+        for (int i = 0; i < 1000; ++i) {
+            EXT_LOG("cafe", error) << "same";
+        }
+        EXT_LOG("babe", error) << "done";
+        el::async::stop();
+        el::configuration::sink = nullptr;
+    }
+    EXPECT_EQ(out->out.str(),
+              "[cafe] error: 'same'\n"
+              "[cafe] error: 'last message repeated 999 times'\n"
+              "[babe] error: 'done'\n");
+}
+
+TEST_F(SinkTest, coalescing_never_delays_fatal) {
+    static el::_detail::call_site site{"dead", &el::topic::no_topic, el::level::fatal, __FILE__, __LINE__, "f"};
+    auto out = std::make_shared<recording_sink>();
+    el::coalescing_sink target(out, std::chrono::seconds(60));
+    for (int i = 0; i < 3; ++i) {
+        target.write(el::record{el::level::fatal, "fatal\n", &site, 0});
+    }
+    EXPECT_EQ(out->out.str(), "fatal\nfatal\nfatal\n");
+}
@@ -0,0 +1,257 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#ifndef _WIN32
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+#include <ext/logging/socket_sink.hpp>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace el = ext::logging;
+
+namespace {
+// stands in for the collector daemon - keeps everything it receives
+class test_collector {
+public:
+    test_collector(std::string path, el::socket_sink::socket_type type) : _path(std::move(path)), _type(type) {}
+
+    ~test_collector() {
+        stop();
+    }
+
+    void start() {
+        ::unlink(_path.c_str());
+        bool const stream = _type == el::socket_sink::socket_type::stream;
+        _listen = ::socket(AF_UNIX, stream ? SOCK_STREAM : SOCK_DGRAM, 0);
+        ::sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, _path.c_str());
+        ASSERT_EQ(::bind(_listen, reinterpret_cast<::sockaddr*>(&address), sizeof(address)), 0);
+        if (stream) {
+            ASSERT_EQ(::listen(_listen, 4), 0);
+        }
+        _stop = false;
+        _thread = std::thread([this, stream] { run(stream); });
+    }
+
+    // closes all connections and removes the socket
+    void stop() {
+        if (!_thread.joinable()) {
+            return;
+        }
+        _stop = true;
+        _thread.join();
+        ::close(_listen);
+        ::unlink(_path.c_str());
+    }
+
+    std::vector<std::string> records() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _records;
+    }
+
+    bool wait_for(std::size_t count) {
+        auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (records().size() < count) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+private:
+    void run(bool stream) {
+        std::vector<::pollfd> fds{{_listen, POLLIN, 0}};
+        std::string partial; // of the stream connections - one at a time in these tests
+        char buffer[64 * 1024];
+        while (!_stop) {
+            ::poll(fds.data(), fds.size(), 5);
+            for (std::size_t i = 0; i < fds.size(); ++i) {
+                if (!(fds[i].revents & (POLLIN | POLLHUP))) {
+                    continue;
+                }
+                if (stream && i == 0) {
+                    fds.push_back({::accept(_listen, nullptr, nullptr), POLLIN, 0});
+                    continue;
+                }
+                auto const size = ::recv(fds[i].fd, buffer, sizeof(buffer), 0);
+                if (size <= 0) {
+                    ::close(fds[i].fd);
+                    fds.erase(fds.begin() + static_cast<std::ptrdiff_t>(i--));
+                    partial.clear(); // a broken line is sent again
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!stream) {
+                    _records.emplace_back(buffer, static_cast<std::size_t>(size));
+                    continue;
+                }
+                partial.append(buffer, static_cast<std::size_t>(size));
+                for (auto end = partial.find('\n'); end != std::string::npos; end = partial.find('\n')) {
+                    _records.push_back(partial.substr(0, end + 1));
+                    partial.erase(0, end + 1);
+                }
+            }
+        }
+        for (std::size_t i = 1; i < fds.size(); ++i) {
+            ::close(fds[i].fd);
+        }
+    }
+
+    std::string _path;
+    el::socket_sink::socket_type _type;
+    int _listen = -1;
+    std::atomic<bool> _stop{false};
+    std::thread _thread;
+    std::mutex _mutex;
+    std::vector<std::string> _records;
+};
+
+std::string line(int i) {
+    return "record " + std::to_string(i) + "\n";
+}
+
+el::socket_sink::options options(std::string const& path, el::socket_sink::socket_type type) {
+    el::socket_sink::options opts;
+    opts.path = path;
+    opts.type = type;
+    opts.retry_interval = std::chrono::milliseconds(0);
+    return opts;
+}
+} // namespace
+
+struct SocketSinkTest : public ::testing::TestWithParam<el::socket_sink::socket_type> {
+    std::string const _path = "ext-logging-" + std::to_string(::getpid()) + ".sock";
+};
+
+TEST_P(SocketSinkTest, batches_records) {
+    test_collector collector(_path, GetParam());
+    collector.start();
+
+    auto opts = options(_path, GetParam());
+    opts.batch_size = 4096;
+    el::socket_sink sink(opts);
+    EXPECT_TRUE(sink.connected());
+
+    std::vector<std::string> texts;
+    std::vector<el::record> records;
+    for (int i = 0; i < 1000; ++i) {
+        texts.push_back(line(i));
+    }
+    for (auto const& text : texts) {
+        records.push_back({el::level::info, text});
+    }
+    sink.write(records.data(), 500);
+    for (std::size_t i = 500; i < records.size(); ++i) {
+        sink.write(records[i]);
+    }
+    sink.flush();
+    EXPECT_EQ(sink.pending(), 0);
+
+    ASSERT_TRUE(collector.wait_for(texts.size()));
+    EXPECT_EQ(collector.records(), texts);
+    auto const stats = sink.stats();
+    EXPECT_EQ(stats.records, texts.size());
+    EXPECT_EQ(stats.dropped, 0);
+    // many records per system call - datagrams are limited by the collector's queue
+    EXPECT_LT(stats.sends, texts.size() / (GetParam() == el::socket_sink::socket_type::stream ? 10 : 2));
+}
+
+TEST_P(SocketSinkTest, reconnects_without_losing_records) {
+    test_collector collector(_path, GetParam());
+    el::socket_sink sink(options(_path, GetParam()));
+    EXPECT_FALSE(sink.connected());
+
+    // nobody listens yet
+    auto const first = line(1), second = line(2), third = line(3);
+    sink.write({el::level::info, first});
+    sink.write({el::level::info, second});
+    EXPECT_EQ(sink.pending(), first.size() + second.size());
+
+    collector.start();
+    sink.flush();
+    ASSERT_TRUE(collector.wait_for(2));
+
+    // the collector goes away and comes back
+    collector.stop();
+    sink.write({el::level::info, third});
+    sink.flush();
+    EXPECT_FALSE(sink.connected());
+    collector.start();
+    sink.write({el::level::error, line(4)}); // flushes
+    ASSERT_TRUE(collector.wait_for(4));
+    EXPECT_EQ(collector.records(), (std::vector<std::string>{first, second, third, line(4)}));
+    EXPECT_EQ(sink.stats().connects, 2);
+}
+
+TEST_P(SocketSinkTest, urgent_record_does_not_wait) {
+    auto opts = options(_path, GetParam());
+    opts.flush_timeout = std::chrono::milliseconds(300);
+    el::socket_sink sink(opts);
+
+    // nobody listens - only flush and the destructor wait for the collector
+    auto const start = std::chrono::steady_clock::now();
+    sink.write({el::level::error, line(1)});
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(150));
+    EXPECT_EQ(sink.pending(), line(1).size());
+}
+
+TEST_P(SocketSinkTest, bounded_buffer) {
+    auto opts = options(_path, GetParam());
+    opts.buffer_size = 100;
+    el::socket_sink sink(opts);
+
+    std::vector<std::string> texts;
+    for (int i = 0; i < 20; ++i) {
+        texts.push_back(line(i)); // 9 bytes
+    }
+    for (auto const& text : texts) {
+        sink.write({el::level::info, text});
+    }
+    EXPECT_LE(sink.pending(), 100);
+    EXPECT_EQ(sink.stats().dropped, 9);
+
+    test_collector collector(_path, GetParam());
+    collector.start();
+    sink.flush();
+    ASSERT_TRUE(collector.wait_for(11));
+    EXPECT_EQ(collector.records(), std::vector<std::string>(texts.begin(), texts.begin() + 11));
+}
+
+TEST_P(SocketSinkTest, as_configured_sink) {
+    test_collector collector(_path, GetParam());
+    collector.start();
+    el::socket_sink sink(options(_path, GetParam()));
+
+    el::configuration::sink = &sink;
+    el::configuration::filename = false;
+    el::configuration::function = false;
+    EXT_LOG("50c7", network, warn) << "to the collector";
+    el::configuration::sink = nullptr;
+    el::configuration::filename = true;
+    el::configuration::function = true;
+
+    sink.flush();
+    ASSERT_TRUE(collector.wait_for(1));
+    EXPECT_EQ(collector.records().front(), "[50c7] warning (network): 'to the collector'\n");
+}
+
+INSTANTIATE_TEST_SUITE_P(SocketTypes,
+                         SocketSinkTest,
+                         ::testing::Values(el::socket_sink::socket_type::stream, el::socket_sink::socket_type::datagram));
+#endif // _WIN32
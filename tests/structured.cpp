@@ -0,0 +1,344 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <cmath>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+
+namespace el = ext::logging;
+
+namespace {
+using fields = std::map<std::string, std::string>;
+
+// Strict parser of a flat json object - values are kept as text, strings are
+// unescaped and numbers, bools and null are kept as written.
+struct json_parser {
+    std::string_view in;
+
+    bool eat(char c) {
+        if (in.empty() || in.front() != c) {
+            return false;
+        }
+        in.remove_prefix(1);
+        return true;
+    }
+
+    std::optional<std::string> string() {
+        if (!eat('"')) {
+            return std::nullopt;
+        }
+        std::string out;
+        while (!in.empty()) {
+            char c = in.front();
+            in.remove_prefix(1);
+            if (c == '"') {
+                return out;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return std::nullopt; // control characters must be escaped
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (in.empty()) {
+                return std::nullopt;
+            }
+            c = in.front();
+            in.remove_prefix(1);
+            switch (c) {
+                case '"':
+                case '\\':
+                case '/':
+                    out += c;
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'u':
+                    if (in.size() < 4) {
+                        return std::nullopt;
+                    }
+                    out += static_cast<char>(std::stoi(std::string(in.substr(0, 4)), nullptr, 16));
+                    in.remove_prefix(4);
+                    break;
+                default:
+                    return std::nullopt;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<std::string> scalar() {
+        if (!in.empty() && in.front() == '"') {
+            return string();
+        }
+        auto const end = in.find_first_of(",}");
+        if (end == 0 || end == std::string_view::npos) {
+            return std::nullopt;
+        }
+        std::string value(in.substr(0, end));
+        in.remove_prefix(end);
+        if (value == "true" || value == "false" || value == "null") {
+            return value;
+        }
+        std::size_t used = 0;
+        try {
+            std::stod(value, &used);
+        } catch (...) {
+            return std::nullopt;
+        }
+        return used == value.size() ? std::optional<std::string>(value) : std::nullopt;
+    }
+
+    std::optional<fields> object() {
+        fields out;
+        if (!eat('{')) {
+            return std::nullopt;
+        }
+        do {
+            auto key = string();
+            if (!key || !eat(':')) {
+                return std::nullopt;
+            }
+            auto value = scalar();
+            if (!value || out.count(*key)) {
+                return std::nullopt;
+            }
+            out[*key] = *value;
+        } while (eat(','));
+        if (!eat('}') || !eat('\n') || !in.empty()) {
+            return std::nullopt;
+        }
+        return out;
+    }
+};
+
+std::optional<fields> parse_json(std::string_view line) {
+    return json_parser{line}.object();
+}
+
+// logfmt: key=value pairs separated by a space, values may be quoted
+std::optional<fields> parse_logfmt(std::string_view line) {
+    fields out;
+    if (line.empty() || line.back() != '\n') {
+        return std::nullopt;
+    }
+    line.remove_suffix(1);
+    while (!line.empty()) {
+        auto const equal = line.find('=');
+        if (equal == 0 || equal == std::string_view::npos) {
+            return std::nullopt;
+        }
+        std::string key(line.substr(0, equal));
+        if (key.find_first_of(" \"") != std::string::npos || out.count(key)) {
+            return std::nullopt;
+        }
+        line.remove_prefix(equal + 1);
+
+        std::string value;
+        if (!line.empty() && line.front() == '"') {
+            json_parser quoted{line};
+            auto text = quoted.string();
+            if (!text) {
+                return std::nullopt;
+            }
+            value = *text;
+            line = quoted.in;
+        } else {
+            auto const end = line.find(' ');
+            value = line.substr(0, end);
+            if (value.find_first_of("\"=") != std::string::npos) {
+                return std::nullopt;
+            }
+            line.remove_prefix(end == std::string_view::npos ? line.size() : end);
+        }
+        out[key] = value;
+        if (!line.empty() && (line.front() != ' ' || line.size() == 1)) {
+            return std::nullopt;
+        }
+        if (!line.empty()) {
+            line.remove_prefix(1);
+        }
+    }
+    return out;
+}
+
+struct point {
+    int x, y;
+};
+std::ostream& operator<<(std::ostream& out, point const& p) {
+    return out << "(" << p.x << ", " << p.y << ")";
+}
+} // namespace
+
+struct StructuredTest : public ::testing::Test {
+    StructuredTest() {
+        using namespace ext::logging;
+        configuration::stream = &_log;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = true;
+        configuration::filename = true;
+        configuration::function = true;
+    }
+
+    ~StructuredTest() {
+        using namespace ext::logging;
+        configuration::format = output_format::text;
+        configuration::timestamp = timestamp_precision::none;
+        configuration::threads = false;
+        configuration::stream = &std::cout;
+    }
+
+    std::string take() {
+        auto result = _log.str();
+        _log.str("");
+        return result;
+    }
+
+    std::stringstream _log;
+};
+
+std::string const nasty = "quote \" backslash \\ newline \n tab \t bell \a = end";
+
+TEST_F(StructuredTest, text_is_the_default) {
+    EXPECT_EQ(el::configuration::format, el::output_format::text);
+    el::configuration::filename = false;
+    el::configuration::function = false;
+    EXT_LOG("cafe").kv("user", 42).kv("name", "jane doe").kv("ok", true) << "login";
+    EXPECT_EQ(take(), "[cafe] warning: 'login' user=42 name=\"jane doe\" ok=true\n");
+}
+
+TEST_F(StructuredTest, json_parses) {
+    el::configuration::format = el::output_format::json;
+    el::configuration::timestamp = el::timestamp_precision::milliseconds;
+    el::configuration::threads = true;
+    el::set_thread_name("json \"worker\"");
+    el::context request("request", 17);
+    el::context path("path", "/a b");
+
+    int const logged_line = __LINE__ + 1;
+    EXT_LOG("cafe", network, error)
+            .kv("user", 42)
+            .kv("latency_us", 12.5)
+            .kv("nan", std::nan(""))
+            .kv("ok", false)
+            .kv("text", nasty)
+            .kv("point", point{1, 2})
+        << "message with " << nasty;
+    el::set_thread_name("");
+
+    auto const line = take();
+    auto const parsed = parse_json(line);
+    ASSERT_TRUE(parsed) << line;
+    auto& f = *parsed;
+    EXPECT_EQ(f.at("id"), "cafe");
+    EXPECT_EQ(f.at("level"), "error");
+    EXPECT_EQ(f.at("topic"), "network");
+    EXPECT_EQ(f.at("file"), "structured.cpp");
+    EXPECT_EQ(f.at("function"), "TestBody");
+    EXPECT_EQ(f.at("line"), std::to_string(logged_line));
+    EXPECT_EQ(f.at("msg"), "message with " + nasty);
+    EXPECT_EQ(f.at("thread"), "json \"worker\"");
+    EXPECT_EQ(f.at("tid"), std::to_string(el::thread_id()));
+    EXPECT_EQ(f.at("time").size(), std::string("2020-01-01T00:00:00.000Z").size());
+    EXPECT_EQ(f.at("request"), "17");
+    EXPECT_EQ(f.at("path"), "/a b");
+    EXPECT_EQ(f.at("user"), "42");
+    EXPECT_EQ(f.at("latency_us"), "12.5");
+    EXPECT_EQ(f.at("nan"), "null");
+    EXPECT_EQ(f.at("ok"), "false");
+    EXPECT_EQ(f.at("text"), nasty);
+    EXPECT_EQ(f.at("point"), "(1, 2)");
+}
+
+TEST_F(StructuredTest, logfmt_parses) {
+    el::configuration::format = el::output_format::logfmt;
+    el::configuration::timestamp = el::timestamp_precision::microseconds;
+    el::configuration::filename = false;
+    el::configuration::function = false;
+
+    EXT_LOG("cafe").kv("user", 42).kv("bad key=", "x").kv("empty", "").kv("text", nasty) << "plain";
+    EXT_LOG("babe") << nasty;
+    EXT_LOG("dead") << "";
+
+    std::string line;
+    std::istringstream lines(take());
+    std::vector<fields> parsed;
+    // the nasty newline is escaped - every record is one line
+    while (std::getline(lines, line)) {
+        auto f = parse_logfmt(line + "\n");
+        ASSERT_TRUE(f) << line;
+        parsed.push_back(*f);
+    }
+    ASSERT_EQ(parsed.size(), 3);
+    EXPECT_EQ(parsed[0].at("id"), "cafe");
+    EXPECT_EQ(parsed[0].at("level"), "warning");
+    EXPECT_EQ(parsed[0].at("msg"), "plain");
+    EXPECT_EQ(parsed[0].at("user"), "42");
+    EXPECT_EQ(parsed[0].at("bad_key_"), "x");
+    EXPECT_EQ(parsed[0].at("empty"), "");
+    EXPECT_EQ(parsed[0].at("text"), nasty);
+    EXPECT_EQ(parsed[0].count("file"), 0);
+    EXPECT_EQ(parsed[0].at("time").size(), std::string("2020-01-01T00:00:00.000000Z").size());
+    EXPECT_EQ(parsed[1].at("msg"), nasty);
+    EXPECT_EQ(parsed[2].at("msg"), "");
+}
+
+TEST_F(StructuredTest, limited_and_coalesced_lines_parse) {
+    el::configuration::format = el::output_format::json;
+    for (int i = 0; i < 3; ++i) {
+        EXT_LOG_EVERY_N(2, "cafe") << "every " << i;
+    }
+    auto const first = take();
+    std::istringstream lines(first);
+    std::string line;
+    std::vector<fields> parsed;
+    while (std::getline(lines, line)) {
+        auto f = parse_json(line + "\n");
+        ASSERT_TRUE(f) << line;
+        parsed.push_back(*f);
+    }
+    ASSERT_EQ(parsed.size(), 2);
+    EXPECT_EQ(parsed[1].at("suppressed"), "1");
+
+    std::stringstream collected;
+    {
+        el::coalescing_sink coalescing(std::make_shared<el::ostream_sink>(collected), std::chrono::seconds(60));
+        el::configuration::sink = &coalescing;
+        for (int i = 0; i < 3; ++i) {
+            EXT_LOG("babe") << "again";
+        }
+        el::configuration::sink = nullptr;
+    }
+    std::getline(collected, line);
+    std::getline(collected, line);
+    auto summary = parse_json(line + "\n");
+    ASSERT_TRUE(summary) << line;
+    EXPECT_EQ(summary->at("msg"), "last message repeated 2 times");
+}
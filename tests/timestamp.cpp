@@ -0,0 +1,122 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <cctype>
+#include <ctime>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+
+namespace el = ext::logging;
+
+struct TimestampTest : public ::testing::Test {
+    TimestampTest() {
+        using namespace ext::logging;
+        configuration::stream = &_log;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = true;
+        configuration::filename = false;
+        configuration::function = false;
+    }
+
+    ~TimestampTest() {
+        using namespace ext::logging;
+        configuration::timestamp = timestamp_precision::none;
+        configuration::utc = true;
+        configuration::coarse_clock = false;
+        configuration::stream = &std::cout;
+        configuration::filename = true;
+        configuration::function = true;
+    }
+
+    static std::string format() {
+        char out[el::_detail::timestamp_max_size];
+        return std::string(out, el::_detail::format_timestamp(out));
+    }
+
+    // "YYYY-MM-DD HH:MM:SS.<digits> "
+    static bool well_formed(std::string const& stamp, std::size_t digits) {
+        auto const pattern = "dddd-dd-dd dd:dd:dd." + std::string(digits, 'd') + " ";
+        if (stamp.size() != pattern.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < stamp.size(); ++i) {
+            bool const ok = pattern[i] == 'd' ? std::isdigit(static_cast<unsigned char>(stamp[i])) != 0
+                                              : stamp[i] == pattern[i];
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::stringstream _log;
+};
+
+TEST_F(TimestampTest, off_by_default) {
+    EXPECT_EQ(format(), "");
+    EXT_LOG("cafe") << "no time";
+    EXPECT_EQ(_log.str(), "[cafe] warning: 'no time'\n");
+}
+
+TEST_F(TimestampTest, precisions) {
+    using el::timestamp_precision;
+    el::configuration::timestamp = timestamp_precision::milliseconds;
+    EXPECT_TRUE(well_formed(format(), 3)) << format();
+    el::configuration::timestamp = timestamp_precision::microseconds;
+    EXPECT_TRUE(well_formed(format(), 6)) << format();
+    el::configuration::timestamp = timestamp_precision::nanoseconds;
+    EXPECT_TRUE(well_formed(format(), 9)) << format();
+    el::configuration::coarse_clock = true;
+    EXPECT_TRUE(well_formed(format(), 9)) << format();
+}
+
+#ifndef _WIN32
+TEST_F(TimestampTest, matches_system_clock) {
+    el::configuration::timestamp = el::timestamp_precision::milliseconds;
+    for (bool utc : {true, false}) {
+        el::configuration::utc = utc;
+        std::string stamp;
+        char expected[32];
+        // the minute may change in between - try twice
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            std::time_t now = std::time(nullptr);
+            std::tm parts{};
+            utc ? gmtime_r(&now, &parts) : localtime_r(&now, &parts);
+            std::strftime(expected, sizeof(expected), "%Y-%m-%d %H:%M", &parts);
+            stamp = format();
+            if (stamp.compare(0, 16, expected) == 0) {
+                break;
+            }
+        }
+        EXPECT_EQ(stamp.substr(0, 16), expected) << "utc: " << utc;
+    }
+}
+#endif // _WIN32
+
+TEST_F(TimestampTest, in_prefix) {
+    el::configuration::timestamp = el::timestamp_precision::microseconds;
+    EXT_LOG("cafe") << "with time";
+    auto line = _log.str();
+    ASSERT_GT(line.size(), 27);
+    EXPECT_TRUE(well_formed(line.substr(0, 27), 6)) << line;
+    EXPECT_EQ(line.substr(27), "[cafe] warning: 'with time'\n");
+
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+    // the time goes in front of the log line
+    _log.str("");
+    el::configuration::gdb = true;
+    EXT_LOG("babe") << "gdb";
+    line = _log.str();
+    auto const first = line.find('\n') + 1;
+    EXPECT_EQ(line.compare(0, 8, "# break "), 0);
+    EXPECT_TRUE(well_formed(line.substr(first, 27), 6)) << line;
+    EXPECT_EQ(line.substr(first + 27), "[babe] warning: 'gdb'\n");
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+}
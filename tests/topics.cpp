@@ -0,0 +1,136 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+
+namespace el = ext::logging;
+
+struct TopicsTest : public ::testing::Test {
+    TopicsTest() {
+        using namespace ext::logging;
+        configuration::stream = &_log;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = true;
+        configuration::filename = false;
+        configuration::function = false;
+        clear_configured_levels(); // other tests may have configured `*`
+    }
+
+    ~TopicsTest() {
+        using namespace ext::logging;
+        configuration::stream = &std::cout;
+        configuration::filename = true;
+        configuration::function = true;
+        set_level_all(level::warn);
+    }
+
+    std::stringstream _log;
+};
+
+TEST_F(TopicsTest, built_in_topics_are_indexed_by_id) {
+    EXPECT_EQ(el::find_topic(el::topic::network.id), &el::topic::network);
+    EXPECT_EQ(el::find_topic("network"), &el::topic::network);
+    EXPECT_EQ(el::find_topic("development"), &el::topic::dev);
+    EXPECT_EQ(el::find_topic("no such topic"), nullptr);
+    EXPECT_EQ(el::find_topic(-1), nullptr);
+    EXPECT_EQ(el::find_topic(static_cast<int>(el::_detail::max_topics)), nullptr);
+}
+
+TEST_F(TopicsTest, register_topic_at_runtime) {
+    // topics are never removed - with --gtest_repeat it exists already
+    bool const created = el::find_topic("database") == nullptr;
+    auto& db = el::register_topic("database", el::level::info);
+    EXPECT_GT(db.id, el::topic::engine.id);
+    EXPECT_LT(db.id, static_cast<int>(el::_detail::max_topics));
+    EXPECT_EQ(db.name, "database");
+    if (created) {
+        EXPECT_EQ(el::get_level(db), el::level::info);
+    }
+
+    // the same name is the same topic
+    EXPECT_EQ(&el::register_topic("database", el::level::trace), &db);
+    EXPECT_EQ(el::find_topic("database"), &db);
+    EXPECT_EQ(el::find_topic(db.id), &db);
+    EXPECT_NE(el::register_topic("cache").id, db.id);
+
+    el::set_level(db, el::level::info);
+    EXT_LOG_TOPIC("cafe", db, info) << "connected";
+    EXT_LOG_TOPIC("babe", db, debug) << "not written";
+    EXPECT_EQ(_log.str(), "[cafe] info (database): 'connected'\n");
+
+    el::set_level_all(el::level::error);
+    EXPECT_EQ(el::get_level(db), el::level::error);
+}
+
+TEST_F(TopicsTest, level_from_str) {
+    el::level result = el::level::info;
+    EXPECT_TRUE(el::level_from_str("debug", result));
+    EXPECT_EQ(result, el::level::debug);
+    EXPECT_TRUE(el::level_from_str("warn", result));
+    EXPECT_EQ(result, el::level::warn);
+    EXPECT_TRUE(el::level_from_str("warning", result));
+    EXPECT_EQ(result, el::level::warn);
+    EXPECT_TRUE(el::level_from_str("70", result));
+    EXPECT_EQ(static_cast<int>(result), 70);
+    EXPECT_FALSE(el::level_from_str("", result));
+    EXPECT_FALSE(el::level_from_str("loud", result));
+    EXPECT_FALSE(el::level_from_str("-1", result));
+    EXPECT_FALSE(el::level_from_str("60x", result));
+}
+
+TEST_F(TopicsTest, configure_levels) {
+    EXPECT_TRUE(el::configure_levels("network=debug, engine = error"));
+    EXPECT_EQ(el::get_level(el::topic::network), el::level::debug);
+    EXPECT_EQ(el::get_level(el::topic::engine), el::level::error);
+
+    // broken entries are reported - the others are still applied
+    EXPECT_FALSE(el::configure_levels("network=loud;engine=trace;=info;development"));
+    EXPECT_EQ(el::get_level(el::topic::network), el::level::debug);
+    EXPECT_EQ(el::get_level(el::topic::engine), el::level::trace);
+
+    // entries for unknown topics are applied on registration
+    EXPECT_TRUE(el::configure_levels("configured later=trace"));
+    EXPECT_EQ(el::get_level(el::register_topic("configured later", el::level::warn)), el::level::trace);
+
+    // `*` applies to every topic, named entries win
+    EXPECT_TRUE(el::configure_levels("*=fatal,registered after star=debug"));
+    EXPECT_EQ(el::get_level(el::topic::dev), el::level::fatal);
+    EXPECT_EQ(el::get_level(el::register_topic("registered after star")), el::level::debug);
+    EXPECT_EQ(el::get_level(el::register_topic("unnamed after star")), el::level::fatal);
+    EXPECT_TRUE(el::configure_levels("*=warn"));
+}
+
+TEST_F(TopicsTest, configure_levels_from_env_and_file) {
+    ::setenv("EXT_LOG_LEVELS_TEST", "network=trace,engine=info", 1);
+    EXPECT_TRUE(el::configure_levels_from_env("EXT_LOG_LEVELS_TEST"));
+    EXPECT_EQ(el::get_level(el::topic::network), el::level::trace);
+    EXPECT_EQ(el::get_level(el::topic::engine), el::level::info);
+    ::unsetenv("EXT_LOG_LEVELS_TEST");
+    EXPECT_TRUE(el::configure_levels_from_env("EXT_LOG_LEVELS_TEST"));
+
+    std::string const path = "ext_logging_topics_test.conf";
+    {
+        std::ofstream file(path);
+        file << "# levels of the test\n"
+             << "network = error   # quiet\n"
+             << "\n"
+             << "engine=debug\n";
+    }
+    EXPECT_TRUE(el::configure_levels_from_file(path));
+    EXPECT_EQ(el::get_level(el::topic::network), el::level::error);
+    EXPECT_EQ(el::get_level(el::topic::engine), el::level::debug);
+    std::remove(path.c_str());
+    EXPECT_FALSE(el::configure_levels_from_file(path));
+}
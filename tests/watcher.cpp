@@ -0,0 +1,163 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define EXT_LOGGING_DEFAULT_LEVEL warn
+#include <ext/logging.hpp>
+
+namespace el = ext::logging;
+
+struct WatcherTest : public ::testing::Test {
+    WatcherTest() {
+        using namespace ext::logging;
+        configuration::stream = &_log;
+#ifdef EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::gdb = false;
+        configuration::vim = false;
+#endif // EXT_LOGGING_ENABLE_VIM_GDB
+        configuration::prefix_newline = false;
+        configuration::append_newline = true;
+        configuration::filename = true;
+        configuration::function = true;
+        set_level(topic::network, level::warn);
+    }
+
+    ~WatcherTest() {
+        using namespace ext::logging;
+#ifndef _WIN32
+        watcher::stop();
+#endif // _WIN32
+        std::remove(_path.c_str());
+        set_enabled("wtch", true);
+        configuration::stream = &std::cout;
+        configuration::filename = true;
+        configuration::function = true;
+        set_level_all(level::warn);
+    }
+
+    void write(std::string const& content) {
+        std::ofstream file(_path, std::ios::trunc);
+        file << content;
+    }
+
+    std::stringstream _log;
+    std::string const _path = "ext_logging_watcher_test.conf";
+};
+
+#ifndef _WIN32
+namespace {
+bool wait_for_reloads(std::uint64_t count) {
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (el::watcher::reloads() < count) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+} // namespace
+#endif // _WIN32
+
+TEST_F(WatcherTest, apply_configuration) {
+    EXPECT_TRUE(el::apply_configuration("network=debug, id.wtch=off\noption.function=no # comment"));
+    EXPECT_EQ(el::get_level(el::topic::network), el::level::debug);
+    EXPECT_FALSE(el::is_enabled("wtch"));
+    EXPECT_FALSE(el::configuration::function);
+
+    EXT_LOG("wtch", network, warn) << "disabled";
+    EXPECT_EQ(_log.str(), "");
+
+    // broken entries are reported - the others are still applied
+    EXPECT_FALSE(el::apply_configuration("option.colors=on;id.wtch=maybe;id.=on;option.function=yes"));
+    EXPECT_TRUE(el::configuration::function);
+    EXPECT_FALSE(el::is_enabled("wtch"));
+    EXPECT_TRUE(el::apply_configuration("id.wtch=on"));
+    EXPECT_TRUE(el::is_enabled("wtch"));
+}
+
+#ifndef _WIN32
+TEST_F(WatcherTest, reloads_while_threads_log) {
+    write("network=warn\noption.filename=off\noption.function=off\n");
+    EXPECT_TRUE(el::watcher::start(_path, {false}));
+    EXPECT_TRUE(el::watcher::active());
+    EXPECT_EQ(el::watcher::reloads(), 1);
+    EXPECT_FALSE(el::configuration::filename);
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&done] {
+            while (!done.load(std::memory_order_relaxed)) {
+                EXT_LOG("wtch", network, debug) << "debug";
+                EXT_LOG("wtch", network, warn) << "warn";
+            }
+        });
+    }
+
+    // the flags change together - no line may have one without the other
+    for (std::uint64_t i = 0; i < 6; ++i) {
+        bool const on = i % 2 == 0;
+        write(std::string("network=") + (on ? "debug" : "warn") + "\noption.filename=" + (on ? "on" : "off") +
+              "\noption.function=" + (on ? "on" : "off") + "\n");
+        ASSERT_TRUE(wait_for_reloads(i + 2));
+        EXPECT_EQ(el::get_level(el::topic::network), on ? el::level::debug : el::level::warn);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    done = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    el::watcher::stop();
+    EXPECT_FALSE(el::watcher::active());
+
+    std::string line;
+    std::size_t debug = 0, with = 0, without = 0;
+    while (std::getline(_log, line)) {
+        bool const file = line.find("watcher.cpp:") != std::string::npos;
+        bool const function = line.find(" in ") != std::string::npos;
+        ASSERT_EQ(file, function) << line;
+        ++(file ? with : without);
+        debug += line.find("[wtch] debug (network)") == 0;
+    }
+    EXPECT_GT(debug, 0);
+    EXPECT_GT(with, 0);
+    EXPECT_GT(without, 0);
+}
+
+TEST_F(WatcherTest, reload_and_sighup) {
+    write("network=error\n");
+    EXPECT_TRUE(el::watcher::start(_path));
+    EXPECT_EQ(el::get_level(el::topic::network), el::level::error);
+
+    // changed behind the watchers back
+    el::set_level(el::topic::network, el::level::trace);
+    el::watcher::reload();
+    ASSERT_TRUE(wait_for_reloads(2));
+    EXPECT_EQ(el::get_level(el::topic::network), el::level::error);
+
+    el::set_level(el::topic::network, el::level::trace);
+    std::raise(SIGHUP);
+    ASSERT_TRUE(wait_for_reloads(3));
+    EXPECT_EQ(el::get_level(el::topic::network), el::level::error);
+    el::watcher::stop();
+
+    // a missing file is reported but watched
+    std::remove(_path.c_str());
+    EXPECT_FALSE(el::watcher::start(_path, {false}));
+    EXPECT_EQ(el::watcher::reloads(), 0);
+    write("network=info\n");
+    ASSERT_TRUE(wait_for_reloads(1));
+    EXPECT_EQ(el::get_level(el::topic::network), el::level::info);
+}
+#endif // _WIN32
@@ -0,0 +1,80 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// ext-logging-cat - converts output of `compressed_file_sink` to text
+//
+// Times are seconds since epoch or UTC `YYYY-MM-DD[THH:MM[:SS]]`. All blocks
+// whose time range overlaps [from, to] are printed.
+//
+// Usage
+//  ext-logging-cat [--from <time>] [--to <time>] [--blocks] <file>
+//  --blocks lists the blocks instead of printing them
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ext/logging/compressed_sink.hpp>
+
+#include "parse_time.hpp"
+
+namespace {
+int usage(char const* name) {
+    std::cerr << "usage: " << name << " [--from <time>] [--to <time>] [--blocks] <file>\n";
+    return 2;
+}
+} // namespace
+
+int main(int argc, char const* argv[]) {
+    namespace compressed = ext::logging::compressed;
+    compressed::decode_options opts;
+    bool list = false;
+    char const* path = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if ((std::strcmp(argv[i], "--from") == 0 || std::strcmp(argv[i], "--to") == 0) && i + 1 < argc) {
+            auto& bound = argv[i][2] == 'f' ? opts.from : opts.to;
+            if (!ext::logging::tools::parse_time(argv[++i], bound)) {
+                std::cerr << argv[0] << ": invalid time " << argv[i] << "\n";
+                return 2;
+            }
+        } else if (std::strcmp(argv[i], "--blocks") == 0) {
+            list = true;
+        } else if (argv[i][0] == '-' || path) {
+            return usage(argv[0]);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        return usage(argv[0]);
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << argv[0] << ": can not open " << path << "\n";
+        return 1;
+    }
+
+    if (list) {
+        std::vector<compressed::block_info> blocks;
+        if (!compressed::read_index(in, blocks)) {
+            std::cerr << argv[0] << ": corrupt input\n";
+            return 1;
+        }
+        std::cout << "offset records raw stored codec first last\n";
+        for (auto const& block : blocks) {
+            std::cout << block.offset << " " << block.records << " " << block.raw_size << " " << block.stored_size
+                      << " " << static_cast<int>(block.method) << " " << block.first << " " << block.last << "\n";
+        }
+        return 0;
+    }
+
+    if (!compressed::decode(in, std::cout, opts)) {
+        std::cerr << argv[0] << ": corrupt input or unsupported codec\n";
+        return 1;
+    }
+    return 0;
+}
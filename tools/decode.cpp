@@ -0,0 +1,52 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// ext-logging-decode - converts output of `EXT_LOG_BINARY` to text
+//
+// Usage
+//  ext-logging-decode [--no-filename] [--no-function] [--timestamp] [file]
+//  reads stdin if no file is given
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <ext/logging/binary.hpp>
+
+int main(int argc, char const* argv[]) {
+    ext::logging::binary::decode_options opts;
+    char const* path = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--no-filename") == 0) {
+            opts.filename = false;
+        } else if (std::strcmp(argv[i], "--no-function") == 0) {
+            opts.function = false;
+        } else if (std::strcmp(argv[i], "--timestamp") == 0) {
+            opts.timestamp = true;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            std::cerr << "usage: " << argv[0] << " [--no-filename] [--no-function] [--timestamp] [file]\n";
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    bool ok;
+    if (path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::cerr << argv[0] << ": can not open " << path << "\n";
+            return 1;
+        }
+        ok = ext::logging::binary::decode(in, std::cout, opts);
+    } else {
+        ok = ext::logging::binary::decode(std::cin, std::cout, opts);
+    }
+
+    if (!ok) {
+        std::cerr << argv[0] << ": corrupt or truncated input\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// ext-logging-idcheck - reports log ids used by more than one statement and
+// different ids with the same hash
+//
+// The ids are the first string literal in the arguments of the `EXT_LOG*`
+// macros. Statements in comments and `#define` lines are skipped.
+//
+// Usage
+//  ext-logging-idcheck [--ignore <id>]... <file or directory>...
+//  exits with 1 if a duplicate was found
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <ext/logging/definitions.hpp>
+
+namespace fs = std::filesystem;
+
+namespace {
+struct location {
+    std::string id;
+    std::string file;
+    std::size_t line;
+};
+
+bool is_identifier(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+bool is_source(fs::path const& path) {
+    static std::set<std::string> const extensions = {".c", ".cc", ".cpp", ".cxx", ".h", ".hh", ".hpp", ".hxx", ".ipp"};
+    return extensions.count(path.extension().string()) > 0;
+}
+
+// the id of the macro call whose `(` is at `open` - empty if there is none
+std::string id_of_call(std::string const& text, std::size_t open) {
+    int depth = 0;
+    for (auto i = open; i < text.size(); ++i) {
+        char const c = text[i];
+        if (c == '(') {
+            ++depth;
+        } else if (c == ')' && --depth == 0) {
+            return {};
+        } else if (c == ';') {
+            return {};
+        } else if (c == '"') {
+            std::string id;
+            for (++i; i < text.size() && text[i] != '"'; ++i) {
+                if (text[i] == '\\' && i + 1 < text.size()) {
+                    ++i;
+                }
+                id += text[i];
+            }
+            return id;
+        }
+    }
+    return {};
+}
+
+void scan(fs::path const& path, std::vector<location>& out) {
+    std::ifstream in(path, std::ios::binary);
+    std::string const text{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+    std::size_t line = 1;
+    bool in_block_comment = false;
+    std::size_t line_start = 0;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        char const c = text[i];
+        if (c == '\n') {
+            ++line;
+            line_start = i + 1;
+            continue;
+        }
+        if (in_block_comment) {
+            if (c == '*' && i + 1 < text.size() && text[i + 1] == '/') {
+                in_block_comment = false;
+                ++i;
+            }
+            continue;
+        }
+        if (c == '/' && i + 1 < text.size() && (text[i + 1] == '/' || text[i + 1] == '*')) {
+            if (text[i + 1] == '*') {
+                in_block_comment = true;
+                ++i;
+            } else {
+                i = std::min(text.find('\n', i), text.size()) - 1; // rest of the line
+            }
+            continue;
+        }
+        if (c == '"' || c == '\'') {
+            // skip literals - they may contain macro names
+            for (++i; i < text.size() && text[i] != c && text[i] != '\n'; ++i) {
+                if (text[i] == '\\') {
+                    ++i;
+                }
+            }
+            continue;
+        }
+        if (text.compare(i, 7, "EXT_LOG") != 0 || (i > 0 && is_identifier(text[i - 1]))) {
+            continue;
+        }
+
+        auto end = i;
+        while (end < text.size() && is_identifier(text[end])) {
+            ++end;
+        }
+        auto const open = text.find_first_not_of(" \t", end);
+        auto const first = text.find_first_not_of(" \t", line_start);
+        bool const define = text.compare(first, 1, "#") == 0;
+        if (!define && open != std::string::npos && text[open] == '(') {
+            auto id = id_of_call(text, open);
+            if (!id.empty()) {
+                out.push_back({std::move(id), path.string(), line});
+            }
+        }
+        i = end - 1;
+    }
+}
+} // namespace
+
+int main(int argc, char const* argv[]) {
+    std::set<std::string> ignored;
+    std::vector<fs::path> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--ignore") == 0 && i + 1 < argc) {
+            ignored.insert(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            std::cerr << "usage: " << argv[0] << " [--ignore <id>]... <file or directory>...\n";
+            return 2;
+        } else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+    if (paths.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--ignore <id>]... <file or directory>...\n";
+        return 2;
+    }
+
+    std::vector<location> found;
+    for (auto const& path : paths) {
+        std::error_code error;
+        if (fs::is_directory(path, error)) {
+            for (auto const& entry : fs::recursive_directory_iterator(path, error)) {
+                if (entry.is_regular_file(error) && is_source(entry.path())) {
+                    scan(entry.path(), found);
+                }
+            }
+        } else if (fs::is_regular_file(path, error)) {
+            scan(path, found);
+        } else {
+            std::cerr << argv[0] << ": can not read " << path.string() << "\n";
+            return 2;
+        }
+    }
+
+    std::map<std::uint64_t, std::vector<location const*>> by_hash;
+    for (auto const& loc : found) {
+        if (!ignored.count(loc.id)) {
+            by_hash[ext::logging::id_hash(loc.id)].push_back(&loc);
+        }
+    }
+
+    std::size_t duplicates = 0;
+    for (auto const& [hash, sites] : by_hash) {
+        if (sites.size() < 2) {
+            continue;
+        }
+        ++duplicates;
+        bool const collision = std::any_of(sites.begin(), sites.end(), [&sites](location const* loc) {
+            return loc->id != sites.front()->id;
+        });
+        for (auto const* loc : sites) {
+            std::cout << loc->file << ":" << loc->line << ": " << (collision ? "hash collision" : "duplicate id")
+                      << " \"" << loc->id << "\"\n";
+        }
+    }
+    std::cout << found.size() << " ids, " << duplicates << " duplicated\n";
+    return duplicates ? 1 : 0;
+}
@@ -0,0 +1,60 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// time arguments of the tools - seconds since epoch or UTC `YYYY-MM-DD[THH:MM[:SS]]`
+
+#ifndef EXT_LOGGING_TOOLS_PARSE_TIME_HEADER
+#define EXT_LOGGING_TOOLS_PARSE_TIME_HEADER
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace ext { namespace logging { namespace tools {
+
+// days since 1970-01-01 of a date in the proleptic gregorian calendar (H. Hinnant)
+inline std::int64_t days_from_civil(std::int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    std::int64_t const era = (year >= 0 ? year : year - 399) / 400;
+    auto const year_of_era = static_cast<unsigned>(year - era * 400);
+    unsigned const day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    unsigned const day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + static_cast<std::int64_t>(day_of_era) - 719468;
+}
+
+// nanoseconds since epoch - false if the time can not be parsed
+inline bool parse_time(char const* text, std::uint64_t& out) {
+    double seconds;
+    int used = 0;
+    if (std::sscanf(text, "%lf%n", &seconds, &used) == 1 && text[used] == '\0' && seconds >= 0) {
+        out = static_cast<std::uint64_t>(seconds * 1e9);
+        return true;
+    }
+
+    int year, month, day, hour = 0, minute = 0, second = 0;
+    used = 0;
+    auto const fields = std::sscanf(text, "%4d-%2d-%2d%n", &year, &month, &day, &used);
+    if (fields != 3 || month < 1 || month > 12 || day < 1 || day > 31) {
+        return false;
+    }
+    if (text[used] == 'T' || text[used] == ' ') {
+        int rest = 0;
+        if (std::sscanf(text + used + 1, "%2d:%2d%n:%2d%n", &hour, &minute, &rest, &second, &rest) < 2) {
+            return false;
+        }
+        used += 1 + rest;
+    }
+    if (text[used] != '\0' && std::strcmp(text + used, "Z") != 0) {
+        return false;
+    }
+    auto const days = days_from_civil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+    auto const total = days * 86400 + hour * 3600 + minute * 60 + second;
+    if (total < 0) {
+        return false;
+    }
+    out = static_cast<std::uint64_t>(total) * 1000000000u;
+    return true;
+}
+
+}}}    // namespace ext::logging::tools
+#endif // EXT_LOGGING_TOOLS_PARSE_TIME_HEADER
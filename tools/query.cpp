@@ -0,0 +1,214 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// ext-logging-query - prints the records of a text log that match all filters
+//
+// With a sidecar index (`<file>.idx`, see sidecar.hpp) only the blocks that
+// may contain matching records are read, the unindexed rest of the file is
+// always read. The file is mapped and the blocks are scanned in parallel,
+// the output keeps the order of the file. Lines without the fixed fields
+// belong to the record before them. Times select blocks and need the index.
+//
+// Usage
+//  ext-logging-query [--id <id>]... [--topic <name>]... [--level <level>]
+//                    [--from <time>] [--to <time>] [--jobs <n>] [--stats] <file>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ext/logging/sidecar.hpp>
+#include <ext/logging/topics.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "parse_time.hpp"
+
+namespace sidecar = ext::logging::sidecar;
+
+namespace {
+constexpr std::uint64_t chunk_size = 4 * 1024 * 1024; // of files without index
+
+struct range {
+    std::uint64_t begin;
+    std::uint64_t end;
+};
+
+void scan(char const* data, range const& part, sidecar::query const& q, std::string& out) {
+    bool keep = false;
+    auto pos = data + part.begin;
+    auto const end = data + part.end;
+    while (pos < end) {
+        auto const newline = static_cast<char const*>(std::memchr(pos, '\n', static_cast<std::size_t>(end - pos)));
+        auto const line_end = newline ? newline + 1 : end;
+        std::string_view const line(pos, static_cast<std::size_t>(line_end - pos));
+        if (sidecar::line_fields fields; sidecar::parse_line(line, fields)) {
+            keep = sidecar::matches(fields, q);
+        }
+        if (keep) {
+            out.append(line);
+        }
+        pos = line_end;
+    }
+}
+
+// cuts [begin, end) into chunks that end with a line
+void split(char const* data, std::uint64_t begin, std::uint64_t end, std::vector<range>& out) {
+    while (begin < end) {
+        auto cut = std::min(begin + chunk_size, end);
+        if (cut < end) {
+            auto const newline = static_cast<char const*>(std::memchr(data + cut, '\n', end - cut));
+            cut = newline ? static_cast<std::uint64_t>(newline - data) + 1 : end;
+        }
+        out.push_back({begin, cut});
+        begin = cut;
+    }
+}
+
+int usage(char const* name) {
+    std::cerr << "usage: " << name
+              << " [--id <id>]... [--topic <name>]... [--level <level>] [--from <time>] [--to <time>]"
+                 " [--jobs <n>] [--stats] <file>\n";
+    return 2;
+}
+} // namespace
+
+int main(int argc, char const* argv[]) {
+    sidecar::query q;
+    unsigned jobs = std::max(std::thread::hardware_concurrency(), 1u);
+    bool stats = false;
+    bool timed = false;
+    char const* path = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        auto const option = std::string(argv[i]);
+        bool const has_value = i + 1 < argc;
+        if (option == "--id" && has_value) {
+            q.ids.push_back(ext::logging::id_hash(argv[++i]));
+        } else if (option == "--topic" && has_value) {
+            q.topics.push_back(ext::logging::id_hash(argv[++i]));
+        } else if (option == "--level" && has_value) {
+            if (!ext::logging::level_from_str(argv[++i], q.max_level)) {
+                std::cerr << argv[0] << ": invalid level " << argv[i] << "\n";
+                return 2;
+            }
+        } else if ((option == "--from" || option == "--to") && has_value) {
+            if (!ext::logging::tools::parse_time(argv[++i], option == "--from" ? q.from : q.to)) {
+                std::cerr << argv[0] << ": invalid time " << argv[i] << "\n";
+                return 2;
+            }
+            timed = true;
+        } else if (option == "--jobs" && has_value) {
+            jobs = static_cast<unsigned>(std::max(std::atoi(argv[++i]), 1));
+        } else if (option == "--stats") {
+            stats = true;
+        } else if (argv[i][0] == '-' || path) {
+            return usage(argv[0]);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        return usage(argv[0]);
+    }
+
+    int const fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    struct ::stat info;
+    if (fd < 0 || ::fstat(fd, &info) != 0) {
+        std::cerr << argv[0] << ": can not open " << path << "\n";
+        return 1;
+    }
+    auto const size = static_cast<std::uint64_t>(info.st_size);
+    if (size == 0) {
+        return 0;
+    }
+    auto const mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << argv[0] << ": can not map " << path << "\n";
+        return 1;
+    }
+    auto const data = static_cast<char const*>(mapped);
+
+    // select the blocks
+    std::vector<sidecar::block_entry> entries;
+    std::vector<range> ranges;
+    std::uint64_t indexed = 0;
+    if (sidecar::read(std::string(path) + ".idx", entries)) {
+        for (auto const& entry : entries) {
+            if (entry.offset + entry.size > size) {
+                break; // the file was truncated
+            }
+            if (sidecar::may_match(entry, q)) {
+                ranges.push_back({entry.offset, entry.offset + entry.size});
+            }
+            indexed = std::max(indexed, entry.offset + entry.size);
+        }
+    } else if (timed) {
+        std::cerr << argv[0] << ": no index - times are ignored\n";
+    }
+    auto const selected = ranges.size();
+    split(data, indexed, size, ranges);
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+
+    // scan in parallel - at most `window` results wait to be printed
+    std::size_t const window = jobs * 4;
+    std::vector<std::string> results(ranges.size());
+    std::vector<char> ready(ranges.size(), 0);
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::size_t printed = 0;
+    std::atomic<std::size_t> next{0};
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < jobs; ++i) {
+        workers.emplace_back([&] {
+            for (auto current = next++; current < ranges.size(); current = next++) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&] { return current < printed + window; });
+                }
+                std::string out;
+                scan(data, ranges[current], q, out);
+                std::lock_guard<std::mutex> lock(mutex);
+                results[current] = std::move(out);
+                ready[current] = 1;
+                changed.notify_all();
+            }
+        });
+    }
+
+    std::uint64_t scanned = 0;
+    for (std::size_t current = 0; current < ranges.size(); ++current) {
+        std::string out;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return ready[current] != 0; });
+            out = std::move(results[current]);
+            printed = current + 1;
+        }
+        changed.notify_all();
+        std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+        scanned += ranges[current].end - ranges[current].begin;
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::cout.flush();
+    ::munmap(mapped, size);
+
+    if (stats) {
+        std::cerr << "blocks: " << selected << " of " << entries.size() << " selected, bytes: " << scanned << " of "
+                  << size << " scanned (" << (size - indexed) << " without index)\n";
+    }
+    return std::cout ? 0 : 1;
+}
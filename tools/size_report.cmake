@@ -0,0 +1,52 @@
+# Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+
+# prints the text size per log statement of the objects built from
+# size_report.cpp - run by the `ext-logging-size-report` target
+#
+# Usage
+#  cmake -D SIZE=<size program> -D SITES=<n> -D INLINE=<object> -D COLD=<object> -P size_report.cmake
+
+foreach(variable SIZE SITES INLINE COLD)
+    if(NOT DEFINED ${variable})
+        message(FATAL_ERROR "size_report.cmake: ${variable} is not set")
+    endif()
+endforeach()
+
+# sums `.text*` of `size -A` (llvm-size understands -A, too) - `.text.unlikely*`
+# is the cold part, `.text.startup` runs once and is not counted
+function(text_sizes object hot_out cold_out)
+    execute_process(COMMAND "${SIZE}" -A "${object}"
+        OUTPUT_VARIABLE output
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "size_report.cmake: ${SIZE} failed for ${object}")
+    endif()
+    string(REPLACE "\n" ";" lines "${output}")
+    set(hot 0)
+    set(cold 0)
+    foreach(line IN LISTS lines)
+        if(line MATCHES "^(\\.text[^ \t]*)[ \t]+([0-9]+)")
+            set(section "${CMAKE_MATCH_1}")
+            set(bytes "${CMAKE_MATCH_2}")
+            if(section MATCHES "^\\.text\\.unlikely")
+                math(EXPR cold "${cold} + ${bytes}")
+            elseif(NOT section MATCHES "^\\.text\\.startup")
+                math(EXPR hot "${hot} + ${bytes}")
+            endif()
+        endif()
+    endforeach()
+    set(${hot_out} ${hot} PARENT_SCOPE)
+    set(${cold_out} ${cold} PARENT_SCOPE)
+endfunction()
+
+text_sizes("${INLINE}" inline_hot inline_cold)
+text_sizes("${COLD}" cold_hot cold_cold)
+math(EXPR inline_per_site "${inline_hot} / ${SITES}")
+math(EXPR cold_per_site "${cold_hot} / ${SITES}")
+math(EXPR saved "${inline_per_site} - ${cold_per_site}")
+
+message("ext-logging size report - ${SITES} EXT_LOG statements")
+message("  inline (EXT_LOGGING_NO_COLD): ${inline_hot} bytes hot, ${inline_cold} bytes cold, ${inline_per_site} hot bytes per statement")
+message("  cold path (default):          ${cold_hot} bytes hot, ${cold_cold} bytes cold, ${cold_per_site} hot bytes per statement")
+message("  hot text saved per statement: ${saved} bytes")
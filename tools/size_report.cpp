@@ -0,0 +1,27 @@
+// Copyright - 2016-2020 - Jan Christoph Uhde <Jan@UhdeJC.com>
+// Please see LICENSE.md for license or visit https://github.com/extcpp/basics
+
+// Log statements measured by the `ext-logging-size-report` target
+//
+// Every function contains nothing but one `EXT_LOG` statement. The file is
+// compiled with and without `EXT_LOGGING_NO_COLD` and size_report.cmake
+// divides the text sizes of both objects by the number of statements.
+//
+// Usage
+//  cmake --build . --target ext-logging-size-report
+
+#include <string>
+
+#include <ext/logging.hpp>
+
+#define eXT_SIZE_SITE(n_)                                                       \
+    void size_site_##n_(int value, std::string const& name) {                   \
+        EXT_LOG("s" #n_, network, info) << "value " << value << " of " << name; \
+    }
+#define eXT_SIZE_SITES8(n_)                                                             \
+    eXT_SIZE_SITE(n_##0) eXT_SIZE_SITE(n_##1) eXT_SIZE_SITE(n_##2) eXT_SIZE_SITE(n_##3) \
+    eXT_SIZE_SITE(n_##4) eXT_SIZE_SITE(n_##5) eXT_SIZE_SITE(n_##6) eXT_SIZE_SITE(n_##7)
+
+// 64 statements - keep in sync with `sites` in tools/CMakeLists.txt
+eXT_SIZE_SITES8(1) eXT_SIZE_SITES8(2) eXT_SIZE_SITES8(3) eXT_SIZE_SITES8(4)
+eXT_SIZE_SITES8(5) eXT_SIZE_SITES8(6) eXT_SIZE_SITES8(7) eXT_SIZE_SITES8(8)